@@ -6,11 +6,16 @@ layout(location = 1) in vec3 in_color;
 layout(location = 2) in vec3 in_normal;
 layout(location = 3) in vec2 in_uv;
 
-// Push constants - MVP matrices
-layout(push_constant) uniform PushConstants {
-    mat4 model;
+// Camera matrices, written once per frame (FrameUniformData)
+layout(set = 0, binding = 0) uniform FrameUniforms {
     mat4 view;
     mat4 projection;
+    mat4 view_projection;
+} frame;
+
+// Push constants - model matrix
+layout(push_constant) uniform PushConstants {
+    mat4 model;
 } pc;
 
 // Outputs to fragment shader
@@ -25,7 +30,7 @@ void main() {
     frag_world_pos = world_pos.xyz;
 
     // Transform to clip space
-    gl_Position = pc.projection * pc.view * world_pos;
+    gl_Position = frame.view_projection * world_pos;
 
     // Pass through other attributes
     frag_color = in_color;
@@ -0,0 +1,29 @@
+#version 450
+
+// Depth-only pre-pass for the geometry pass. Must compute gl_Position
+// exactly as gbuffer.vert does, or the EQUAL depth test rejects fragments.
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inModelRows[3];  // Per instance 3x4 rows (identity for plain draws)
+
+layout(set = 1, binding = 0) uniform FrameUniforms {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+} frame;
+
+// Same layout as the geometry pass (material is unused)
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+    uint material;
+} push;
+
+invariant gl_Position;
+
+void main() {
+    mat4 instanceModel = mat4(transpose(mat3x4(inModelRows[0], inModelRows[1], inModelRows[2])));
+    mat4 model = push.model * instanceModel;
+    vec4 worldPos = model * vec4(inPosition, 1.0);
+
+    gl_Position = frame.viewProjection * worldPos;
+}
@@ -1,19 +1,12 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 
-layout(location = 0) in vec3 fragWorldPos;
-layout(location = 1) in vec3 fragNormal;
-layout(location = 2) in vec3 fragColor;
-layout(location = 3) in vec2 fragUV;
+// Every material map lives in one array of sampled images, sized to the
+// device's limits. Slot indices come from a push constant via the table,
+// so they are dynamically uniform for the whole draw.
+layout(constant_id = 0) const uint MATERIAL_MAX_TEXTURES = 128;
+layout(set = 0, binding = 0) uniform texture2D materialTextures[MATERIAL_MAX_TEXTURES];
 
-// G-buffer outputs
-layout(location = 0) out vec4 outPosition;   // RGB = world position
-layout(location = 1) out vec4 outNormal;     // RGB = world normal
-layout(location = 2) out vec4 outAlbedo;     // RGB = albedo, A = AO
-layout(location = 3) out vec2 outMaterial;   // R = roughness, G = metallic
+#define MATERIAL_SLOT(material, map, bound) material.map
 
-void main() {
-    outPosition = vec4(fragWorldPos, 1.0);
-    outNormal = vec4(normalize(fragNormal), 0.0);
-    outAlbedo = vec4(fragColor, 1.0);  // AO = 1.0 for now
-    outMaterial = vec2(0.5, 0.0);      // Roughness = 0.5, Metallic = 0
-}
+#include "gbuffer_common.glsl"
@@ -4,28 +4,41 @@ layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec3 inNormal;
 layout(location = 3) in vec2 inUV;
+layout(location = 4) in vec4 inModelRows[3];  // Per instance 3x4 rows (identity for plain draws)
 
-layout(location = 0) out vec3 fragWorldPos;
-layout(location = 1) out vec3 fragNormal;
-layout(location = 2) out vec3 fragColor;
-layout(location = 3) out vec2 fragUV;
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out vec3 fragColor;
+layout(location = 2) out vec2 fragUV;
+layout(location = 3) out vec3 fragWorldPos;
 
-layout(push_constant) uniform PushConstants {
-    mat4 model;
+// Camera matrices, written once per frame (FrameUniformData)
+layout(set = 1, binding = 0) uniform FrameUniforms {
     mat4 view;
     mat4 projection;
+    mat4 viewProjection;
+} frame;
+
+// Must match GeometryPushConstants (material is read by the fragment stage)
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+    uint material;
 } push;
 
+// Matches depth_prepass.vert bit for bit
+invariant gl_Position;
+
 void main() {
-    vec4 worldPos = push.model * vec4(inPosition, 1.0);
-    fragWorldPos = worldPos.xyz;
+    mat4 instanceModel = mat4(transpose(mat3x4(inModelRows[0], inModelRows[1], inModelRows[2])));
+    mat4 model = push.model * instanceModel;
+    vec4 worldPos = model * vec4(inPosition, 1.0);
 
     // Transform normal to world space
-    mat3 normalMatrix = transpose(inverse(mat3(push.model)));
+    mat3 normalMatrix = transpose(inverse(mat3(model)));
     fragNormal = normalize(normalMatrix * inNormal);
 
     fragColor = inColor;
     fragUV = inUV;
+    fragWorldPos = worldPos.xyz;
 
-    gl_Position = push.projection * push.view * worldPos;
+    gl_Position = frame.viewProjection * worldPos;
 }
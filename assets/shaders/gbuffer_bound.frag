@@ -0,0 +1,12 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// For devices without dynamic indexing of sampled image arrays: the set
+// bound for each draw holds only that material's maps, so every index is
+// a constant
+#define MATERIAL_MAPS 5  // Must match material_library.h
+layout(set = 0, binding = 0) uniform texture2D materialTextures[MATERIAL_MAPS];
+
+#define MATERIAL_SLOT(material, map, bound) bound
+
+#include "gbuffer_common.glsl"
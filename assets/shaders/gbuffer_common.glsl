@@ -0,0 +1,114 @@
+// G-buffer pass shared code
+//
+// Includers declare materialTextures (set 0, binding 0) and define
+// MATERIAL_SLOT(material, map, bound) to pick the array index for one of a
+// material's maps: the table slot when indexing is dynamic, the fixed slot
+// bound (0-4, MaterialMapBits order) when each material has its own set.
+
+layout(location = 0) in vec3 fragNormal;
+layout(location = 1) in vec3 fragColor;
+layout(location = 2) in vec2 fragUV;
+layout(location = 3) in vec3 fragWorldPos;
+
+// G-buffer outputs (world position is reconstructed from depth)
+layout(location = 0) out vec4 outNormal;     // RG = octahedral normal, B = roughness, A = metallic
+layout(location = 1) out vec4 outAlbedo;     // RGB = albedo, A = AO
+
+// Material library (see material_library.h). The table says which maps a
+// material has and which of them have finished loading.
+#define MATERIAL_NONE 0xFFFFFFFFu
+
+#define MATERIAL_ALBEDO_BIT    1u
+#define MATERIAL_NORMAL_BIT    2u
+#define MATERIAL_ROUGHNESS_BIT 4u
+#define MATERIAL_METALLIC_BIT  8u
+#define MATERIAL_AO_BIT        16u
+
+struct GpuMaterial {
+    uint albedo;
+    uint normal;
+    uint roughness;
+    uint metallic;
+    uint ao;
+    uint flags;
+    float uvScale;
+    float normalStrength;
+    vec4 tint;
+};
+
+layout(set = 0, binding = 1) uniform sampler materialSampler;
+
+layout(std430, set = 0, binding = 2) readonly buffer MaterialTable {
+    GpuMaterial materials[];
+};
+
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+    uint material;
+} push;
+
+// Octahedral normal encoding: maps the unit sphere onto [-1, 1]^2
+vec2 octWrap(vec2 v) {
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec2 encodeNormal(vec3 n) {
+    n /= (abs(n.x) + abs(n.y) + abs(n.z));
+    return n.z >= 0.0 ? n.xy : octWrap(n.xy);
+}
+
+// A macro, not a function: the bound variant needs its literal slot index
+// at the indexing site
+#define sampleMaterial(slot, uv) texture(sampler2D(materialTextures[slot], materialSampler), uv)
+
+// Tangent frame from screen-space derivatives (meshes carry no tangents)
+mat3 cotangentFrame(vec3 n, vec3 p, vec2 uv) {
+    vec3 dp1 = dFdx(p);
+    vec3 dp2 = dFdy(p);
+    vec2 duv1 = dFdx(uv);
+    vec2 duv2 = dFdy(uv);
+
+    vec3 dp2perp = cross(dp2, n);
+    vec3 dp1perp = cross(n, dp1);
+    vec3 t = dp2perp * duv1.x + dp1perp * duv2.x;
+    vec3 b = dp2perp * duv1.y + dp1perp * duv2.y;
+
+    float invmax = inversesqrt(max(dot(t, t), dot(b, b)));
+    return mat3(t * invmax, b * invmax, n);
+}
+
+void main() {
+    vec3 normal = normalize(fragNormal);
+    vec3 albedo = fragColor;
+    float roughness = 0.5;
+    float metallic = 0.0;
+    float ao = 1.0;
+
+    if (push.material != MATERIAL_NONE) {
+        GpuMaterial material = materials[push.material];
+        vec2 uv = fragUV * material.uvScale;
+
+        if ((material.flags & MATERIAL_ALBEDO_BIT) != 0u) {
+            albedo = sampleMaterial(MATERIAL_SLOT(material, albedo, 0), uv).rgb * material.tint.rgb;
+        }
+        if ((material.flags & MATERIAL_NORMAL_BIT) != 0u) {
+            // Only XY are used so RGB and two-channel (BC5) maps decode alike
+            vec3 tangentNormal;
+            tangentNormal.xy = (sampleMaterial(MATERIAL_SLOT(material, normal, 1), uv).rg * 2.0 - 1.0) * material.normalStrength;
+            tangentNormal.z = sqrt(max(1.0 - dot(tangentNormal.xy, tangentNormal.xy), 0.0));
+            normal = normalize(cotangentFrame(normal, fragWorldPos, uv) * tangentNormal);
+        }
+        if ((material.flags & MATERIAL_ROUGHNESS_BIT) != 0u) {
+            roughness = sampleMaterial(MATERIAL_SLOT(material, roughness, 2), uv).r;
+        }
+        if ((material.flags & MATERIAL_METALLIC_BIT) != 0u) {
+            metallic = sampleMaterial(MATERIAL_SLOT(material, metallic, 3), uv).r;
+        }
+        if ((material.flags & MATERIAL_AO_BIT) != 0u) {
+            ao = sampleMaterial(MATERIAL_SLOT(material, ao, 4), uv).r;
+        }
+    }
+
+    outNormal = vec4(encodeNormal(normal), roughness, metallic);
+    outAlbedo = vec4(albedo, ao);
+}
@@ -0,0 +1,30 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// Lighting subpass: reads the G-buffer as input attachments so it never
+// leaves tile memory (see GBuffer subpass mode).
+
+layout(location = 0) in vec2 fragUV;
+layout(location = 0) out vec4 outColor;
+
+// G-buffer input attachments (same pixel only)
+layout(input_attachment_index = 0, binding = 0) uniform subpassInput gNormal;
+layout(input_attachment_index = 1, binding = 1) uniform subpassInput gAlbedo;
+layout(input_attachment_index = 2, binding = 2) uniform subpassInput gDepth;
+
+#include "lighting_common.glsl"
+
+void main() {
+    float depth = subpassLoad(gDepth).r;
+
+    // Early out for background
+    if (depth >= 1.0) {
+        outColor = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    vec4 normalMaterial = subpassLoad(gNormal);
+    vec4 albedoAO = subpassLoad(gAlbedo);
+
+    outColor = vec4(shadeGBuffer(fragUV, depth, normalMaterial, albedoAO), 1.0);
+}
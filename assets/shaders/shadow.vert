@@ -1,6 +1,7 @@
 #version 450
 
 layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inModelRows[3];  // Per instance 3x4 rows (identity for plain draws)
 
 layout(push_constant) uniform PushConstants {
     mat4 lightSpaceMatrix;
@@ -8,5 +9,6 @@ layout(push_constant) uniform PushConstants {
 } push;
 
 void main() {
-    gl_Position = push.lightSpaceMatrix * vec4(inPosition, 1.0);
+    mat4 instanceModel = mat4(transpose(mat3x4(inModelRows[0], inModelRows[1], inModelRows[2])));
+    gl_Position = push.lightSpaceMatrix * (instanceModel * vec4(inPosition, 1.0));
 }
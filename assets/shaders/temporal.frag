@@ -0,0 +1,60 @@
+#version 450
+
+layout(location = 0) in vec2 fragUV;
+
+layout(location = 0) out vec4 outColor;    // Swapchain image
+layout(location = 1) out vec4 outHistory;  // Next frame's history
+
+// Lit scene at the internal render resolution (top-left region)
+layout(binding = 0) uniform sampler2D sceneColor;
+// G-buffer depth, same region
+layout(binding = 1) uniform sampler2D sceneDepth;
+// Previous output at full resolution
+layout(binding = 2) uniform sampler2D history;
+
+layout(push_constant) uniform PushConstants {
+    mat4 reprojection;  // Current clip -> previous frame's clip (unjittered)
+    vec4 uvScale;       // xy = render size / image size, zw = last rendered texel center
+    vec4 jitter;        // xy = jitter in scene UV, z = history weight, w = 1 if history is valid
+} push;
+
+void main() {
+    // The scene was rendered shifted by the jitter; sample where this
+    // output pixel landed
+    vec2 sceneUV = min(fragUV * push.uvScale.xy + push.jitter.xy, push.uvScale.zw);
+    vec3 current = texture(sceneColor, sceneUV).rgb;
+
+    vec2 sceneSize = vec2(textureSize(sceneColor, 0));
+    ivec2 center = ivec2(sceneUV * sceneSize);
+    ivec2 last = ivec2(push.uvScale.zw * sceneSize);
+
+    vec3 result = current;
+    if (push.jitter.w > 0.0) {
+        // Camera motion: rebuild this pixel's clip position from depth and
+        // find where it was last frame
+        float depth = texelFetch(sceneDepth, center, 0).r;
+        vec4 prevClip = push.reprojection * vec4(fragUV * 2.0 - 1.0, depth, 1.0);
+        vec2 prevUV = prevClip.xy / prevClip.w * 0.5 + 0.5;
+
+        if (all(greaterThanEqual(prevUV, vec2(0.0))) && all(lessThanEqual(prevUV, vec2(1.0)))) {
+            // History may only hold colors the new samples around this pixel
+            // could produce; anything outside was disoccluded or relit
+            vec3 minColor = current;
+            vec3 maxColor = current;
+            for (int y = -1; y <= 1; y++) {
+                for (int x = -1; x <= 1; x++) {
+                    ivec2 texel = clamp(center + ivec2(x, y), ivec2(0), last);
+                    vec3 neighbor = texelFetch(sceneColor, texel, 0).rgb;
+                    minColor = min(minColor, neighbor);
+                    maxColor = max(maxColor, neighbor);
+                }
+            }
+
+            vec3 previous = clamp(texture(history, prevUV).rgb, minColor, maxColor);
+            result = mix(current, previous, push.jitter.z);
+        }
+    }
+
+    outColor = vec4(result, 1.0);
+    outHistory = vec4(result, 1.0);
+}
@@ -0,0 +1,17 @@
+#version 450
+
+layout(location = 0) in vec2 fragUV;
+layout(location = 0) out vec4 outColor;
+
+// Lit scene at the internal render resolution
+layout(binding = 0) uniform sampler2D sceneColor;
+
+layout(push_constant) uniform PushConstants {
+    vec4 uvScale;  // xy = render size / image size, zw = last rendered texel center
+} push;
+
+void main() {
+    // Bilinear upscale; clamp so the filter never reads outside the rendered region
+    vec2 uv = min(fragUV * push.uvScale.xy, push.uvScale.zw);
+    outColor = vec4(texture(sceneColor, uv).rgb, 1.0);
+}
@@ -11,14 +11,21 @@
  * - First-person fly camera
  */
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "utils/math.h"
+#include "utils/fast_math.h"
 #include "utils/timer.h"
+#include "utils/bench_log.h"
+#include "utils/alloc_counter.h"
 #include "input/window.h"
 #include "input/input_manager.h"
 #include "renderer/vulkan_context.h"
@@ -26,6 +33,10 @@
 #include "renderer/mesh.h"
 #include "renderer/camera.h"
 #include "renderer/deferred_pipeline.h"
+#include "renderer/camera_path.h"
+#include "renderer/render_thread.h"
+#include "renderer/texture.h"
+#include "renderer/texture_loader.h"
 #include "game/map_generator.h"
 #include "game/map_mesh.h"
 
@@ -35,17 +46,39 @@ struct EngineConfig {
     int window_width = 2560;
     int window_height = 1440;
     bool fullscreen = false;
-    bool vsync = true;
+    PresentMode present_mode = PresentMode::Fifo;
+    bool low_latency = false;  // Sample input after the previous frame completes
     bool enable_validation = true;
 
+    // Renderer settings
+    bool subpass_lighting = false;  // Single render pass deferred path
+    float render_scale = 1.0f;      // Internal resolution scale (0.5 - 1.0)
+    bool dynamic_resolution = false;
+    float gpu_budget_ms = 16.6f;    // Dynamic resolution GPU frame time target
+    bool temporal_upscale = false;  // Temporal reconstruction instead of bilinear upscale
+    bool depth_prepass = false;     // Depth-only pass before the G-buffer pass
+    bool shadows = true;            // Point light shadow maps
+    bool render_thread = true;      // Record and present on a separate thread
+    bool memory_report = false;     // Device memory report at shutdown
+
     // Network settings
     bool is_host = false;
     const char* connect_address = nullptr;
     int port = 7777;
 
+    // Material baker output, streamed in after startup
+    const char* materials_dir = "assets/materials";
+
     // Map settings
     unsigned int map_seed = 12345;
     int map_size = 128;  // Smaller for demo (128x128 instead of 1024)
+
+    // Headless benchmark settings
+    bool headless = false;           // Offscreen rendering, no window or surface
+    int bench_frames = 600;          // Frames to render along the camera path
+    const char* bench_out = nullptr; // Per-frame timings CSV
+    const char* dump_dir = nullptr;  // Directory for TGA frame dumps
+    int dump_interval = 60;          // Dump every N frames
 };
 
 class Engine {
@@ -58,41 +91,77 @@ public:
         printf("  Resolution: %dx%d\n", config_.window_width, config_.window_height);
         printf("  Map Seed: %u\n", config_.map_seed);
 
-        // Create window
-        WindowConfig window_config;
-        window_config.title = "Slam Engine - Fly-Through Demo";
-        window_config.width = config_.window_width;
-        window_config.height = config_.window_height;
-        window_config.fullscreen = config_.fullscreen;
-        window_config.vsync = config_.vsync;
-
-        if (!window_.init(window_config)) {
-            fprintf(stderr, "Failed to create window\n");
-            return false;
+        VulkanContextConfig vk_config;
+        vk_config.enable_validation = config_.enable_validation;
+        vk_config.present_mode = config_.present_mode;
+
+        // Low latency: one frame in flight, input sampled right after the
+        // previous frame completes. The render thread would add a frame of
+        // queueing, so the loop stays on one thread.
+        if (config_.low_latency && !config_.headless) {
+            vk_config.max_frames_in_flight = 1;
+            config_.render_thread = false;
+            printf("  Low latency: 1 frame in flight, late input sampling\n");
         }
 
-        // Connect input manager
-        input_.connect(window_);
+        uint32_t render_width = static_cast<uint32_t>(config_.window_width);
+        uint32_t render_height = static_cast<uint32_t>(config_.window_height);
 
-        // Initialize Vulkan
-        VulkanContextConfig vk_config;
-        vk_config.enable_validation = config_.enable_validation;
-        vk_config.enable_vsync = config_.vsync;
+        if (config_.headless) {
+            // No window: GLFW is never initialized
+            printf("  Headless: %d frames\n", config_.bench_frames);
 
-        if (!vulkan_.init(window_, vk_config)) {
-            fprintf(stderr, "Failed to initialize Vulkan\n");
-            return false;
+            if (!vulkan_.init_headless(render_width, render_height, vk_config)) {
+                fprintf(stderr, "Failed to initialize headless Vulkan\n");
+                return false;
+            }
+        } else {
+            // Create window
+            WindowConfig window_config;
+            window_config.title = "Slam Engine - Fly-Through Demo";
+            window_config.width = config_.window_width;
+            window_config.height = config_.window_height;
+            window_config.fullscreen = config_.fullscreen;
+            window_config.vsync = config_.present_mode == PresentMode::Fifo;
+
+            if (!window_.init(window_config)) {
+                fprintf(stderr, "Failed to create window\n");
+                return false;
+            }
+
+            // Connect input manager
+            input_.connect(window_);
+
+            // Initialize Vulkan
+            if (!vulkan_.init(window_, vk_config)) {
+                fprintf(stderr, "Failed to initialize Vulkan\n");
+                return false;
+            }
+
+            render_width = window_.framebuffer_width();
+            render_height = window_.framebuffer_height();
         }
 
         // Initialize deferred PBR pipeline
         printf("  Initializing renderer...\n");
-        if (!deferred_.init(vulkan_, window_.framebuffer_width(), window_.framebuffer_height())) {
+        DeferredPipelineConfig deferred_config;
+        deferred_config.subpass_lighting = config_.subpass_lighting;
+        deferred_config.render_scale = config_.render_scale;
+        deferred_config.dynamic_resolution = config_.dynamic_resolution;
+        deferred_config.resolution.frame_budget_ms = config_.gpu_budget_ms;
+        deferred_config.temporal_upscale = config_.temporal_upscale;
+        deferred_config.depth_prepass = config_.depth_prepass;
+        deferred_config.shadows = config_.shadows;
+
+        if (!deferred_.init(vulkan_, render_width, render_height, deferred_config)) {
             fprintf(stderr, "Failed to create deferred pipeline\n");
             return false;
         }
 
         // Create basic forward pipeline as fallback
-        if (!pipeline_.create(vulkan_, "shaders/basic.vert.spv", "shaders/basic.frag.spv")) {
+        if (!basic_uniforms_.init(vulkan_) ||
+            !pipeline_.create(vulkan_, "shaders/basic.vert.spv", "shaders/basic.frag.spv",
+                              {basic_uniforms_.descriptor_layout()})) {
             fprintf(stderr, "Failed to create graphics pipeline\n");
             return false;
         }
@@ -133,6 +202,14 @@ public:
         crate_mesh_ = PropMeshGenerator::generate_crate(vulkan_, 0.8f);
         barrel_mesh_ = PropMeshGenerator::generate_barrel(vulkan_, 0.4f, 1.2f);
 
+        // Materials stream in on worker threads; placeholders until then
+        if (!texture_loader_.init(vulkan_)) {
+            fprintf(stderr, "Failed to create texture loader\n");
+            return false;
+        }
+        load_materials();
+        build_scene_draws();
+
         // Setup lights
         setup_lights();
 
@@ -144,11 +221,24 @@ public:
         } else {
             camera_.set_position(vec3(0, 5, 0));
         }
-        camera_.set_aspect_ratio(window_.aspect_ratio());
+        camera_.set_aspect_ratio(static_cast<float>(render_width) / static_cast<float>(render_height));
+        window_width_ = render_width;
+        window_height_ = render_height;
+        applied_width_ = render_width;
+        applied_height_ = render_height;
+        depth_prepass_ = config_.depth_prepass;
+        shadows_ = config_.shadows;
         camera_.set_fov(70.0f);
         camera_.set_fly_mode(true);
         camera_.set_move_speed(8.0f);
 
+        if (config_.headless) {
+            setup_camera_path();
+            printf("Initialization complete!\n");
+            running_ = true;
+            return true;
+        }
+
         // Capture mouse for FPS controls
         window_.set_mouse_captured(true);
 
@@ -161,6 +251,9 @@ public:
         printf("  Shift     - Sprint\n");
         printf("  Tab       - Toggle mouse capture\n");
         printf("  L         - Toggle lights animation\n");
+        printf("  Z         - Toggle depth pre-pass\n");
+        printf("  H         - Toggle shadows\n");
+        printf("  P         - Print GPU pass timings\n");
         printf("  ESC       - Exit\n\n");
 
         running_ = true;
@@ -207,6 +300,38 @@ public:
         }
 
         printf("    Lights placed: %d\n", lights.light_count());
+
+        // The simulation animates its own copy; packets carry it to the renderer
+        base_lights_ = lights.lights();
+        scene_lights_ = base_lights_;
+    }
+
+    void load_materials() {
+        MaterialLibrary& materials = deferred_.materials();
+
+        printf("  Streaming materials from %s...\n", config_.materials_dir);
+        floor_material_ = materials.add(texture_loader_, config_.materials_dir, "stone_floor");
+        wall_material_ = materials.add(texture_loader_, config_.materials_dir, "stone_wall");
+        metal_material_ = materials.add(texture_loader_, config_.materials_dir, "metal");
+        wood_material_ = materials.add(texture_loader_, config_.materials_dir, "wood");
+        trim_material_ = materials.add(texture_loader_, config_.materials_dir, "decorative_trim");
+    }
+
+    void setup_camera_path() {
+        // Fly through every room center at eye height; the map seed fixes
+        // the route, so runs are comparable
+        std::vector<vec3> points;
+        for (const Room& room : map_generator_->rooms()) {
+            vec3 center = map_generator_->cell_to_world(
+                static_cast<int>(room.center.x),
+                static_cast<int>(room.center.y)
+            );
+            center.y = 1.6f;
+            points.push_back(center);
+        }
+
+        camera_path_.build(points);
+        printf("    Camera path: %zu points, %.1fm\n", points.size(), camera_path_.length());
     }
 
     vec3 hsv_to_rgb(float h, float s, float v) {
@@ -226,15 +351,35 @@ public:
     }
 
     void run() {
-        printf("Starting main loop...\n");
+        if (config_.headless) {
+            run_headless();
+            return;
+        }
+
+        printf("Starting main loop (%s)...\n",
+            config_.render_thread ? "separate render thread" : "single thread");
+
+        if (config_.render_thread) {
+            render_thread_.start([this](const RenderPacket& packet) {
+                render_windowed(packet);
+            });
+        }
 
         while (running_ && !window_.should_close()) {
+            // Low latency: wait for the GPU before sampling input instead of
+            // after, so the frame is recorded from the freshest input
+            if (config_.low_latency) {
+                vulkan_.wait_frame();
+            }
+
             // Begin frame timing
             frame_timer_.begin_frame();
             float dt = frame_timer_.delta_time_f();
+            Timer sim_timer;
 
             // Poll input
             window_.poll_events();
+            input_time_ = Timer::Clock::now();
 
             // Handle escape key
             if (input_.is_key_pressed(SLAM_KEY_ESCAPE)) {
@@ -253,204 +398,378 @@ public:
                 printf("Light animation: %s\n", animate_lights_ ? "ON" : "OFF");
             }
 
+            // Toggle the depth pre-pass with Z (compare "geometry" in the P report)
+            if (input_.is_key_pressed(SLAM_KEY_Z)) {
+                depth_prepass_ = !depth_prepass_;
+                printf("Depth pre-pass: %s\n", depth_prepass_ ? "ON" : "OFF");
+            }
+
+            // Toggle shadows with H (switches lighting pipeline variant)
+            if (input_.is_key_pressed(SLAM_KEY_H)) {
+                shadows_ = !shadows_;
+                printf("Shadows: %s\n", shadows_ ? "ON" : "OFF");
+            }
+
+            // Print GPU timing breakdown with P (on the render thread)
+            if (input_.is_key_pressed(SLAM_KEY_P)) {
+                print_gpu_report_ = true;
+            }
+
+            // Device memory by category with M (the tracker is thread-safe)
+            if (input_.is_key_pressed(SLAM_KEY_M)) {
+                vulkan_.resources().print_report();
+            }
+
             // Update camera
             if (window_.is_mouse_captured()) {
                 camera_.update(input_, dt);
             }
 
-            // Handle window resize
+            // Handle window resize (the renderer follows the packet size)
             if (window_.was_resized()) {
-                camera_.set_aspect_ratio(window_.aspect_ratio());
-                if (use_deferred_) {
-                    deferred_.resize(window_.width(), window_.height());
+                window_width_ = static_cast<uint32_t>(window_.framebuffer_width());
+                window_height_ = static_cast<uint32_t>(window_.framebuffer_height());
+                if (window_height_ > 0) {
+                    camera_.set_aspect_ratio(window_.aspect_ratio());
                 }
             }
 
             // Update lights
-            update_lights(dt);
-
-            // Render
-            if (use_deferred_) {
-                render_deferred();
-            } else {
-                render_basic();
-            }
+            update_lights(static_cast<float>(frame_timer_.total_time()));
 
             // Update input state (must be after all input checks)
             input_.update();
 
-            // Print FPS every second
-            static double last_fps_time = 0;
-            if (frame_timer_.total_time() - last_fps_time >= 1.0) {
-                printf("FPS: %.1f (%.2fms) | Pos: (%.1f, %.1f, %.1f)\n",
-                    frame_timer_.fps(), frame_timer_.frame_time_ms(),
-                    camera_.position().x, camera_.position().y, camera_.position().z);
-                last_fps_time = frame_timer_.total_time();
+            // Hand the frame to the renderer
+            if (config_.render_thread) {
+                build_render_packet(render_thread_.packet(), sim_timer.elapsed() * 1000.0);
+                render_thread_.publish();
+
+                // At most one packet ahead: the renderer works on this one
+                // while the next simulation step runs
+                render_thread_.wait_for_pickup();
+            } else {
+                build_render_packet(packet_, sim_timer.elapsed() * 1000.0);
+                render_windowed(packet_);
             }
         }
 
+        render_thread_.stop();
         printf("Main loop ended.\n");
     }
 
-    void update_lights(float dt) {
-        if (!animate_lights_) return;
+    // Snapshot of everything the renderer needs. Overwrites every field:
+    // triple buffer slots come back with stale contents.
+    void build_render_packet(RenderPacket& packet, double sim_frame_ms) {
+        packet.view = camera_.get_view_matrix();
+        packet.projection = camera_.get_projection_matrix();
+        packet.camera_pos = camera_.position();
+        packet.near_plane = 0.1f;
+        packet.far_plane = 100.0f;
+        packet.lights = scene_lights_;  // Reuses the slot's capacity
+        packet.draws = &draw_list_;
+        packet.shadow_casters = &shadow_list_;
+        packet.width = window_width_;
+        packet.height = window_height_;
+        packet.depth_prepass = depth_prepass_;
+        packet.shadows = shadows_;
+        packet.print_gpu_report = print_gpu_report_;
+        packet.sim_frame_ms = sim_frame_ms;
+        packet.input_time = input_time_;
+
+        print_gpu_report_ = false;
+    }
 
-        auto& lights = deferred_.lights();
-        float time = static_cast<float>(frame_timer_.total_time());
+    // Render thread (or inline): record and present one packet
+    void render_packet(const RenderPacket& packet) {
+        if (packet.print_gpu_report) {
+            vulkan_.profiler().print_report();
+        }
 
-        // Animate light positions slightly
-        for (int i = 0; i < lights.light_count(); i++) {
-            const PointLight& original = lights.lights()[i];
+        // The swapchain follows the packet size, never the window: only the
+        // main thread talks to GLFW (headless contexts ignore it)
+        vulkan_.set_framebuffer_size(packet.width, packet.height);
 
-            // Gentle bobbing motion
-            float offset_y = std::sin(time * 2.0f + i * 0.5f) * 0.2f;
-            vec3 new_pos = original.position;
-            new_pos.y += offset_y;
+        // Minimized: nothing to present until the window comes back
+        if (packet.width == 0 || packet.height == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            return;
+        }
+
+        if (packet.width != applied_width_ || packet.height != applied_height_) {
+            applied_width_ = packet.width;
+            applied_height_ = packet.height;
+            if (use_deferred_) {
+                deferred_.resize(packet.width, packet.height);
+            }
+        }
+        deferred_.set_depth_prepass(packet.depth_prepass);
+        deferred_.set_shadows(packet.shadows);
 
-            lights.set_light_position(i, new_pos);
+        // Upload textures finished since last frame
+        texture_loader_.update();
 
-            // Subtle color pulse
-            float pulse = 0.9f + 0.1f * std::sin(time * 3.0f + i * 0.7f);
-            lights.set_light_intensity(i, original.intensity * pulse);
+        // Render
+        if (use_deferred_) {
+            render_deferred(packet);
+        } else {
+            render_basic(packet);
         }
     }
 
-    void render_deferred() {
-        // Begin frame without auto render pass - deferred manages its own
-        uint32_t image_index;
-        if (!vulkan_.begin_frame(image_index, false)) {
-            return; // Swapchain recreation in progress
+    void render_windowed(const RenderPacket& packet) {
+        render_timer_.begin_frame();
+        uint64_t allocations = thread_heap_allocations();
+        render_packet(packet);
+        heap_allocations_ += thread_heap_allocations() - allocations;
+        heap_frames_++;
+
+        // Print FPS every second
+        if (render_timer_.total_time() - last_fps_time_ >= 1.0) {
+            printf("FPS: %.1f (%.2fms, sim %.2fms) | Pos: (%.1f, %.1f, %.1f)\n",
+                render_timer_.fps(), render_timer_.frame_time_ms(), packet.sim_frame_ms,
+                packet.camera_pos.x, packet.camera_pos.y, packet.camera_pos.z);
+            vulkan_.profiler().print_summary();
+            const DrawListStats& draws = draw_list_.stats();
+            printf("Draws: %u (%u instances), mesh binds: %u (%u skipped)\n",
+                draws.draws, draws.instances, draws.mesh_binds, draws.binds_skipped);
+            if (deferred_.upscaling()) {
+                printf("Render scale: %.2f (%ux%u, %s)\n", deferred_.render_scale(),
+                    deferred_.render_width(), deferred_.render_height(),
+                    deferred_.temporal_upscaling() ? "temporal" : "bilinear");
+            }
+            InputLatencyStats latency = vulkan_.take_input_latency();
+            if (latency.count > 0) {
+                printf("Input latency: %.1fms avg, %.1fms max (input sample to GPU complete)\n",
+                    latency.sum_ms / static_cast<double>(latency.count), latency.max_ms);
+            }
+            const FrameAllocator& frame_memory = vulkan_.frame_allocator();
+            printf("Heap: %.1f allocations/frame (render thread), frame memory %.1f KB peak, %llu overflows\n",
+                static_cast<double>(heap_allocations_) / static_cast<double>(std::max(heap_frames_, 1u)),
+                static_cast<double>(frame_memory.peak()) / 1024.0,
+                static_cast<unsigned long long>(frame_memory.overflow_count()));
+            heap_allocations_ = 0;
+            heap_frames_ = 0;
+            last_fps_time_ = render_timer_.total_time();
         }
+    }
 
-        VkCommandBuffer cmd = vulkan_.current_command_buffer();
+    // Fixed-step run along the camera path: every run renders the same frames
+    void run_headless() {
+        const float dt = 1.0f / 60.0f;
+        const float camera_speed = 4.0f;  // Meters per second along the path
+        const uint32_t frame_count = static_cast<uint32_t>(config_.bench_frames);
 
-        // Get matrices
-        mat4 view = camera_.get_view_matrix();
-        mat4 proj = camera_.get_projection_matrix();
+        printf("Starting headless benchmark (%u frames)...\n", frame_count);
 
-        // Update light data
-        auto& lights = deferred_.lights();
-        lights.upload(camera_.position());
-        lights.update_clusters(view, proj, 0.1f, 100.0f);
+        BenchLog log;
+        log.reset(frame_count);
 
-        // Set view/projection for geometry pass
-        deferred_.set_view_projection(view, proj);
+        // GPU results arrive a few frames late, keyed by profiler frame number
+        // (which matches our frame index: the profiler starts counting here)
+        std::vector<std::pair<const char*, std::string>> gpu_columns;
+        auto gpu_column = [&gpu_columns](const char* scope) -> const char* {
+            for (const auto& column : gpu_columns) {
+                if (column.first == scope) return column.second.c_str();
+            }
+            std::string name = std::string("gpu_") + scope;
+            for (char& c : name) {
+                if (c == ' ') c = '_';
+            }
+            gpu_columns.emplace_back(scope, name);
+            return gpu_columns.back().second.c_str();
+        };
+
+        uint64_t first_gpu_frame = vulkan_.profiler().frame_count();
+        vulkan_.profiler().set_results_callback(
+            [&](uint64_t frame_number, const std::vector<GpuScopeSample>& samples) {
+                for (const GpuScopeSample& sample : samples) {
+                    log.record(gpu_column(sample.name), frame_number - first_gpu_frame, sample.ms);
+                }
+            });
 
-        // ---- Shadow Pass ----
-        // Collect all shadow-casting meshes
-        std::vector<Mesh*> shadow_meshes;
-        std::vector<mat4> shadow_transforms;
+        std::vector<uint8_t> pixels;
+        for (uint32_t frame = 0; frame < frame_count; frame++) {
+            Timer cpu_timer;
 
-        if (map_mesh_->has_floor()) {
-            shadow_meshes.push_back(&map_mesh_->floor_mesh());
-            shadow_transforms.push_back(mat4::identity());
-        }
-        if (map_mesh_->has_walls()) {
-            shadow_meshes.push_back(&map_mesh_->wall_mesh());
-            shadow_transforms.push_back(mat4::identity());
+            float time = static_cast<float>(frame) * dt;
+            if (!camera_path_.empty()) {
+                camera_path_.apply(camera_, time * camera_speed);
+            }
+            update_lights(time);
+            build_render_packet(packet_, 0.0);
+            uint64_t allocations = thread_heap_allocations();
+            render_packet(packet_);
+            uint64_t frame_allocations = thread_heap_allocations() - allocations;
+
+            // Wall time for the frame, including waits on frames in flight
+            log.record("cpu_frame_ms", frame, cpu_timer.elapsed() * 1000.0);
+            log.record("heap_allocs", frame, static_cast<double>(frame_allocations));
+            log.record("draws", frame, draw_list_.stats().draws);
+            log.record("binds_skipped", frame, draw_list_.stats().binds_skipped);
+
+            if (config_.dump_dir && config_.dump_interval > 0 &&
+                frame % static_cast<uint32_t>(config_.dump_interval) == 0) {
+                if (vulkan_.read_image(vulkan_.current_image_index(), pixels)) {
+                    char path[512];
+                    snprintf(path, sizeof(path), "%s/frame_%05u.tga", config_.dump_dir, frame);
+                    VkExtent2D extent = vulkan_.swapchain_extent();
+                    write_tga(path, extent.width, extent.height, pixels);
+                }
+            }
         }
-        if (map_mesh_->has_ceiling()) {
-            shadow_meshes.push_back(&map_mesh_->ceiling_mesh());
-            shadow_transforms.push_back(mat4::identity());
+
+        // Pick up the last frames' GPU timings
+        vulkan_.wait_idle();
+        vulkan_.profiler().flush();
+        vulkan_.profiler().set_results_callback(nullptr);
+
+        log.print_summary(std::min(frame_count, 10u));
+        if (config_.bench_out && log.write_csv(config_.bench_out)) {
+            printf("Wrote %s\n", config_.bench_out);
         }
 
-        // Add props to shadow casters
-        for (const PropPlacement& prop : map_generator_->props()) {
-            mat4 model = translate(prop.position);
-            model = rotate(model, prop.rotation, vec3(0, 1, 0));
-            model = scale(model, vec3(prop.scale));
+        printf("Headless benchmark ended.\n");
+    }
 
-            Mesh* mesh = nullptr;
-            switch (prop.prop_type) {
-                case 0: mesh = column_mesh_.get(); break;
-                case 1: mesh = crate_mesh_.get(); break;
-                case 2: mesh = barrel_mesh_.get(); break;
-            }
+    void update_lights(float time) {
+        if (!animate_lights_) return;
 
-            if (mesh) {
-                shadow_meshes.push_back(mesh);
-                shadow_transforms.push_back(model);
-            }
-        }
+        // Both waves repeat every 2*PI seconds; wrapping keeps fast::sin
+        // in its accurate range however long the session runs
+        float phase = std::fmod(time, TWO_PI);
 
-        // Render shadow maps for all lights
-        deferred_.render_shadows(cmd, shadow_meshes, shadow_transforms);
+        // Animate relative to the placed lights
+        for (size_t i = 0; i < scene_lights_.size(); i++) {
+            const PointLight& original = base_lights_[i];
+            PointLight& light = scene_lights_[i];
 
-        // ---- Geometry Pass ----
-        deferred_.begin_geometry_pass(cmd);
+            // Gentle bobbing motion
+            float offset_y = fast::sin(phase * 2.0f + i * 0.5f) * 0.2f;
+            light.position = original.position;
+            light.position.y += offset_y;
 
-        // Draw floor
-        if (map_mesh_->has_floor()) {
-            deferred_.draw_mesh(cmd, map_mesh_->floor_mesh(), mat4::identity());
+            // Subtle color pulse
+            float pulse = 0.9f + 0.1f * fast::sin(phase * 3.0f + i * 0.7f);
+            light.intensity = original.intensity * pulse;
         }
+    }
 
-        // Draw walls
-        if (map_mesh_->has_walls()) {
-            deferred_.draw_mesh(cmd, map_mesh_->wall_mesh(), mat4::identity());
+    void render_deferred(const RenderPacket& packet) {
+        uint32_t image_index;
+        if (!vulkan_.begin_frame(image_index)) {
+            return; // Swapchain recreation in progress
         }
+        vulkan_.mark_input(packet.input_time);
 
-        // Draw ceiling
-        if (map_mesh_->has_ceiling()) {
-            deferred_.draw_mesh(cmd, map_mesh_->ceiling_mesh(), mat4::identity());
-        }
+        VkCommandBuffer cmd = vulkan_.current_command_buffer();
 
-        // Draw props
-        for (const PropPlacement& prop : map_generator_->props()) {
-            mat4 model = translate(prop.position);
-            model = rotate(model, prop.rotation, vec3(0, 1, 0));
-            model = scale(model, vec3(prop.scale));
+        // Update light data (cluster binning runs here, on the render side)
+        auto& lights = deferred_.lights();
+        lights.set_lights(packet.lights);
+        lights.upload(packet.camera_pos);
+        lights.update_clusters(packet.view, packet.projection, packet.near_plane, packet.far_plane);
 
-            Mesh* mesh = nullptr;
-            switch (prop.prop_type) {
-                case 0: mesh = column_mesh_.get(); break;
-                case 1: mesh = crate_mesh_.get(); break;
-                case 2: mesh = barrel_mesh_.get(); break;
+        // Set view/projection for geometry pass
+        deferred_.set_view_projection(packet.view, packet.projection);
+
+        // ---- Frame graph: shadows -> geometry -> lighting ----
+        DeferredFrame frame;
+        frame.camera_pos = packet.camera_pos;
+        frame.near_plane = packet.near_plane;
+        frame.far_plane = packet.far_plane;
+        frame.shadow_casters = packet.shadow_casters;
+        DrawList* draws = packet.draws;
+        frame.draw_geometry = [this, draws](VkCommandBuffer draw_cmd) {
+            if (draws) {
+                deferred_.draw_list(draw_cmd, *draws);
             }
+        };
 
-            if (mesh) {
-                deferred_.draw_mesh(cmd, *mesh, model);
-            }
-        }
+        deferred_.render_frame(cmd, frame);
 
-        deferred_.end_geometry_pass(cmd);
+        vulkan_.end_frame(image_index);
+    }
 
-        // ---- Lighting Pass ----
-        deferred_.begin_lighting_pass(cmd, vulkan_.current_framebuffer(),
-                                      vulkan_.render_pass(),
-                                      window_.width(), window_.height());
+    // Static scene draws: one instanced draw per prop type in each pass.
+    // Call again whenever props are added, removed or moved, but only while
+    // the render thread is stopped: packets point at these lists, and the
+    // instance upload submits to the queue the render thread owns.
+    void build_scene_draws() {
+        if (render_thread_.running()) {
+            fprintf(stderr, "build_scene_draws: stop the render thread first\n");
+            return;
+        }
 
-        deferred_.render_lighting(cmd, camera_.position(), 0.1f, 100.0f);
+        // Group prop transforms by type so each type is one contiguous range
+        Mesh* prop_meshes[] = {column_mesh_.get(), crate_mesh_.get(), barrel_mesh_.get()};
+        uint32_t prop_materials[] = {trim_material_, wood_material_, metal_material_};
+        constexpr uint32_t prop_type_count = 3;
+
+        std::vector<Transform> transforms;
+        uint32_t first[prop_type_count] = {};
+        uint32_t count[prop_type_count] = {};
+        for (uint32_t type = 0; type < prop_type_count; type++) {
+            first[type] = static_cast<uint32_t>(transforms.size());
+            for (const PropPlacement& prop : map_generator_->props()) {
+                if (prop.prop_type != static_cast<int>(type)) continue;
+
+                transforms.emplace_back(prop.position, quat::from_axis_angle(vec3(0, 1, 0), prop.rotation),
+                                        prop.scale);
+            }
+            count[type] = static_cast<uint32_t>(transforms.size()) - first[type];
+        }
+        prop_instances_.upload(vulkan_, transforms);
 
-        deferred_.end_lighting_pass(cmd);
+        draw_list_.clear();
+        shadow_list_.clear();
+        for (DrawList* list : {&draw_list_, &shadow_list_}) {
+            if (map_mesh_->has_floor()) {
+                list->add(map_mesh_->floor_mesh(), mat4::identity(), floor_material_, 0.0f);
+            }
+            if (map_mesh_->has_walls()) {
+                list->add(map_mesh_->wall_mesh(), mat4::identity(), wall_material_, 0.0f);
+            }
+            if (map_mesh_->has_ceiling()) {
+                list->add(map_mesh_->ceiling_mesh(), mat4::identity(), wall_material_, 0.0f);
+            }
+            for (uint32_t type = 0; type < prop_type_count; type++) {
+                if (prop_meshes[type]) {
+                    list->add_instanced(*prop_meshes[type], prop_instances_, first[type], count[type],
+                                        prop_materials[type]);
+                }
+            }
+            list->sort();
+        }
 
-        // End frame without ending render pass - lighting pass already ended it
-        vulkan_.end_frame(image_index, false);
+        printf("    Props: %u instances in %u instanced draws\n",
+            prop_instances_.count(), prop_type_count);
     }
 
-    void render_basic() {
+    void render_basic(const RenderPacket& packet) {
         // Fallback basic rendering (Phase 1 style)
         uint32_t image_index;
         if (!vulkan_.begin_frame(image_index)) {
             return;
         }
+        vulkan_.mark_input(packet.input_time);
 
         VkCommandBuffer cmd = vulkan_.current_command_buffer();
+        vulkan_.begin_render_pass(cmd);
 
         pipeline_.bind(cmd);
 
-        mat4 view = camera_.get_view_matrix();
-        mat4 proj = camera_.get_projection_matrix();
+        // Camera matrices once per frame; each mesh pushes only its model
+        basic_uniforms_.update(packet.view, packet.projection);
+        basic_uniforms_.bind(cmd, pipeline_.layout(), 0);
+
+        PushConstants constants;
+        mat4 model = mat4::identity();
+        memcpy(constants.model, model.data(), sizeof(float) * 16);
 
         // Draw floor
         if (map_mesh_->has_floor()) {
             map_mesh_->floor_mesh().bind(cmd);
-
-            PushConstants constants;
-            mat4 model = mat4::identity();
-            memcpy(constants.model, model.data(), sizeof(float) * 16);
-            memcpy(constants.view, view.data(), sizeof(float) * 16);
-            memcpy(constants.projection, proj.data(), sizeof(float) * 16);
-
             pipeline_.push_constants(cmd, constants);
             map_mesh_->floor_mesh().draw(cmd);
         }
@@ -458,13 +777,6 @@ public:
         // Draw walls
         if (map_mesh_->has_walls()) {
             map_mesh_->wall_mesh().bind(cmd);
-
-            PushConstants constants;
-            mat4 model = mat4::identity();
-            memcpy(constants.model, model.data(), sizeof(float) * 16);
-            memcpy(constants.view, view.data(), sizeof(float) * 16);
-            memcpy(constants.projection, proj.data(), sizeof(float) * 16);
-
             pipeline_.push_constants(cmd, constants);
             map_mesh_->wall_mesh().draw(cmd);
         }
@@ -472,17 +784,11 @@ public:
         // Draw ceiling
         if (map_mesh_->has_ceiling()) {
             map_mesh_->ceiling_mesh().bind(cmd);
-
-            PushConstants constants;
-            mat4 model = mat4::identity();
-            memcpy(constants.model, model.data(), sizeof(float) * 16);
-            memcpy(constants.view, view.data(), sizeof(float) * 16);
-            memcpy(constants.projection, proj.data(), sizeof(float) * 16);
-
             pipeline_.push_constants(cmd, constants);
             map_mesh_->ceiling_mesh().draw(cmd);
         }
 
+        vulkan_.end_render_pass(cmd);
         vulkan_.end_frame(image_index);
     }
 
@@ -492,7 +798,16 @@ public:
         // Wait for GPU to finish
         vulkan_.wait_idle();
 
-        // Cleanup in reverse order
+        if (config_.memory_report) {
+            vulkan_.resources().print_report();
+        }
+
+        // Cleanup in reverse order (the loader first: it writes into the
+        // material library's textures)
+        texture_loader_.shutdown();
+        draw_list_.clear();
+        shadow_list_.clear();
+        prop_instances_.destroy();
         barrel_mesh_.reset();
         crate_mesh_.reset();
         column_mesh_.reset();
@@ -501,6 +816,7 @@ public:
 
         deferred_.destroy();
         pipeline_.destroy();
+        basic_uniforms_.destroy();
         vulkan_.shutdown();
         window_.shutdown();
 
@@ -517,9 +833,17 @@ private:
     InputManager input_;
     VulkanContext vulkan_;
     Pipeline pipeline_;          // Fallback
+    FrameUniformBuffer basic_uniforms_;  // Fallback camera matrices
     DeferredPipeline deferred_;  // Main renderer
     Camera camera_;
-    FrameTimer frame_timer_;
+    FrameTimer frame_timer_;   // Simulation
+    FrameTimer render_timer_;  // Render thread
+    double last_fps_time_ = 0.0;
+
+    // Heap allocations made while rendering, over the current FPS interval
+    uint64_t heap_allocations_ = 0;
+    uint32_t heap_frames_ = 0;
+    CameraPath camera_path_;  // Headless benchmark route
 
     // Map
     std::unique_ptr<MapGenerator> map_generator_;
@@ -529,6 +853,35 @@ private:
     std::unique_ptr<Mesh> column_mesh_;
     std::unique_ptr<Mesh> crate_mesh_;
     std::unique_ptr<Mesh> barrel_mesh_;
+
+    // Simulation-side state, handed over in render packets
+    RenderThread render_thread_;
+    RenderPacket packet_;  // Single-threaded and headless runs
+    std::vector<PointLight> base_lights_;   // As placed
+    std::vector<PointLight> scene_lights_;  // Animated
+    uint32_t window_width_ = 0;
+    uint32_t window_height_ = 0;
+    bool depth_prepass_ = false;
+    bool shadows_ = true;
+    bool print_gpu_report_ = false;
+    Timer::TimePoint input_time_;  // Last input poll
+
+    // Render side: size the renderer was last resized to
+    uint32_t applied_width_ = 0;
+    uint32_t applied_height_ = 0;
+
+    // Static scene draws, built at map load
+    InstanceBuffer prop_instances_;
+    DrawList draw_list_;    // Geometry pass
+    DrawList shadow_list_;  // Shadow casters
+
+    // Materials (owned by deferred_'s library, streamed by the loader)
+    TextureLoader texture_loader_;
+    uint32_t floor_material_ = MATERIAL_NONE;
+    uint32_t wall_material_ = MATERIAL_NONE;
+    uint32_t metal_material_ = MATERIAL_NONE;
+    uint32_t wood_material_ = MATERIAL_NONE;
+    uint32_t trim_material_ = MATERIAL_NONE;
 };
 
 } // namespace slam
@@ -541,7 +894,25 @@ void print_usage(const char* program_name) {
     printf("  --size <number>     Map size (default: 128, range: 64-512)\n");
     printf("  --windowed          Run in windowed mode (1920x1080)\n");
     printf("  --no-validation     Disable Vulkan validation layers\n");
-    printf("  --no-vsync          Disable VSync\n");
+    printf("  --no-vsync          Disable VSync (same as --present-mode mailbox)\n");
+    printf("  --present-mode <m>  fifo (vsync), mailbox or immediate (tearing)\n");
+    printf("  --low-latency       Sample input after the previous frame completes\n");
+    printf("                      (one frame in flight, no render thread)\n");
+    printf("  --subpass-lighting  Single render pass deferred path (G-buffer stays on-chip)\n");
+    printf("  --render-scale <f>  Internal resolution scale, upscaled to the window (0.5-1.0)\n");
+    printf("  --dynamic-res       Scale internal resolution to hold the GPU frame budget\n");
+    printf("  --gpu-budget <ms>   Dynamic resolution GPU frame time target (default: 16.6)\n");
+    printf("  --temporal          Temporal upscale (jitter + reprojection) when render scale < 1\n");
+    printf("  --depth-prepass     Depth-only pass before the G-buffer pass (toggle: Z)\n");
+    printf("  --no-shadows        Disable point light shadows (toggle: H)\n");
+    printf("  --single-thread     Record and present on the main thread\n");
+    printf("  --memory-report     Print device memory by category at shutdown (any time: M)\n");
+    printf("  --headless          Render offscreen along a scripted camera path (no window)\n");
+    printf("  --frames <number>   Headless frame count (default: 600)\n");
+    printf("  --bench-out <file>  Write per-frame CPU/GPU timings as CSV (headless)\n");
+    printf("  --dump-frames <dir> Save rendered frames as TGA (headless)\n");
+    printf("  --dump-interval <n> Frames between dumps (default: 60)\n");
+    printf("  --materials <dir>   Material baker output (default: assets/materials)\n");
     printf("  --help              Show this help message\n");
 }
 
@@ -576,7 +947,72 @@ int main(int argc, char* argv[]) {
             config.enable_validation = false;
         }
         else if (strcmp(argv[i], "--no-vsync") == 0) {
-            config.vsync = false;
+            config.present_mode = slam::PresentMode::Mailbox;
+        }
+        else if (strcmp(argv[i], "--present-mode") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "fifo") == 0) {
+                config.present_mode = slam::PresentMode::Fifo;
+            } else if (strcmp(mode, "mailbox") == 0) {
+                config.present_mode = slam::PresentMode::Mailbox;
+            } else if (strcmp(mode, "immediate") == 0) {
+                config.present_mode = slam::PresentMode::Immediate;
+            } else {
+                printf("Unknown present mode: %s\n", mode);
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--low-latency") == 0) {
+            config.low_latency = true;
+        }
+        else if (strcmp(argv[i], "--subpass-lighting") == 0) {
+            config.subpass_lighting = true;
+        }
+        else if (strcmp(argv[i], "--render-scale") == 0 && i + 1 < argc) {
+            config.render_scale = static_cast<float>(atof(argv[++i]));
+            if (config.render_scale < 0.5f) config.render_scale = 0.5f;
+            if (config.render_scale > 1.0f) config.render_scale = 1.0f;
+        }
+        else if (strcmp(argv[i], "--dynamic-res") == 0) {
+            config.dynamic_resolution = true;
+        }
+        else if (strcmp(argv[i], "--gpu-budget") == 0 && i + 1 < argc) {
+            config.gpu_budget_ms = static_cast<float>(atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--temporal") == 0) {
+            config.temporal_upscale = true;
+        }
+        else if (strcmp(argv[i], "--depth-prepass") == 0) {
+            config.depth_prepass = true;
+        }
+        else if (strcmp(argv[i], "--no-shadows") == 0) {
+            config.shadows = false;
+        }
+        else if (strcmp(argv[i], "--single-thread") == 0) {
+            config.render_thread = false;
+        }
+        else if (strcmp(argv[i], "--memory-report") == 0) {
+            config.memory_report = true;
+        }
+        else if (strcmp(argv[i], "--headless") == 0) {
+            config.headless = true;
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            config.bench_frames = atoi(argv[++i]);
+            if (config.bench_frames < 1) config.bench_frames = 1;
+        }
+        else if (strcmp(argv[i], "--bench-out") == 0 && i + 1 < argc) {
+            config.bench_out = argv[++i];
+        }
+        else if (strcmp(argv[i], "--dump-frames") == 0 && i + 1 < argc) {
+            config.dump_dir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--dump-interval") == 0 && i + 1 < argc) {
+            config.dump_interval = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--materials") == 0 && i + 1 < argc) {
+            config.materials_dir = argv[++i];
         }
         else if (strcmp(argv[i], "--help") == 0) {
             print_usage(argv[0]);
@@ -0,0 +1,107 @@
+/**
+ * Slam Engine - Camera Path Implementation
+ */
+
+#include "camera_path.h"
+#include "camera.h"
+#include <algorithm>
+#include <cmath>
+
+namespace slam {
+
+void CameraPath::build(const std::vector<vec3>& points) {
+    points_.clear();
+    arc_lengths_.clear();
+    length_ = 0.0f;
+
+    if (points.empty()) return;
+
+    // Greedy nearest-neighbour tour keeps consecutive points close together
+    std::vector<bool> visited(points.size(), false);
+    size_t current = 0;
+    for (size_t n = 0; n < points.size(); n++) {
+        visited[current] = true;
+        points_.push_back(points[current]);
+
+        float best = 0.0f;
+        size_t next = current;
+        for (size_t i = 0; i < points.size(); i++) {
+            if (visited[i]) continue;
+            float d = (points[i] - points[current]).length_squared();
+            if (next == current || d < best) {
+                best = d;
+                next = i;
+            }
+        }
+        current = next;
+    }
+
+    if (points_.size() < 2) return;
+
+    // Arc length table for constant-speed sampling
+    int sample_count = static_cast<int>(points_.size()) * SAMPLES_PER_SEGMENT;
+    arc_lengths_.resize(sample_count + 1);
+    arc_lengths_[0] = 0.0f;
+
+    vec3 previous = evaluate(0.0f);
+    for (int i = 1; i <= sample_count; i++) {
+        vec3 p = evaluate(static_cast<float>(i) / SAMPLES_PER_SEGMENT);
+        length_ += (p - previous).length();
+        arc_lengths_[i] = length_;
+        previous = p;
+    }
+}
+
+vec3 CameraPath::evaluate(float t) const {
+    int count = static_cast<int>(points_.size());
+    int segment = static_cast<int>(std::floor(t));
+    float f = t - static_cast<float>(segment);
+
+    auto point = [&](int i) { return points_[((i % count) + count) % count]; };
+    vec3 p0 = point(segment - 1);
+    vec3 p1 = point(segment);
+    vec3 p2 = point(segment + 1);
+    vec3 p3 = point(segment + 2);
+
+    // Uniform Catmull-Rom
+    float f2 = f * f;
+    float f3 = f2 * f;
+    return 0.5f * ((2.0f * p1) +
+                   (p2 - p0) * f +
+                   (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * f2 +
+                   (3.0f * p1 - p0 - 3.0f * p2 + p3) * f3);
+}
+
+vec3 CameraPath::position_at(float distance) const {
+    if (points_.empty()) return vec3(0);
+    if (empty()) return points_[0];
+
+    distance = std::fmod(distance, length_);
+    if (distance < 0.0f) distance += length_;
+
+    // Binary search the arc length table, then interpolate inside the sample
+    auto it = std::upper_bound(arc_lengths_.begin(), arc_lengths_.end(), distance);
+    int i = std::max(1, static_cast<int>(it - arc_lengths_.begin()));
+    i = std::min(i, static_cast<int>(arc_lengths_.size()) - 1);
+
+    float span = arc_lengths_[i] - arc_lengths_[i - 1];
+    float f = span > EPSILON ? (distance - arc_lengths_[i - 1]) / span : 0.0f;
+    float t = (static_cast<float>(i - 1) + f) / SAMPLES_PER_SEGMENT;
+    return evaluate(t);
+}
+
+void CameraPath::apply(Camera& camera, float distance) const {
+    vec3 position = position_at(distance);
+    vec3 ahead = position_at(distance + 1.0f);
+    vec3 direction = normalize(ahead - position);
+
+    camera.set_position(position);
+
+    // Inverse of Camera::forward()
+    if (direction.length_squared() > EPSILON) {
+        camera.set_yaw(std::atan2(direction.x, -direction.z));
+        camera.set_pitch(std::asin(clamp(direction.y, -1.0f, 1.0f)));
+    }
+}
+
+} // namespace slam
@@ -0,0 +1,46 @@
+/**
+ * Slam Engine - Camera Path
+ *
+ * Scripted fly-through for benchmarks: a closed Catmull-Rom spline through
+ * a list of points (e.g. room centers), sampled by distance so the camera
+ * moves at constant speed regardless of frame rate.
+ */
+
+#pragma once
+
+#include "utils/math.h"
+#include <vector>
+
+namespace slam {
+
+class Camera;
+
+class CameraPath {
+public:
+    CameraPath() = default;
+
+    // Build a closed path through the points, visiting them in nearest
+    // neighbour order from the first one (deterministic for a given input)
+    void build(const std::vector<vec3>& points);
+
+    // Total path length in world units
+    float length() const { return length_; }
+    bool empty() const { return points_.size() < 2; }
+
+    // Position at a distance along the path (wraps around)
+    vec3 position_at(float distance) const;
+
+    // Place the camera at a distance along the path, looking ahead
+    void apply(Camera& camera, float distance) const;
+
+private:
+    vec3 evaluate(float t) const;  // t in [0, point count)
+
+    std::vector<vec3> points_;
+    std::vector<float> arc_lengths_;  // Cumulative length at each sample
+    float length_ = 0.0f;
+
+    static constexpr int SAMPLES_PER_SEGMENT = 32;
+};
+
+} // namespace slam
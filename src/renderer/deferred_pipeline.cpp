@@ -5,6 +5,7 @@
 #include "deferred_pipeline.h"
 #include "vulkan_context.h"
 #include "mesh.h"
+#include <algorithm>
 #include <array>
 #include <cstdio>
 #include <cstring>
@@ -15,29 +16,80 @@ DeferredPipeline::~DeferredPipeline() {
     destroy();
 }
 
-bool DeferredPipeline::init(VulkanContext& context, uint32_t width, uint32_t height) {
+bool DeferredPipeline::init(VulkanContext& context, uint32_t width, uint32_t height,
+                            const DeferredPipelineConfig& config) {
     context_ = &context;
+    config_ = config;
     width_ = width;
     height_ = height;
 
-    // Initialize G-buffer
-    if (!gbuffer_.init(context, width, height)) {
+    // The combined render pass renders straight into the swapchain image
+    if (config_.subpass_lighting) {
+        width_ = context.swapchain_extent().width;
+        height_ = context.swapchain_extent().height;
+        swapchain_generation_ = context.swapchain_generation();
+    }
+
+    // Scaled rendering needs a separate lighting target to upscale from
+    bool scaled = config_.dynamic_resolution || config_.render_scale < 1.0f;
+    upscaling_ = scaled && !config_.subpass_lighting;
+    if (scaled && config_.subpass_lighting) {
+        printf("    Render scale ignored: subpass lighting renders at swapchain size\n");
+    }
+
+    depth_prepass_ = config_.depth_prepass;
+    shadows_enabled_ = config_.shadows;
+    resolution_.init(config_.resolution);
+    set_render_scale(config_.dynamic_resolution ? resolution_.scale() : config_.render_scale);
+
+    // Initialize G-buffer (always full size; scaled frames use a sub-rectangle)
+    if (!gbuffer_.init(context, width_, height_, config_.subpass_lighting)) {
         fprintf(stderr, "Failed to initialize G-buffer\n");
         return false;
     }
 
+    // External G-buffer traffic, for comparing the separate and subpass paths
+    double gbuffer_mb = static_cast<double>(gbuffer_.external_bytes_per_frame()) / (1024.0 * 1024.0);
+    printf("    G-buffer: %ux%u, %s lighting%s, %.1f MB/frame external traffic (%.2f GB/s at 60 fps)\n",
+        width_, height_, config_.subpass_lighting ? "subpass" : "separate pass",
+        gbuffer_.lazily_allocated() ? " (lazily allocated)" : "",
+        gbuffer_mb, gbuffer_mb * 60.0 / 1024.0);
+
     // Initialize light manager
     if (!lights_.init(context)) {
         fprintf(stderr, "Failed to initialize light manager\n");
         return false;
     }
 
+    // Initialize material library
+    if (!materials_.init(context)) {
+        fprintf(stderr, "Failed to initialize material library\n");
+        return false;
+    }
+
+    // Camera matrices, uploaded once per frame
+    if (!frame_uniforms_.init(context)) {
+        fprintf(stderr, "Failed to initialize frame uniforms\n");
+        return false;
+    }
+
     // Initialize shadow maps
     if (!shadows_.init(context)) {
         fprintf(stderr, "Failed to initialize shadow maps\n");
         return false;
     }
 
+    shadow_scope_names_.clear();
+    for (uint32_t i = 0; i < shadows_.max_lights(); i++) {
+        shadow_scope_names_.push_back("shadow light " + std::to_string(i));
+    }
+
+    // Instanced pipelines always read binding 1; plain draws use this
+    if (!identity_instance_.upload(context, {Transform()})) {
+        fprintf(stderr, "Failed to create identity instance buffer\n");
+        return false;
+    }
+
     // Create full-screen quad
     float quad_vertices[] = {
         -1.0f, -1.0f, 0.0f, 0.0f,
@@ -51,7 +103,7 @@ bool DeferredPipeline::init(VulkanContext& context, uint32_t width, uint32_t hei
     context.create_buffer(sizeof(quad_vertices),
         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        quad_vertex_buffer_, quad_vertex_memory_);
+        quad_vertex_buffer_, quad_vertex_memory_, ResourceCategory::Meshes);
 
     void* data;
     vkMapMemory(context.device(), quad_vertex_memory_, 0, sizeof(quad_vertices), 0, &data);
@@ -79,12 +131,45 @@ bool DeferredPipeline::init(VulkanContext& context, uint32_t width, uint32_t hei
         return false;
     }
 
+    if (upscaling_) {
+        if (!create_scene_render_pass() || !create_upscale_pipeline()) {
+            fprintf(stderr, "Failed to create upscale pipeline\n");
+            return false;
+        }
+        printf("    Render scale: %s %.2f (%ux%u -> %ux%u)\n",
+            config_.dynamic_resolution ? "dynamic, starting at" : "fixed",
+            render_scale_, render_width_, render_height_, width_, height_);
+
+        if (config_.temporal_upscale) {
+            if (!temporal_upscaler_.init(context, width_, height_, quad_vertex_buffer_)) {
+                fprintf(stderr, "Failed to initialize temporal upscaler\n");
+                return false;
+            }
+            temporal_ = true;
+            printf("    Temporal upscale: jittered, reprojected into %ux%u history\n", width_, height_);
+        }
+    } else if (config_.temporal_upscale) {
+        printf("    Temporal upscale ignored: needs a render scale below 1 or dynamic resolution\n");
+    }
+
     // Initial descriptor update
     if (!update_descriptor_sets()) {
         fprintf(stderr, "Failed to update descriptor sets\n");
         return false;
     }
 
+    // Frame graph
+    graph_.init(context);
+    if (!build_frame_graph()) {
+        fprintf(stderr, "Failed to build frame graph\n");
+        return false;
+    }
+
+    printf("    Render graph: %u passes (%u culled), %u barriers, %.1f MB transient (%.1f MB before aliasing)\n",
+        graph_.pass_count(), graph_.culled_pass_count(), graph_.barrier_count(),
+        static_cast<double>(graph_.transient_bytes()) / (1024.0 * 1024.0),
+        static_cast<double>(graph_.transient_bytes_unaliased()) / (1024.0 * 1024.0));
+
     return true;
 }
 
@@ -99,25 +184,30 @@ void DeferredPipeline::destroy() {
         vkDestroyBuffer(device, quad_vertex_buffer_, nullptr);
         quad_vertex_buffer_ = VK_NULL_HANDLE;
     }
-    if (quad_vertex_memory_) {
-        vkFreeMemory(device, quad_vertex_memory_, nullptr);
-        quad_vertex_memory_ = VK_NULL_HANDLE;
-    }
+    context_->free_memory(quad_vertex_memory_);
 
     // Destroy pipelines
     if (geometry_pipeline_) {
         vkDestroyPipeline(device, geometry_pipeline_, nullptr);
         geometry_pipeline_ = VK_NULL_HANDLE;
     }
+    if (geometry_equal_pipeline_) {
+        vkDestroyPipeline(device, geometry_equal_pipeline_, nullptr);
+        geometry_equal_pipeline_ = VK_NULL_HANDLE;
+    }
+    if (depth_prepass_pipeline_) {
+        vkDestroyPipeline(device, depth_prepass_pipeline_, nullptr);
+        depth_prepass_pipeline_ = VK_NULL_HANDLE;
+    }
     if (geometry_layout_) {
         vkDestroyPipelineLayout(device, geometry_layout_, nullptr);
         geometry_layout_ = VK_NULL_HANDLE;
     }
 
-    if (lighting_pipeline_) {
-        vkDestroyPipeline(device, lighting_pipeline_, nullptr);
-        lighting_pipeline_ = VK_NULL_HANDLE;
+    for (auto& variant : lighting_variants_) {
+        vkDestroyPipeline(device, variant.second, nullptr);
     }
+    lighting_variants_.clear();
     if (lighting_layout_) {
         vkDestroyPipelineLayout(device, lighting_layout_, nullptr);
         lighting_layout_ = VK_NULL_HANDLE;
@@ -132,6 +222,27 @@ void DeferredPipeline::destroy() {
         shadow_layout_ = VK_NULL_HANDLE;
     }
 
+    if (upscale_pipeline_) {
+        vkDestroyPipeline(device, upscale_pipeline_, nullptr);
+        upscale_pipeline_ = VK_NULL_HANDLE;
+    }
+    if (upscale_layout_) {
+        vkDestroyPipelineLayout(device, upscale_layout_, nullptr);
+        upscale_layout_ = VK_NULL_HANDLE;
+    }
+    if (upscale_sampler_) {
+        vkDestroySampler(device, upscale_sampler_, nullptr);
+        upscale_sampler_ = VK_NULL_HANDLE;
+    }
+    if (scene_framebuffer_) {
+        vkDestroyFramebuffer(device, scene_framebuffer_, nullptr);
+        scene_framebuffer_ = VK_NULL_HANDLE;
+    }
+    if (scene_render_pass_) {
+        vkDestroyRenderPass(device, scene_render_pass_, nullptr);
+        scene_render_pass_ = VK_NULL_HANDLE;
+    }
+
     // Destroy descriptors
     if (lighting_descriptor_pool_) {
         vkDestroyDescriptorPool(device, lighting_descriptor_pool_, nullptr);
@@ -141,9 +252,24 @@ void DeferredPipeline::destroy() {
         vkDestroyDescriptorSetLayout(device, lighting_descriptor_layout_, nullptr);
         lighting_descriptor_layout_ = VK_NULL_HANDLE;
     }
+    if (upscale_descriptor_pool_) {
+        vkDestroyDescriptorPool(device, upscale_descriptor_pool_, nullptr);
+        upscale_descriptor_pool_ = VK_NULL_HANDLE;
+    }
+    if (upscale_descriptor_layout_) {
+        vkDestroyDescriptorSetLayout(device, upscale_descriptor_layout_, nullptr);
+        upscale_descriptor_layout_ = VK_NULL_HANDLE;
+    }
+
+    identity_instance_.destroy();
 
     // Destroy subsystems
+    temporal_upscaler_.destroy();
+    temporal_ = false;
+    graph_.destroy();
     shadows_.destroy();
+    frame_uniforms_.destroy();
+    materials_.destroy();
     lights_.destroy();
     gbuffer_.destroy();
 
@@ -151,60 +277,297 @@ void DeferredPipeline::destroy() {
 }
 
 bool DeferredPipeline::resize(uint32_t width, uint32_t height) {
+    // Subpass mode follows the swapchain extent instead (see sync_swapchain)
+    if (config_.subpass_lighting) {
+        return true;
+    }
+
     width_ = width;
     height_ = height;
+    set_render_scale(render_scale_);
 
     if (!gbuffer_.resize(width, height)) {
         return false;
     }
 
-    return update_descriptor_sets();
+    if (temporal_ && !temporal_upscaler_.resize(width, height)) {
+        return false;
+    }
+
+    // G-buffer images changed, so the graph's imports did too
+    return update_descriptor_sets() && build_frame_graph();
+}
+
+bool DeferredPipeline::sync_swapchain() {
+    if (swapchain_generation_ == context_->swapchain_generation()) {
+        return true;
+    }
+
+    // Swapchain was recreated: framebuffers reference the old image views
+    swapchain_generation_ = context_->swapchain_generation();
+    width_ = context_->swapchain_extent().width;
+    height_ = context_->swapchain_extent().height;
+    set_render_scale(render_scale_);
+
+    if (!gbuffer_.resize(width_, height_)) {
+        return false;
+    }
+
+    return update_descriptor_sets() && build_frame_graph();
+}
+
+void DeferredPipeline::set_render_scale(float scale) {
+    render_scale_ = upscaling_ ? scale : 1.0f;
+    render_width_ = static_cast<uint32_t>(static_cast<float>(width_) * render_scale_ + 0.5f);
+    render_height_ = static_cast<uint32_t>(static_cast<float>(height_) * render_scale_ + 0.5f);
+    render_width_ = std::clamp(render_width_, 1u, std::max(width_, 1u));
+    render_height_ = std::clamp(render_height_, 1u, std::max(height_, 1u));
+}
+
+bool DeferredPipeline::build_frame_graph() {
+    // The scene framebuffer references the graph's transient image
+    if (scene_framebuffer_) {
+        vkDestroyFramebuffer(context_->device(), scene_framebuffer_, nullptr);
+        scene_framebuffer_ = VK_NULL_HANDLE;
+    }
+
+    graph_.reset();
+
+    // SHADER_READ_ONLY from ShadowMapArray::init, then from each shadow render pass
+    rg_shadows_ = graph_.import_image("shadow_maps", shadows_.image(), VK_IMAGE_ASPECT_DEPTH_BIT,
+                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    // Swapchain image is set per frame in render_frame()
+    rg_swapchain_ = graph_.import_image("swapchain", VK_NULL_HANDLE, VK_IMAGE_ASPECT_COLOR_BIT,
+                                        VK_IMAGE_LAYOUT_UNDEFINED);
+    graph_.set_output(rg_swapchain_);
+
+    uint32_t shadow_pass = graph_.add_pass("shadows", [this](VkCommandBuffer cmd) {
+        // Skipped, the render pass leaves the maps in their previous layout
+        if (frame_->shadow_casters && shadows_enabled_) {
+            render_shadows(cmd, *frame_->shadow_casters);
+        }
+    });
+    graph_.write(shadow_pass, rg_shadows_, RGAccess::DepthAttachment,
+                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    if (config_.subpass_lighting) {
+        // The G-buffer only exists inside the combined render pass, whose
+        // subpass dependencies handle geometry -> lighting
+        uint32_t deferred_pass = graph_.add_pass("deferred", [this](VkCommandBuffer cmd) {
+            begin_geometry_pass(cmd);
+            record_geometry(cmd);
+            end_geometry_pass(cmd);
+
+            begin_lighting_pass(cmd, VK_NULL_HANDLE, VK_NULL_HANDLE, width_, height_);
+            render_lighting(cmd, frame_->camera_pos, frame_->near_plane, frame_->far_plane);
+            end_lighting_pass(cmd);
+        });
+        graph_.read(deferred_pass, rg_shadows_, RGAccess::ShaderRead);
+        graph_.write(deferred_pass, rg_swapchain_, RGAccess::ColorAttachment,
+                     context_->present_layout());
+    } else {
+        rg_normal_ = graph_.import_image("gbuffer_normal", gbuffer_.normal().image,
+                                         VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+        rg_albedo_ = graph_.import_image("gbuffer_albedo", gbuffer_.albedo().image,
+                                         VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+        rg_depth_ = graph_.import_image("gbuffer_depth", gbuffer_.depth().image,
+                                        VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+
+        uint32_t geometry_pass = graph_.add_pass("geometry", [this](VkCommandBuffer cmd) {
+            begin_geometry_pass(cmd);
+            record_geometry(cmd);
+            end_geometry_pass(cmd);
+        });
+        graph_.write(geometry_pass, rg_normal_, RGAccess::ColorAttachment,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        graph_.write(geometry_pass, rg_albedo_, RGAccess::ColorAttachment,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        graph_.write(geometry_pass, rg_depth_, RGAccess::DepthAttachment,
+                     VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+
+        uint32_t lighting_pass = graph_.add_pass("lighting", [this](VkCommandBuffer cmd) {
+            if (upscaling_) {
+                begin_lighting_pass(cmd, scene_framebuffer_, scene_render_pass_,
+                                    render_width_, render_height_);
+            } else {
+                VkExtent2D extent = context_->swapchain_extent();
+                begin_lighting_pass(cmd, context_->current_framebuffer(), context_->render_pass(),
+                                    extent.width, extent.height);
+            }
+            render_lighting(cmd, frame_->camera_pos, frame_->near_plane, frame_->far_plane);
+            end_lighting_pass(cmd);
+        });
+        graph_.read(lighting_pass, rg_normal_, RGAccess::ShaderRead);
+        graph_.read(lighting_pass, rg_albedo_, RGAccess::ShaderRead);
+        graph_.read(lighting_pass, rg_depth_, RGAccess::DepthShaderRead);
+        graph_.read(lighting_pass, rg_shadows_, RGAccess::ShaderRead);
+
+        if (upscaling_) {
+            // Full-size target like the G-buffer; lighting fills its top-left region
+            RGImageDesc scene_desc;
+            scene_desc.format = context_->swapchain_format();
+            scene_desc.width = width_;
+            scene_desc.height = height_;
+            scene_desc.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+            rg_scene_ = graph_.create_image("scene_color", scene_desc);
+
+            graph_.write(lighting_pass, rg_scene_, RGAccess::ColorAttachment,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+            if (temporal_) {
+                // History images swap roles each frame (set in render_frame);
+                // both rest in SHADER_READ_ONLY between frames
+                rg_history_read_ = graph_.import_image("history_read", temporal_upscaler_.history_read(),
+                                                       VK_IMAGE_ASPECT_COLOR_BIT,
+                                                       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+                rg_history_write_ = graph_.import_image("history_write", temporal_upscaler_.history_write(),
+                                                        VK_IMAGE_ASPECT_COLOR_BIT,
+                                                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+                uint32_t temporal_pass = graph_.add_pass("temporal", [this](VkCommandBuffer cmd) {
+                    temporal_upscaler_.resolve(cmd, render_width_, render_height_);
+                });
+                graph_.read(temporal_pass, rg_scene_, RGAccess::ShaderRead);
+                graph_.read(temporal_pass, rg_depth_, RGAccess::DepthShaderRead);
+                graph_.read(temporal_pass, rg_history_read_, RGAccess::ShaderRead);
+                graph_.write(temporal_pass, rg_history_write_, RGAccess::ColorAttachment,
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+                graph_.write(temporal_pass, rg_swapchain_, RGAccess::ColorAttachment,
+                             context_->present_layout());
+            } else {
+                uint32_t upscale_pass = graph_.add_pass("upscale", [this](VkCommandBuffer cmd) {
+                    upscale(cmd);
+                });
+                graph_.read(upscale_pass, rg_scene_, RGAccess::ShaderRead);
+                graph_.write(upscale_pass, rg_swapchain_, RGAccess::ColorAttachment,
+                             context_->present_layout());
+            }
+        } else {
+            graph_.write(lighting_pass, rg_swapchain_, RGAccess::ColorAttachment,
+                         context_->present_layout());
+        }
+    }
+
+    if (!graph_.compile()) {
+        return false;
+    }
+
+    return !upscaling_ || update_scene_target();
+}
+
+bool DeferredPipeline::update_scene_target() {
+    VkImageView scene_view = graph_.image_view(rg_scene_);
+
+    VkFramebufferCreateInfo framebuffer_info{};
+    framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebuffer_info.renderPass = scene_render_pass_;
+    framebuffer_info.attachmentCount = 1;
+    framebuffer_info.pAttachments = &scene_view;
+    framebuffer_info.width = width_;
+    framebuffer_info.height = height_;
+    framebuffer_info.layers = 1;
+
+    if (vkCreateFramebuffer(context_->device(), &framebuffer_info, nullptr,
+            &scene_framebuffer_) != VK_SUCCESS) {
+        fprintf(stderr, "Failed to create scene framebuffer\n");
+        return false;
+    }
+
+    VkDescriptorImageInfo image_info{};
+    image_info.sampler = upscale_sampler_;
+    image_info.imageView = scene_view;
+    image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = upscale_descriptor_set_;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &image_info;
+
+    vkUpdateDescriptorSets(context_->device(), 1, &write, 0, nullptr);
+
+    if (temporal_) {
+        temporal_upscaler_.set_sources(scene_view, gbuffer_.depth_descriptor());
+    }
+    return true;
+}
+
+void DeferredPipeline::render_frame(VkCommandBuffer cmd, const DeferredFrame& frame) {
+    // Subpass mode renders into the swapchain image, so follow its extent
+    if (config_.subpass_lighting && !sync_swapchain()) {
+        fprintf(stderr, "Failed to resize G-buffer for new swapchain\n");
+        return;
+    }
+
+    // Timings read back this frame are a few frames old; the controller
+    // waits for them to settle after each change
+    if (config_.dynamic_resolution && upscaling_ &&
+        resolution_.update(context_->profiler().last_frame_ms())) {
+        set_render_scale(resolution_.scale());
+    }
+
+    graph_.set_imported_image(rg_swapchain_, context_->current_swapchain_image());
+    if (temporal_) {
+        graph_.set_imported_image(rg_history_read_, temporal_upscaler_.history_read());
+        graph_.set_imported_image(rg_history_write_, temporal_upscaler_.history_write());
+    }
+
+    frame_ = &frame;
+    graph_.execute(cmd);
+    frame_ = nullptr;
 }
 
 bool DeferredPipeline::create_descriptor_sets() {
     // Lighting pass descriptors
-    // Bindings: 0=position, 1=normal, 2=albedo, 3=material, 4=depth
-    //           5=lights, 6=uniforms, 7=clusters, 8=light_indices, 9=shadow_maps
-    std::array<VkDescriptorSetLayoutBinding, 10> bindings{};
+    // Bindings: 0=normal/material, 1=albedo, 2=depth
+    //           3=lights, 4=uniforms, 5=clusters, 6=light_indices, 7=shadow_maps
+    std::array<VkDescriptorSetLayoutBinding, 8> bindings{};
+
+    VkDescriptorType gbuffer_type = config_.subpass_lighting
+        ? VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT
+        : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 
     // G-buffer textures
-    for (int i = 0; i < 5; i++) {
+    for (int i = 0; i < 3; i++) {
         bindings[i].binding = i;
-        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[i].descriptorType = gbuffer_type;
         bindings[i].descriptorCount = 1;
         bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
     }
 
     // Light buffer
+    bindings[3].binding = 3;
+    bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[3].descriptorCount = 1;
+    bindings[3].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // Light uniforms
+    bindings[4].binding = 4;
+    bindings[4].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    bindings[4].descriptorCount = 1;
+    bindings[4].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // Cluster buffer
     bindings[5].binding = 5;
     bindings[5].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
     bindings[5].descriptorCount = 1;
     bindings[5].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-    // Light uniforms
+    // Light index buffer
     bindings[6].binding = 6;
-    bindings[6].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    bindings[6].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
     bindings[6].descriptorCount = 1;
     bindings[6].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-    // Cluster buffer
+    // Shadow maps
     bindings[7].binding = 7;
-    bindings[7].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[7].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     bindings[7].descriptorCount = 1;
     bindings[7].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-    // Light index buffer
-    bindings[8].binding = 8;
-    bindings[8].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    bindings[8].descriptorCount = 1;
-    bindings[8].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-    // Shadow maps
-    bindings[9].binding = 9;
-    bindings[9].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    bindings[9].descriptorCount = 1;
-    bindings[9].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
     VkDescriptorSetLayoutCreateInfo layout_info{};
     layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
@@ -216,13 +579,15 @@ bool DeferredPipeline::create_descriptor_sets() {
     }
 
     // Create descriptor pool
-    std::array<VkDescriptorPoolSize, 3> pool_sizes{};
+    std::array<VkDescriptorPoolSize, 4> pool_sizes{};
     pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    pool_sizes[0].descriptorCount = 6;  // 5 G-buffer + 1 shadow
+    pool_sizes[0].descriptorCount = 4;  // 3 G-buffer + 1 shadow
     pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
     pool_sizes[1].descriptorCount = 3;  // lights, clusters, indices
     pool_sizes[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     pool_sizes[2].descriptorCount = 1;
+    pool_sizes[3].type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+    pool_sizes[3].descriptorCount = 3;  // G-buffer in subpass mode
 
     VkDescriptorPoolCreateInfo pool_info{};
     pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -247,27 +612,25 @@ bool DeferredPipeline::create_descriptor_sets() {
 }
 
 bool DeferredPipeline::update_descriptor_sets() {
-    std::array<VkWriteDescriptorSet, 10> writes{};
+    std::array<VkWriteDescriptorSet, 8> writes{};
 
     // G-buffer textures
-    VkDescriptorImageInfo position_info = gbuffer_.position_descriptor();
     VkDescriptorImageInfo normal_info = gbuffer_.normal_descriptor();
     VkDescriptorImageInfo albedo_info = gbuffer_.albedo_descriptor();
-    VkDescriptorImageInfo material_info = gbuffer_.material_descriptor();
     VkDescriptorImageInfo depth_info = gbuffer_.depth_descriptor();
 
-    for (int i = 0; i < 5; i++) {
+    for (int i = 0; i < 3; i++) {
         writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         writes[i].dstSet = lighting_descriptor_set_;
         writes[i].dstBinding = i;
         writes[i].descriptorCount = 1;
-        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[i].descriptorType = config_.subpass_lighting
+            ? VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT
+            : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     }
-    writes[0].pImageInfo = &position_info;
-    writes[1].pImageInfo = &normal_info;
-    writes[2].pImageInfo = &albedo_info;
-    writes[3].pImageInfo = &material_info;
-    writes[4].pImageInfo = &depth_info;
+    writes[0].pImageInfo = &normal_info;
+    writes[1].pImageInfo = &albedo_info;
+    writes[2].pImageInfo = &depth_info;
 
     // Light buffers
     VkDescriptorBufferInfo light_info = lights_.light_buffer_info();
@@ -275,42 +638,42 @@ bool DeferredPipeline::update_descriptor_sets() {
     VkDescriptorBufferInfo cluster_info = lights_.cluster_buffer_info();
     VkDescriptorBufferInfo index_info = lights_.light_index_buffer_info();
 
+    writes[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[3].dstSet = lighting_descriptor_set_;
+    writes[3].dstBinding = 3;
+    writes[3].descriptorCount = 1;
+    writes[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[3].pBufferInfo = &light_info;
+
+    writes[4].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[4].dstSet = lighting_descriptor_set_;
+    writes[4].dstBinding = 4;
+    writes[4].descriptorCount = 1;
+    writes[4].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    writes[4].pBufferInfo = &uniform_info;
+
     writes[5].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     writes[5].dstSet = lighting_descriptor_set_;
     writes[5].dstBinding = 5;
     writes[5].descriptorCount = 1;
     writes[5].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    writes[5].pBufferInfo = &light_info;
+    writes[5].pBufferInfo = &cluster_info;
 
     writes[6].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     writes[6].dstSet = lighting_descriptor_set_;
     writes[6].dstBinding = 6;
     writes[6].descriptorCount = 1;
-    writes[6].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    writes[6].pBufferInfo = &uniform_info;
+    writes[6].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[6].pBufferInfo = &index_info;
 
+    // Shadow maps
+    VkDescriptorImageInfo shadow_info = shadows_.descriptor_info();
     writes[7].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     writes[7].dstSet = lighting_descriptor_set_;
     writes[7].dstBinding = 7;
     writes[7].descriptorCount = 1;
-    writes[7].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    writes[7].pBufferInfo = &cluster_info;
-
-    writes[8].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writes[8].dstSet = lighting_descriptor_set_;
-    writes[8].dstBinding = 8;
-    writes[8].descriptorCount = 1;
-    writes[8].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    writes[8].pBufferInfo = &index_info;
-
-    // Shadow maps
-    VkDescriptorImageInfo shadow_info = shadows_.descriptor_info();
-    writes[9].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writes[9].dstSet = lighting_descriptor_set_;
-    writes[9].dstBinding = 9;
-    writes[9].descriptorCount = 1;
-    writes[9].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    writes[9].pImageInfo = &shadow_info;
+    writes[7].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[7].pImageInfo = &shadow_info;
 
     vkUpdateDescriptorSets(context_->device(), static_cast<uint32_t>(writes.size()),
                           writes.data(), 0, nullptr);
@@ -321,15 +684,19 @@ bool DeferredPipeline::update_descriptor_sets() {
 bool DeferredPipeline::create_geometry_pipeline() {
     // Load shaders
     auto vert_code = context_->load_shader("shaders/gbuffer.vert.spv");
-    auto frag_code = context_->load_shader("shaders/gbuffer.frag.spv");
+    // Without dynamic texture indexing, each material's maps sit in fixed slots
+    auto frag_code = context_->load_shader(materials_.bound_per_material()
+        ? "shaders/gbuffer_bound.frag.spv" : "shaders/gbuffer.frag.spv");
+    auto prepass_code = context_->load_shader("shaders/depth_prepass.vert.spv");
 
-    if (vert_code.empty() || frag_code.empty()) {
+    if (vert_code.empty() || frag_code.empty() || prepass_code.empty()) {
         fprintf(stderr, "Failed to load G-buffer shaders\n");
         return false;
     }
 
     VkShaderModule vert_module = context_->create_shader_module(vert_code);
     VkShaderModule frag_module = context_->create_shader_module(frag_code);
+    VkShaderModule prepass_module = context_->create_shader_module(prepass_code);
 
     VkPipelineShaderStageCreateInfo shader_stages[2]{};
     shader_stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -342,22 +709,35 @@ bool DeferredPipeline::create_geometry_pipeline() {
     shader_stages[1].module = frag_module;
     shader_stages[1].pName = "main";
 
-    // Vertex input
-    VkVertexInputBindingDescription binding{};
-    binding.binding = 0;
-    binding.stride = sizeof(Vertex);
-    binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-    std::array<VkVertexInputAttributeDescription, 4> attributes{};
-    attributes[0] = {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position)};
-    attributes[1] = {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, color)};
-    attributes[2] = {2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal)};
-    attributes[3] = {3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, uv)};
+    // Texture array size (gbuffer.frag constant 0; gbuffer_bound.frag has none)
+    uint32_t texture_capacity = materials_.texture_capacity();
+    VkSpecializationMapEntry texture_spec_entry{0, 0, sizeof(uint32_t)};
+    VkSpecializationInfo texture_spec{};
+    texture_spec.mapEntryCount = 1;
+    texture_spec.pMapEntries = &texture_spec_entry;
+    texture_spec.dataSize = sizeof(uint32_t);
+    texture_spec.pData = &texture_capacity;
+    shader_stages[1].pSpecializationInfo = &texture_spec;
+
+    // Vertex input: mesh vertices plus per-instance model transforms
+    std::array<VkVertexInputBindingDescription, 2> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].stride = sizeof(Vertex);
+    bindings[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    bindings[1] = InstanceBuffer::binding_description();
+
+    std::vector<VkVertexInputAttributeDescription> attributes = {
+        {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position)},
+        {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, color)},
+        {2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal)},
+        {3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, uv)},
+    };
+    InstanceBuffer::attribute_descriptions(4, attributes);
 
     VkPipelineVertexInputStateCreateInfo vertex_input{};
     vertex_input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertex_input.vertexBindingDescriptionCount = 1;
-    vertex_input.pVertexBindingDescriptions = &binding;
+    vertex_input.vertexBindingDescriptionCount = static_cast<uint32_t>(bindings.size());
+    vertex_input.pVertexBindingDescriptions = bindings.data();
     vertex_input.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributes.size());
     vertex_input.pVertexAttributeDescriptions = attributes.data();
 
@@ -387,8 +767,8 @@ bool DeferredPipeline::create_geometry_pipeline() {
     depth_stencil.depthWriteEnable = VK_TRUE;
     depth_stencil.depthCompareOp = VK_COMPARE_OP_LESS;
 
-    // 4 color attachments for G-buffer
-    std::array<VkPipelineColorBlendAttachmentState, 4> blend_attachments{};
+    // 2 color attachments for G-buffer
+    std::array<VkPipelineColorBlendAttachmentState, 2> blend_attachments{};
     for (auto& att : blend_attachments) {
         att.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
                             VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
@@ -410,14 +790,22 @@ bool DeferredPipeline::create_geometry_pipeline() {
     dynamic_state.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
     dynamic_state.pDynamicStates = dynamic_states.data();
 
-    // Push constants
+    // Push constants (the fragment stage reads the material index)
     VkPushConstantRange push_range{};
-    push_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    push_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
     push_range.offset = 0;
     push_range.size = sizeof(GeometryPushConstants);
 
+    // Set 0: material textures and table, set 1: frame uniforms
+    std::array<VkDescriptorSetLayout, 2> set_layouts = {
+        materials_.descriptor_layout(),
+        frame_uniforms_.descriptor_layout()
+    };
+
     VkPipelineLayoutCreateInfo layout_info{};
     layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layout_info.setLayoutCount = static_cast<uint32_t>(set_layouts.size());
+    layout_info.pSetLayouts = set_layouts.data();
     layout_info.pushConstantRangeCount = 1;
     layout_info.pPushConstantRanges = &push_range;
 
@@ -425,6 +813,7 @@ bool DeferredPipeline::create_geometry_pipeline() {
             &geometry_layout_) != VK_SUCCESS) {
         vkDestroyShaderModule(context_->device(), vert_module, nullptr);
         vkDestroyShaderModule(context_->device(), frag_module, nullptr);
+        vkDestroyShaderModule(context_->device(), prepass_module, nullptr);
         return false;
     }
 
@@ -447,20 +836,105 @@ bool DeferredPipeline::create_geometry_pipeline() {
     VkResult result = vkCreateGraphicsPipelines(context_->device(), VK_NULL_HANDLE,
         1, &pipeline_info, nullptr, &geometry_pipeline_);
 
+    // After a depth pre-pass the depth buffer is final: shade only the
+    // fragments that won it, without writing depth again
+    if (result == VK_SUCCESS) {
+        depth_stencil.depthWriteEnable = VK_FALSE;
+        depth_stencil.depthCompareOp = VK_COMPARE_OP_EQUAL;
+        result = vkCreateGraphicsPipelines(context_->device(), VK_NULL_HANDLE,
+            1, &pipeline_info, nullptr, &geometry_equal_pipeline_);
+    }
+
+    // Depth pre-pass: same layout and raster state, positions only, no
+    // fragment shader or color writes
+    if (result == VK_SUCCESS) {
+        VkPipelineShaderStageCreateInfo prepass_stage = shader_stages[0];
+        prepass_stage.module = prepass_module;
+
+        std::vector<VkVertexInputAttributeDescription> prepass_attributes = {
+            {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position)},
+        };
+        InstanceBuffer::attribute_descriptions(1, prepass_attributes);
+        vertex_input.vertexAttributeDescriptionCount = static_cast<uint32_t>(prepass_attributes.size());
+        vertex_input.pVertexAttributeDescriptions = prepass_attributes.data();
+
+        for (auto& att : blend_attachments) {
+            att.colorWriteMask = 0;
+        }
+
+        depth_stencil.depthWriteEnable = VK_TRUE;
+        depth_stencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
+        pipeline_info.stageCount = 1;
+        pipeline_info.pStages = &prepass_stage;
+        result = vkCreateGraphicsPipelines(context_->device(), VK_NULL_HANDLE,
+            1, &pipeline_info, nullptr, &depth_prepass_pipeline_);
+    }
+
     vkDestroyShaderModule(context_->device(), vert_module, nullptr);
     vkDestroyShaderModule(context_->device(), frag_module, nullptr);
+    vkDestroyShaderModule(context_->device(), prepass_module, nullptr);
 
     return result == VK_SUCCESS;
 }
 
 bool DeferredPipeline::create_lighting_pipeline() {
+    // Push constants
+    VkPushConstantRange push_range{};
+    push_range.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    push_range.offset = 0;
+    push_range.size = sizeof(LightingPushConstants);
+
+    VkPipelineLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layout_info.setLayoutCount = 1;
+    layout_info.pSetLayouts = &lighting_descriptor_layout_;
+    layout_info.pushConstantRangeCount = 1;
+    layout_info.pPushConstantRanges = &push_range;
+
+    if (vkCreatePipelineLayout(context_->device(), &layout_info, nullptr,
+            &lighting_layout_) != VK_SUCCESS) {
+        return false;
+    }
+
+    // Build the startup variant now so a broken shader fails init
+    return lighting_pipeline() != VK_NULL_HANDLE;
+}
+
+VkPipeline DeferredPipeline::lighting_pipeline() {
+    LightingSpecialization spec;
+    spec.max_shadow_lights = shadows_.max_lights();
+    spec.shadows = shadows_enabled_ ? VK_TRUE : VK_FALSE;
+
+    for (const auto& variant : lighting_variants_) {
+        if (variant.first == spec) {
+            return variant.second;
+        }
+    }
+
+    VkPipeline pipeline = create_lighting_variant(spec);
+    if (pipeline == VK_NULL_HANDLE) {
+        fprintf(stderr, "Failed to create lighting pipeline variant\n");
+        return VK_NULL_HANDLE;
+    }
+
+    printf("    Lighting variant %zu: %ux%ux%u clusters, %u lights/cluster, shadows %s\n",
+        lighting_variants_.size(), spec.cluster_x, spec.cluster_y, spec.cluster_z,
+        spec.max_lights_per_cluster, spec.shadows ? "on" : "off");
+    lighting_variants_.emplace_back(spec, pipeline);
+    return pipeline;
+}
+
+VkPipeline DeferredPipeline::create_lighting_variant(const LightingSpecialization& spec) {
     // Load shaders
     auto vert_code = context_->load_shader("shaders/lighting.vert.spv");
-    auto frag_code = context_->load_shader("shaders/lighting.frag.spv");
+    auto frag_code = context_->load_shader(config_.subpass_lighting
+        ? "shaders/lighting_subpass.frag.spv"
+        : "shaders/lighting.frag.spv");
 
     if (vert_code.empty() || frag_code.empty()) {
         fprintf(stderr, "Failed to load lighting shaders\n");
-        return false;
+        return VK_NULL_HANDLE;
     }
 
     VkShaderModule vert_module = context_->create_shader_module(vert_code);
@@ -477,6 +951,22 @@ bool DeferredPipeline::create_lighting_pipeline() {
     shader_stages[1].module = frag_module;
     shader_stages[1].pName = "main";
 
+    std::array<VkSpecializationMapEntry, 6> spec_entries = {{
+        {0, offsetof(LightingSpecialization, cluster_x), sizeof(uint32_t)},
+        {1, offsetof(LightingSpecialization, cluster_y), sizeof(uint32_t)},
+        {2, offsetof(LightingSpecialization, cluster_z), sizeof(uint32_t)},
+        {3, offsetof(LightingSpecialization, max_lights_per_cluster), sizeof(uint32_t)},
+        {4, offsetof(LightingSpecialization, max_shadow_lights), sizeof(uint32_t)},
+        {5, offsetof(LightingSpecialization, shadows), sizeof(VkBool32)},
+    }};
+
+    VkSpecializationInfo spec_info{};
+    spec_info.mapEntryCount = static_cast<uint32_t>(spec_entries.size());
+    spec_info.pMapEntries = spec_entries.data();
+    spec_info.dataSize = sizeof(LightingSpecialization);
+    spec_info.pData = &spec;
+    shader_stages[1].pSpecializationInfo = &spec_info;
+
     // Vertex input for full-screen quad
     VkVertexInputBindingDescription binding{};
     binding.binding = 0;
@@ -539,26 +1029,6 @@ bool DeferredPipeline::create_lighting_pipeline() {
     dynamic_state.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
     dynamic_state.pDynamicStates = dynamic_states.data();
 
-    // Push constants
-    VkPushConstantRange push_range{};
-    push_range.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-    push_range.offset = 0;
-    push_range.size = sizeof(LightingPushConstants);
-
-    VkPipelineLayoutCreateInfo layout_info{};
-    layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    layout_info.setLayoutCount = 1;
-    layout_info.pSetLayouts = &lighting_descriptor_layout_;
-    layout_info.pushConstantRangeCount = 1;
-    layout_info.pPushConstantRanges = &push_range;
-
-    if (vkCreatePipelineLayout(context_->device(), &layout_info, nullptr,
-            &lighting_layout_) != VK_SUCCESS) {
-        vkDestroyShaderModule(context_->device(), vert_module, nullptr);
-        vkDestroyShaderModule(context_->device(), frag_module, nullptr);
-        return false;
-    }
-
     VkGraphicsPipelineCreateInfo pipeline_info{};
     pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipeline_info.stageCount = 2;
@@ -572,16 +1042,22 @@ bool DeferredPipeline::create_lighting_pipeline() {
     pipeline_info.pColorBlendState = &color_blend;
     pipeline_info.pDynamicState = &dynamic_state;
     pipeline_info.layout = lighting_layout_;
-    pipeline_info.renderPass = context_->render_pass();
-    pipeline_info.subpass = 0;
+    if (config_.subpass_lighting) {
+        pipeline_info.renderPass = gbuffer_.render_pass();
+        pipeline_info.subpass = 1;
+    } else {
+        pipeline_info.renderPass = context_->render_pass();
+        pipeline_info.subpass = 0;
+    }
 
+    VkPipeline pipeline = VK_NULL_HANDLE;
     VkResult result = vkCreateGraphicsPipelines(context_->device(), VK_NULL_HANDLE,
-        1, &pipeline_info, nullptr, &lighting_pipeline_);
+        1, &pipeline_info, nullptr, &pipeline);
 
     vkDestroyShaderModule(context_->device(), vert_module, nullptr);
     vkDestroyShaderModule(context_->device(), frag_module, nullptr);
 
-    return result == VK_SUCCESS;
+    return result == VK_SUCCESS ? pipeline : VK_NULL_HANDLE;
 }
 
 bool DeferredPipeline::create_shadow_pipeline() {
@@ -601,24 +1077,24 @@ bool DeferredPipeline::create_shadow_pipeline() {
     shader_stage.module = vert_module;
     shader_stage.pName = "main";
 
-    // Vertex input
-    VkVertexInputBindingDescription binding{};
-    binding.binding = 0;
-    binding.stride = sizeof(Vertex);
-    binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    // Vertex input: positions plus per-instance model transforms
+    std::array<VkVertexInputBindingDescription, 2> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].stride = sizeof(Vertex);
+    bindings[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    bindings[1] = InstanceBuffer::binding_description();
 
-    VkVertexInputAttributeDescription attribute{};
-    attribute.binding = 0;
-    attribute.location = 0;
-    attribute.format = VK_FORMAT_R32G32B32_SFLOAT;
-    attribute.offset = offsetof(Vertex, position);
+    std::vector<VkVertexInputAttributeDescription> attributes = {
+        {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position)},
+    };
+    InstanceBuffer::attribute_descriptions(1, attributes);
 
     VkPipelineVertexInputStateCreateInfo vertex_input{};
     vertex_input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertex_input.vertexBindingDescriptionCount = 1;
-    vertex_input.pVertexBindingDescriptions = &binding;
-    vertex_input.vertexAttributeDescriptionCount = 1;
-    vertex_input.pVertexAttributeDescriptions = &attribute;
+    vertex_input.vertexBindingDescriptionCount = static_cast<uint32_t>(bindings.size());
+    vertex_input.pVertexBindingDescriptions = bindings.data();
+    vertex_input.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributes.size());
+    vertex_input.pVertexAttributeDescriptions = attributes.data();
 
     VkPipelineInputAssemblyStateCreateInfo input_assembly{};
     input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -704,74 +1180,427 @@ bool DeferredPipeline::create_shadow_pipeline() {
     return result == VK_SUCCESS;
 }
 
+bool DeferredPipeline::create_scene_render_pass() {
+    // Same format as the swapchain pass, so the lighting pipeline is
+    // compatible with both targets
+    VkAttachmentDescription color_attachment{};
+    color_attachment.format = context_->swapchain_format();
+    color_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;  // Full-screen quad covers the render area
+    color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    color_attachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkAttachmentReference color_ref{};
+    color_ref.attachment = 0;
+    color_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &color_ref;
+
+    // Previous frame's upscale may still be sampling the image
+    VkSubpassDependency dependency{};
+    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependency.dstSubpass = 0;
+    dependency.srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                              VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.srcAccessMask = 0;
+    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    VkRenderPassCreateInfo render_pass_info{};
+    render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    render_pass_info.attachmentCount = 1;
+    render_pass_info.pAttachments = &color_attachment;
+    render_pass_info.subpassCount = 1;
+    render_pass_info.pSubpasses = &subpass;
+    render_pass_info.dependencyCount = 1;
+    render_pass_info.pDependencies = &dependency;
+
+    return vkCreateRenderPass(context_->device(), &render_pass_info, nullptr,
+            &scene_render_pass_) == VK_SUCCESS;
+}
+
+bool DeferredPipeline::create_upscale_pipeline() {
+    // Bilinear sampler for the scaled scene
+    VkSamplerCreateInfo sampler_info{};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = VK_FILTER_LINEAR;
+    sampler_info.minFilter = VK_FILTER_LINEAR;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.maxAnisotropy = 1.0f;
+    sampler_info.minLod = 0.0f;
+    sampler_info.maxLod = 0.0f;
+
+    if (vkCreateSampler(context_->device(), &sampler_info, nullptr, &upscale_sampler_) != VK_SUCCESS) {
+        return false;
+    }
+
+    // Descriptor: binding 0 = scene color
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo descriptor_layout_info{};
+    descriptor_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    descriptor_layout_info.bindingCount = 1;
+    descriptor_layout_info.pBindings = &binding;
+
+    if (vkCreateDescriptorSetLayout(context_->device(), &descriptor_layout_info, nullptr,
+            &upscale_descriptor_layout_) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkDescriptorPoolSize pool_size{};
+    pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    pool_size.descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.poolSizeCount = 1;
+    pool_info.pPoolSizes = &pool_size;
+    pool_info.maxSets = 1;
+
+    if (vkCreateDescriptorPool(context_->device(), &pool_info, nullptr,
+            &upscale_descriptor_pool_) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = upscale_descriptor_pool_;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = &upscale_descriptor_layout_;
+
+    if (vkAllocateDescriptorSets(context_->device(), &alloc_info,
+            &upscale_descriptor_set_) != VK_SUCCESS) {
+        return false;
+    }
+
+    // Shaders: the lighting pass's full-screen quad vertex shader
+    auto vert_code = context_->load_shader("shaders/lighting.vert.spv");
+    auto frag_code = context_->load_shader("shaders/upscale.frag.spv");
+
+    if (vert_code.empty() || frag_code.empty()) {
+        fprintf(stderr, "Failed to load upscale shaders\n");
+        return false;
+    }
+
+    VkShaderModule vert_module = context_->create_shader_module(vert_code);
+    VkShaderModule frag_module = context_->create_shader_module(frag_code);
+
+    VkPipelineShaderStageCreateInfo shader_stages[2]{};
+    shader_stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shader_stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shader_stages[0].module = vert_module;
+    shader_stages[0].pName = "main";
+
+    shader_stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shader_stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shader_stages[1].module = frag_module;
+    shader_stages[1].pName = "main";
+
+    VkVertexInputBindingDescription vertex_binding{};
+    vertex_binding.binding = 0;
+    vertex_binding.stride = sizeof(float) * 4;  // pos.xy, uv.xy
+    vertex_binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    std::array<VkVertexInputAttributeDescription, 2> attributes{};
+    attributes[0] = {0, 0, VK_FORMAT_R32G32_SFLOAT, 0};
+    attributes[1] = {1, 0, VK_FORMAT_R32G32_SFLOAT, sizeof(float) * 2};
+
+    VkPipelineVertexInputStateCreateInfo vertex_input{};
+    vertex_input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertex_input.vertexBindingDescriptionCount = 1;
+    vertex_input.pVertexBindingDescriptions = &vertex_binding;
+    vertex_input.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributes.size());
+    vertex_input.pVertexAttributeDescriptions = attributes.data();
+
+    VkPipelineInputAssemblyStateCreateInfo input_assembly{};
+    input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo viewport_state{};
+    viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewport_state.viewportCount = 1;
+    viewport_state.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depth_stencil{};
+    depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depth_stencil.depthTestEnable = VK_FALSE;
+    depth_stencil.depthWriteEnable = VK_FALSE;
+
+    VkPipelineColorBlendAttachmentState blend_attachment{};
+    blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                      VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    blend_attachment.blendEnable = VK_FALSE;
+
+    VkPipelineColorBlendStateCreateInfo color_blend{};
+    color_blend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    color_blend.attachmentCount = 1;
+    color_blend.pAttachments = &blend_attachment;
+
+    std::array<VkDynamicState, 2> dynamic_states = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamic_state{};
+    dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic_state.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
+    dynamic_state.pDynamicStates = dynamic_states.data();
+
+    VkPushConstantRange push_range{};
+    push_range.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    push_range.offset = 0;
+    push_range.size = sizeof(UpscalePushConstants);
+
+    VkPipelineLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layout_info.setLayoutCount = 1;
+    layout_info.pSetLayouts = &upscale_descriptor_layout_;
+    layout_info.pushConstantRangeCount = 1;
+    layout_info.pPushConstantRanges = &push_range;
+
+    if (vkCreatePipelineLayout(context_->device(), &layout_info, nullptr,
+            &upscale_layout_) != VK_SUCCESS) {
+        vkDestroyShaderModule(context_->device(), vert_module, nullptr);
+        vkDestroyShaderModule(context_->device(), frag_module, nullptr);
+        return false;
+    }
+
+    VkGraphicsPipelineCreateInfo pipeline_info{};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipeline_info.stageCount = 2;
+    pipeline_info.pStages = shader_stages;
+    pipeline_info.pVertexInputState = &vertex_input;
+    pipeline_info.pInputAssemblyState = &input_assembly;
+    pipeline_info.pViewportState = &viewport_state;
+    pipeline_info.pRasterizationState = &rasterizer;
+    pipeline_info.pMultisampleState = &multisampling;
+    pipeline_info.pDepthStencilState = &depth_stencil;
+    pipeline_info.pColorBlendState = &color_blend;
+    pipeline_info.pDynamicState = &dynamic_state;
+    pipeline_info.layout = upscale_layout_;
+    pipeline_info.renderPass = context_->render_pass();
+    pipeline_info.subpass = 0;
+
+    VkResult result = vkCreateGraphicsPipelines(context_->device(), VK_NULL_HANDLE,
+        1, &pipeline_info, nullptr, &upscale_pipeline_);
+
+    vkDestroyShaderModule(context_->device(), vert_module, nullptr);
+    vkDestroyShaderModule(context_->device(), frag_module, nullptr);
+
+    return result == VK_SUCCESS;
+}
+
 void DeferredPipeline::set_view_projection(const mat4& view, const mat4& proj) {
     view_matrix_ = view;
-    proj_matrix_ = proj;
+    // Geometry and lighting both see the jittered projection, so depth and
+    // reconstructed positions agree
+    proj_matrix_ = temporal_
+        ? temporal_upscaler_.jitter_projection(view, proj, render_width_, render_height_)
+        : proj;
+    frame_uniforms_.update(view, proj_matrix_);
 }
 
 void DeferredPipeline::begin_geometry_pass(VkCommandBuffer cmd) {
-    std::array<VkClearValue, 5> clear_values{};
-    clear_values[0].color = {{0.0f, 0.0f, 0.0f, 0.0f}};  // Position
-    clear_values[1].color = {{0.0f, 0.0f, 0.0f, 0.0f}};  // Normal
-    clear_values[2].color = {{0.0f, 0.0f, 0.0f, 0.0f}};  // Albedo
-    clear_values[3].color = {{0.5f, 0.0f, 0.0f, 0.0f}};  // Material
-    clear_values[4].depthStencil = {1.0f, 0};
+    // Pick up textures that finished streaming since this frame slot was
+    // last used (its previous submission has completed)
+    materials_.prepare();
 
     VkRenderPassBeginInfo begin_info{};
     begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     begin_info.renderPass = gbuffer_.render_pass();
-    begin_info.framebuffer = gbuffer_.framebuffer();
     begin_info.renderArea.offset = {0, 0};
-    begin_info.renderArea.extent = {gbuffer_.width(), gbuffer_.height()};
-    begin_info.clearValueCount = static_cast<uint32_t>(clear_values.size());
+
+    std::array<VkClearValue, 4> clear_values{};
+    if (config_.subpass_lighting) {
+        // Attachment 0 is the swapchain image (not cleared)
+        clear_values[1].color = {{0.0f, 0.0f, 0.5f, 0.0f}};  // Normal + material
+        clear_values[2].color = {{0.0f, 0.0f, 0.0f, 0.0f}};  // Albedo
+        clear_values[3].depthStencil = {1.0f, 0};
+        begin_info.framebuffer = gbuffer_.framebuffer(context_->current_image_index());
+        begin_info.clearValueCount = 4;
+    } else {
+        clear_values[0].color = {{0.0f, 0.0f, 0.5f, 0.0f}};  // Normal + material
+        clear_values[1].color = {{0.0f, 0.0f, 0.0f, 0.0f}};  // Albedo
+        clear_values[2].depthStencil = {1.0f, 0};
+        begin_info.framebuffer = gbuffer_.framebuffer();
+        begin_info.clearValueCount = 3;
+    }
+
+    begin_info.renderArea.extent = {render_width_, render_height_};
     begin_info.pClearValues = clear_values.data();
 
     vkCmdBeginRenderPass(cmd, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
 
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, geometry_pipeline_);
 
+    // One set for every material (draws select theirs by index, or switch
+    // sets when bound per material) and the frame's camera matrices
+    materials_.bind(cmd, geometry_layout_, 0);
+    frame_uniforms_.bind(cmd, geometry_layout_, 1);
+
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
-    viewport.width = static_cast<float>(gbuffer_.width());
-    viewport.height = static_cast<float>(gbuffer_.height());
+    viewport.width = static_cast<float>(render_width_);
+    viewport.height = static_cast<float>(render_height_);
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
     vkCmdSetViewport(cmd, 0, 1, &viewport);
 
     VkRect2D scissor{};
     scissor.offset = {0, 0};
-    scissor.extent = {gbuffer_.width(), gbuffer_.height()};
+    scissor.extent = {render_width_, render_height_};
     vkCmdSetScissor(cmd, 0, 1, &scissor);
 }
 
+void DeferredPipeline::record_geometry(VkCommandBuffer cmd) {
+    if (!frame_->draw_geometry) {
+        return;
+    }
+
+    // Same draws twice: depth only, then G-buffer writes for visible
+    // fragments. Sets stay bound, the pipelines share a layout.
+    if (depth_prepass_) {
+        {
+            GpuScope scope(context_->profiler(), cmd, "depth prepass");
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, depth_prepass_pipeline_);
+            frame_->draw_geometry(cmd);
+        }
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, geometry_equal_pipeline_);
+    }
+
+    frame_->draw_geometry(cmd);
+}
+
 void DeferredPipeline::end_geometry_pass(VkCommandBuffer cmd) {
+    // In subpass mode the render pass continues into the lighting subpass
+    if (config_.subpass_lighting) {
+        return;
+    }
+
     vkCmdEndRenderPass(cmd);
 }
 
-void DeferredPipeline::draw_mesh(VkCommandBuffer cmd, const Mesh& mesh, const mat4& model) {
+void DeferredPipeline::draw_mesh(VkCommandBuffer cmd, const Mesh& mesh, const mat4& model,
+                                 uint32_t material) {
     // Skip meshes with invalid buffers
     if (mesh.vertex_buffer() == VK_NULL_HANDLE || mesh.index_count() == 0) {
         return;
     }
 
+    materials_.bind_material(cmd, geometry_layout_, 0, material);
+
     GeometryPushConstants push{};
     push.model = model;
-    push.view = view_matrix_;
-    push.projection = proj_matrix_;
+    push.material = material;
 
-    vkCmdPushConstants(cmd, geometry_layout_, VK_SHADER_STAGE_VERTEX_BIT,
+    vkCmdPushConstants(cmd, geometry_layout_, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
                        0, sizeof(GeometryPushConstants), &push);
 
-    VkBuffer vertex_buffers[] = {mesh.vertex_buffer()};
-    VkDeviceSize offsets[] = {0};
-    vkCmdBindVertexBuffers(cmd, 0, 1, vertex_buffers, offsets);
+    VkBuffer vertex_buffers[] = {mesh.vertex_buffer(), identity_instance_.buffer()};
+    VkDeviceSize offsets[] = {0, 0};
+    vkCmdBindVertexBuffers(cmd, 0, 2, vertex_buffers, offsets);
     vkCmdBindIndexBuffer(cmd, mesh.index_buffer(), 0, VK_INDEX_TYPE_UINT32);
     vkCmdDrawIndexed(cmd, mesh.index_count(), 1, 0, 0, 0);
 }
 
+bool DeferredPipeline::bind_draw_buffers(VkCommandBuffer cmd, const DrawPacket& packet,
+                                         BoundBuffers& bound, DrawListStats* stats) {
+    const Mesh& mesh = *packet.mesh;
+    if (mesh.vertex_buffer() == VK_NULL_HANDLE || mesh.index_count() == 0) {
+        return false;
+    }
+
+    VkBuffer instances = packet.instance_buffer ? packet.instance_buffer : identity_instance_.buffer();
+    if (&mesh == bound.mesh && instances == bound.instances) {
+        if (stats) stats->binds_skipped++;
+        return true;
+    }
+
+    VkBuffer vertex_buffers[] = {mesh.vertex_buffer(), instances};
+    VkDeviceSize offsets[] = {0, 0};
+    vkCmdBindVertexBuffers(cmd, 0, 2, vertex_buffers, offsets);
+    if (&mesh != bound.mesh) {
+        vkCmdBindIndexBuffer(cmd, mesh.index_buffer(), 0, VK_INDEX_TYPE_UINT32);
+    }
+
+    bound.mesh = &mesh;
+    bound.instances = instances;
+    if (stats) stats->mesh_binds++;
+    return true;
+}
+
+void DeferredPipeline::draw_list(VkCommandBuffer cmd, DrawList& list) {
+    DrawListStats& stats = list.stats();
+    stats = DrawListStats{};
+    BoundBuffers bound;
+
+    for (size_t i = 0; i < list.size(); i++) {
+        const DrawPacket& packet = list.packet(i);
+        if (!bind_draw_buffers(cmd, packet, bound, &stats)) {
+            continue;
+        }
+
+        materials_.bind_material(cmd, geometry_layout_, 0, packet.material);
+
+        GeometryPushConstants push{};
+        push.model = packet.model;
+        push.material = packet.material;
+
+        vkCmdPushConstants(cmd, geometry_layout_, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                           0, sizeof(GeometryPushConstants), &push);
+        vkCmdDrawIndexed(cmd, packet.mesh->index_count(), packet.instance_count, 0, 0, packet.first_instance);
+        stats.draws++;
+        stats.instances += packet.instance_count;
+    }
+}
+
 void DeferredPipeline::begin_lighting_pass(VkCommandBuffer cmd, VkFramebuffer target_framebuffer,
                                           VkRenderPass target_render_pass, uint32_t width, uint32_t height) {
+    if (config_.subpass_lighting) {
+        vkCmdNextSubpass(cmd, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, lighting_pipeline());
+
+        VkViewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = static_cast<float>(width_);
+        viewport.height = static_cast<float>(height_);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(cmd, 0, 1, &viewport);
+
+        VkRect2D scissor{};
+        scissor.offset = {0, 0};
+        scissor.extent = {width_, height_};
+        vkCmdSetScissor(cmd, 0, 1, &scissor);
+        return;
+    }
+
     VkClearValue clear_value{};
     clear_value.color = {{0.0f, 0.0f, 0.0f, 1.0f}};
 
@@ -786,7 +1615,7 @@ void DeferredPipeline::begin_lighting_pass(VkCommandBuffer cmd, VkFramebuffer ta
 
     vkCmdBeginRenderPass(cmd, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
 
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, lighting_pipeline_);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, lighting_pipeline());
 
     VkViewport viewport{};
     viewport.x = 0.0f;
@@ -820,8 +1649,11 @@ void DeferredPipeline::render_lighting(VkCommandBuffer cmd, const vec3& camera_p
     LightingPushConstants push{};
     push.inv_view_proj = inv_view_proj;
     push.camera_pos = vec4(camera_pos.x, camera_pos.y, camera_pos.z, 0.0f);
-    push.screen_size = vec4(static_cast<float>(width_), static_cast<float>(height_),
+    push.screen_size = vec4(static_cast<float>(render_width_), static_cast<float>(render_height_),
                            near_plane, far_plane);
+    push.gbuffer_scale = vec4(static_cast<float>(render_width_) / static_cast<float>(gbuffer_.width()),
+                              static_cast<float>(render_height_) / static_cast<float>(gbuffer_.height()),
+                              0.0f, 0.0f);
 
     vkCmdPushConstants(cmd, lighting_layout_, VK_SHADER_STAGE_FRAGMENT_BIT,
                        0, sizeof(LightingPushConstants), &push);
@@ -833,8 +1665,33 @@ void DeferredPipeline::render_lighting(VkCommandBuffer cmd, const vec3& camera_p
     vkCmdDraw(cmd, 6, 1, 0, 0);
 }
 
-void DeferredPipeline::render_shadows(VkCommandBuffer cmd, const std::vector<Mesh*>& meshes,
-                                     const std::vector<mat4>& transforms) {
+void DeferredPipeline::upscale(VkCommandBuffer cmd) {
+    context_->begin_render_pass(cmd);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, upscale_pipeline_);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, upscale_layout_,
+                           0, 1, &upscale_descriptor_set_, 0, nullptr);
+
+    float width = static_cast<float>(width_);
+    float height = static_cast<float>(height_);
+
+    UpscalePushConstants push{};
+    push.uv_scale = vec4(static_cast<float>(render_width_) / width,
+                         static_cast<float>(render_height_) / height,
+                         (static_cast<float>(render_width_) - 0.5f) / width,
+                         (static_cast<float>(render_height_) - 0.5f) / height);
+
+    vkCmdPushConstants(cmd, upscale_layout_, VK_SHADER_STAGE_FRAGMENT_BIT,
+                       0, sizeof(UpscalePushConstants), &push);
+
+    VkBuffer vertex_buffers[] = {quad_vertex_buffer_};
+    VkDeviceSize offsets[] = {0};
+    vkCmdBindVertexBuffers(cmd, 0, 1, vertex_buffers, offsets);
+    vkCmdDraw(cmd, 6, 1, 0, 0);
+
+    context_->end_render_pass(cmd);
+}
+
+void DeferredPipeline::render_shadows(VkCommandBuffer cmd, const DrawList& casters) {
     uint32_t resolution = shadows_.resolution();
     float near_plane = 0.1f;
 
@@ -846,6 +1703,8 @@ void DeferredPipeline::render_shadows(VkCommandBuffer cmd, const std::vector<Mes
         const PointLight& light = lights_.lights()[light_idx];
         float far_plane = light.radius;
 
+        GpuScope scope(context_->profiler(), cmd, shadow_scope_names_[light_idx].c_str());
+
         mat4 proj = ShadowMapArray::get_projection(near_plane, far_plane);
 
         // Render each cubemap face
@@ -882,26 +1741,24 @@ void DeferredPipeline::render_shadows(VkCommandBuffer cmd, const std::vector<Mes
             scissor.extent = {resolution, resolution};
             vkCmdSetScissor(cmd, 0, 1, &scissor);
 
-            // Draw all meshes
-            for (size_t i = 0; i < meshes.size(); i++) {
-                // Skip null meshes or meshes with invalid buffers
-                if (!meshes[i] || meshes[i]->vertex_buffer() == VK_NULL_HANDLE) {
+            // Draw all casters; instance transforms are applied in the shader
+            mat4 light_view_proj = proj * view;
+            BoundBuffers bound;
+            for (size_t i = 0; i < casters.size(); i++) {
+                const DrawPacket& packet = casters.packet(i);
+                if (!bind_draw_buffers(cmd, packet, bound, nullptr)) {
                     continue;
                 }
 
                 ShadowPushConstants push{};
-                push.light_space_matrix = proj * view * transforms[i];
+                push.light_space_matrix = light_view_proj * packet.model;
                 push.light_pos = vec4(light.position.x, light.position.y,
                                      light.position.z, far_plane);
 
                 vkCmdPushConstants(cmd, shadow_layout_, VK_SHADER_STAGE_VERTEX_BIT,
                                    0, sizeof(ShadowPushConstants), &push);
-
-                VkBuffer vertex_buffers[] = {meshes[i]->vertex_buffer()};
-                VkDeviceSize offsets[] = {0};
-                vkCmdBindVertexBuffers(cmd, 0, 1, vertex_buffers, offsets);
-                vkCmdBindIndexBuffer(cmd, meshes[i]->index_buffer(), 0, VK_INDEX_TYPE_UINT32);
-                vkCmdDrawIndexed(cmd, meshes[i]->index_count(), 1, 0, 0, 0);
+                vkCmdDrawIndexed(cmd, packet.mesh->index_count(), packet.instance_count, 0, 0,
+                                 packet.first_instance);
             }
 
             vkCmdEndRenderPass(cmd);
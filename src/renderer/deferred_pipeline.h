@@ -2,17 +2,40 @@
  * Slam Engine - Deferred Rendering Pipeline
  *
  * Two-pass deferred shading:
- * 1. Geometry pass: Render scene to G-buffer
+ * 1. Geometry pass: Render scene to G-buffer (optionally after a depth-only
+ *    pre-pass in the same subpass)
  * 2. Lighting pass: Calculate lighting from G-buffer
+ *
+ * With subpass_lighting both passes run as subpasses of one render pass and
+ * the lighting shader reads the G-buffer through input attachments.
+ *
+ * The frame (shadows -> geometry -> lighting) is a RenderGraph; render_frame()
+ * executes it, so barriers between the passes come from the graph.
+ *
+ * Below full render scale (fixed or dynamic) geometry and lighting run at a
+ * reduced internal resolution and an upscale pass fills the swapchain. The
+ * G-buffer stays allocated at full size, so scale changes never reallocate.
+ * With temporal_upscale the upscale pass is replaced by a temporal resolve
+ * that accumulates jittered frames into a full-resolution history.
  */
 
 #pragma once
 
+#include "draw_list.h"
+#include "dynamic_resolution.h"
+#include "frame_uniforms.h"
 #include "gbuffer.h"
+#include "instance_buffer.h"
 #include "light.h"
+#include "material_library.h"
+#include "render_graph.h"
 #include "shadow_map.h"
+#include "temporal_upscaler.h"
 #include "utils/math.h"
 #include <vulkan/vulkan.h>
+#include <functional>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace slam {
@@ -20,11 +43,12 @@ namespace slam {
 class VulkanContext;
 class Mesh;
 
-// Push constants for geometry pass
+// Push constants for geometry pass (camera matrices come from the
+// per-frame uniform buffer)
 struct GeometryPushConstants {
     mat4 model;
-    mat4 view;
-    mat4 projection;
+    uint32_t material;  // MaterialLibrary index, read by the fragment stage
+    uint32_t _padding[3];
 };
 
 // Push constants for lighting pass
@@ -32,6 +56,69 @@ struct LightingPushConstants {
     mat4 inv_view_proj;
     vec4 camera_pos;
     vec4 screen_size;  // xy = size, z = near, w = far
+    vec4 gbuffer_scale;  // xy = render size / G-buffer size
+};
+
+// Lighting shader specialization constants (constant_id order, must match
+// lighting_common.glsl). The cluster values mirror light.h so the shader
+// indexes clusters the way LightManager fills them.
+struct LightingSpecialization {
+    uint32_t cluster_x = CLUSTER_X;
+    uint32_t cluster_y = CLUSTER_Y;
+    uint32_t cluster_z = CLUSTER_Z;
+    uint32_t max_lights_per_cluster = MAX_LIGHTS_PER_CLUSTER;
+    uint32_t max_shadow_lights = MAX_SHADOW_CASTERS;
+    VkBool32 shadows = VK_TRUE;
+
+    bool operator==(const LightingSpecialization& other) const {
+        return cluster_x == other.cluster_x && cluster_y == other.cluster_y &&
+               cluster_z == other.cluster_z && max_lights_per_cluster == other.max_lights_per_cluster &&
+               max_shadow_lights == other.max_shadow_lights && shadows == other.shadows;
+    }
+};
+
+// Push constants for upscale pass
+struct UpscalePushConstants {
+    vec4 uv_scale;  // xy = render size / image size, zw = UV clamp
+};
+
+struct DeferredPipelineConfig {
+    bool subpass_lighting = false;  // Single render pass, G-buffer kept in tile memory
+
+    // Internal resolution (separate-pass path only; subpass lighting writes
+    // the swapchain directly). render_scale is the fixed per-axis scale;
+    // dynamic_resolution lets GPU frame time choose it instead.
+    float render_scale = 1.0f;
+    bool dynamic_resolution = false;
+    DynamicResolutionConfig resolution;
+
+    // Reconstruct the scaled image temporally (jittered frames reprojected
+    // into a full-resolution history) instead of a bilinear upscale. Only
+    // applies when upscaling.
+    bool temporal_upscale = false;
+
+    // Lay down depth with a position-only pass first; the G-buffer pass
+    // then tests EQUAL without depth writes, so hidden fragments are never
+    // shaded or written. Can be switched at runtime (set_depth_prepass).
+    bool depth_prepass = false;
+
+    // Point light shadows. When off the shadow pass is skipped and the
+    // lighting variant is built without shadow sampling (set_shadows).
+    bool shadows = true;
+};
+
+// Per-frame inputs for render_frame()
+struct DeferredFrame {
+    vec3 camera_pos;
+    float near_plane = 0.1f;
+    float far_plane = 100.0f;
+
+    // Shadow casters (recorded once per light face, in list order)
+    const DrawList* shadow_casters = nullptr;
+
+    // Issues draw_mesh() calls inside the geometry pass (twice per frame
+    // with the depth pre-pass, so it must record the same draws each time)
+    std::function<void(VkCommandBuffer cmd)> draw_geometry;
 };
 
 class DeferredPipeline {
@@ -44,7 +131,8 @@ public:
     DeferredPipeline& operator=(const DeferredPipeline&) = delete;
 
     // Initialize pipeline
-    bool init(VulkanContext& context, uint32_t width, uint32_t height);
+    bool init(VulkanContext& context, uint32_t width, uint32_t height,
+              const DeferredPipelineConfig& config = {});
 
     // Cleanup
     void destroy();
@@ -52,20 +140,31 @@ public:
     // Recreate for window resize
     bool resize(uint32_t width, uint32_t height);
 
+    // Record the whole frame (shadows, geometry, lighting into the current
+    // swapchain image) through the render graph
+    void render_frame(VkCommandBuffer cmd, const DeferredFrame& frame);
+
     // Begin geometry pass
     void begin_geometry_pass(VkCommandBuffer cmd);
     void end_geometry_pass(VkCommandBuffer cmd);
 
-    // Begin lighting pass (renders to swapchain)
+    // Begin lighting pass (renders to swapchain). In subpass mode this advances
+    // to the lighting subpass and the target arguments are ignored.
     void begin_lighting_pass(VkCommandBuffer cmd, VkFramebuffer target_framebuffer,
                             VkRenderPass target_render_pass, uint32_t width, uint32_t height);
     void end_lighting_pass(VkCommandBuffer cmd);
 
-    // Set view/projection for geometry pass
+    // Set view/projection for geometry pass (writes this frame's uniforms,
+    // so call after begin_frame)
     void set_view_projection(const mat4& view, const mat4& proj);
 
-    // Draw mesh in geometry pass
-    void draw_mesh(VkCommandBuffer cmd, const Mesh& mesh, const mat4& model);
+    // Draw mesh in geometry pass (MATERIAL_NONE: vertex color, no maps)
+    void draw_mesh(VkCommandBuffer cmd, const Mesh& mesh, const mat4& model,
+                   uint32_t material = MATERIAL_NONE);
+
+    // Record a sorted draw list in the geometry pass, binding each mesh's
+    // and instance buffer only when it changes. Fills list.stats().
+    void draw_list(VkCommandBuffer cmd, DrawList& list);
 
     // Execute lighting pass (call after begin_lighting_pass)
     void render_lighting(VkCommandBuffer cmd, const vec3& camera_pos,
@@ -75,37 +174,105 @@ public:
     LightManager& lights() { return lights_; }
     const LightManager& lights() const { return lights_; }
 
+    // Material management (bound for the whole geometry pass)
+    MaterialLibrary& materials() { return materials_; }
+    const MaterialLibrary& materials() const { return materials_; }
+
     // Shadow rendering (call before geometry pass)
-    void render_shadows(VkCommandBuffer cmd, const std::vector<Mesh*>& meshes,
-                       const std::vector<mat4>& transforms);
+    void render_shadows(VkCommandBuffer cmd, const DrawList& casters);
+
+    // Depth pre-pass (takes effect from the next recorded frame)
+    void set_depth_prepass(bool enabled) { depth_prepass_ = enabled; }
+    bool depth_prepass() const { return depth_prepass_; }
+
+    // Shadows (each setting has its own lighting pipeline variant, built on
+    // first use and cached)
+    void set_shadows(bool enabled) { shadows_enabled_ = enabled; }
+    bool shadows_enabled() const { return shadows_enabled_; }
+
+    // Internal resolution
+    bool upscaling() const { return upscaling_; }
+    float render_scale() const { return render_scale_; }
+    uint32_t render_width() const { return render_width_; }
+    uint32_t render_height() const { return render_height_; }
+    bool temporal_upscaling() const { return temporal_; }
 
     // Access components
     GBuffer& gbuffer() { return gbuffer_; }
     ShadowMapArray& shadows() { return shadows_; }
+    const RenderGraph& graph() const { return graph_; }
 
 private:
+    // Buffers bound by the last recorded draw
+    struct BoundBuffers {
+        const Mesh* mesh = nullptr;
+        VkBuffer instances = VK_NULL_HANDLE;
+    };
+
+    bool bind_draw_buffers(VkCommandBuffer cmd, const DrawPacket& packet, BoundBuffers& bound,
+                           DrawListStats* stats);
+    void record_geometry(VkCommandBuffer cmd);
     bool create_geometry_pipeline();
     bool create_lighting_pipeline();
+    VkPipeline lighting_pipeline();
+    VkPipeline create_lighting_variant(const LightingSpecialization& spec);
     bool create_shadow_pipeline();
+    bool create_scene_render_pass();
+    bool create_upscale_pipeline();
     bool create_descriptor_sets();
     bool update_descriptor_sets();
+    bool update_scene_target();
+    bool sync_swapchain();
+    bool build_frame_graph();
+    void set_render_scale(float scale);
+    void upscale(VkCommandBuffer cmd);
 
     VulkanContext* context_ = nullptr;
+    DeferredPipelineConfig config_;
+    uint32_t swapchain_generation_ = 0;
     uint32_t width_ = 0;
     uint32_t height_ = 0;
 
+    // Internal resolution (top-left region of the full-size targets)
+    bool upscaling_ = false;
+    float render_scale_ = 1.0f;
+    uint32_t render_width_ = 0;
+    uint32_t render_height_ = 0;
+    DynamicResolution resolution_;
+
     // Subsystems
     GBuffer gbuffer_;
     LightManager lights_;
+    MaterialLibrary materials_;
+    FrameUniformBuffer frame_uniforms_;
     ShadowMapArray shadows_;
 
+    // Frame graph
+    RenderGraph graph_;
+    RGResource rg_swapchain_ = RG_INVALID_RESOURCE;
+    RGResource rg_shadows_ = RG_INVALID_RESOURCE;
+    RGResource rg_normal_ = RG_INVALID_RESOURCE;
+    RGResource rg_albedo_ = RG_INVALID_RESOURCE;
+    RGResource rg_depth_ = RG_INVALID_RESOURCE;
+    RGResource rg_scene_ = RG_INVALID_RESOURCE;
+    RGResource rg_history_read_ = RG_INVALID_RESOURCE;
+    RGResource rg_history_write_ = RG_INVALID_RESOURCE;
+    const DeferredFrame* frame_ = nullptr;  // Valid during render_frame()
+
+    // GPU profiler scope names, one per shadow-casting light
+    std::vector<std::string> shadow_scope_names_;
+
     // Geometry pass
     VkPipelineLayout geometry_layout_ = VK_NULL_HANDLE;
     VkPipeline geometry_pipeline_ = VK_NULL_HANDLE;
+    VkPipeline geometry_equal_pipeline_ = VK_NULL_HANDLE;  // After the depth pre-pass
+    VkPipeline depth_prepass_pipeline_ = VK_NULL_HANDLE;
+    bool depth_prepass_ = false;
 
     // Lighting pass
     VkPipelineLayout lighting_layout_ = VK_NULL_HANDLE;
-    VkPipeline lighting_pipeline_ = VK_NULL_HANDLE;
+    std::vector<std::pair<LightingSpecialization, VkPipeline>> lighting_variants_;
+    bool shadows_enabled_ = true;
     VkDescriptorSetLayout lighting_descriptor_layout_ = VK_NULL_HANDLE;
     VkDescriptorPool lighting_descriptor_pool_ = VK_NULL_HANDLE;
     VkDescriptorSet lighting_descriptor_set_ = VK_NULL_HANDLE;
@@ -114,6 +281,23 @@ private:
     VkPipelineLayout shadow_layout_ = VK_NULL_HANDLE;
     VkPipeline shadow_pipeline_ = VK_NULL_HANDLE;
 
+    // Scaled lighting target and upscale pass
+    VkRenderPass scene_render_pass_ = VK_NULL_HANDLE;
+    VkFramebuffer scene_framebuffer_ = VK_NULL_HANDLE;
+    VkSampler upscale_sampler_ = VK_NULL_HANDLE;
+    VkPipelineLayout upscale_layout_ = VK_NULL_HANDLE;
+    VkPipeline upscale_pipeline_ = VK_NULL_HANDLE;
+    VkDescriptorSetLayout upscale_descriptor_layout_ = VK_NULL_HANDLE;
+    VkDescriptorPool upscale_descriptor_pool_ = VK_NULL_HANDLE;
+    VkDescriptorSet upscale_descriptor_set_ = VK_NULL_HANDLE;
+
+    // Temporal resolve (replaces the upscale pass)
+    TemporalUpscaler temporal_upscaler_;
+    bool temporal_ = false;
+
+    // Single identity transform for non-instanced draws
+    InstanceBuffer identity_instance_;
+
     // Full-screen quad for lighting
     VkBuffer quad_vertex_buffer_ = VK_NULL_HANDLE;
     VkDeviceMemory quad_vertex_memory_ = VK_NULL_HANDLE;
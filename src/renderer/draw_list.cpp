@@ -0,0 +1,102 @@
+/**
+ * Slam Engine - Draw List Implementation
+ */
+
+#include "draw_list.h"
+#include "instance_buffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace slam {
+
+void DrawList::clear() {
+    packets_.clear();
+    entries_.clear();
+    mesh_ids_.clear();
+    stats_ = DrawListStats{};
+}
+
+void DrawList::add(const Mesh& mesh, const mat4& model, uint32_t material, float view_depth,
+                   uint8_t pipeline) {
+    // Clamp keeps the float bits in the positive (integer-ordered) range
+    float depth = std::max(view_depth, 0.0f);
+    uint32_t depth_bits;
+    memcpy(&depth_bits, &depth, sizeof(depth_bits));
+
+    DrawPacket packet;
+    packet.mesh = &mesh;
+    packet.model = model;
+    packet.material = material;
+
+    push((static_cast<uint64_t>(pipeline) << 56) |
+         (static_cast<uint64_t>(mesh_id(&mesh) & 0xFFFFFF) << 32) |
+         depth_bits, packet);
+}
+
+void DrawList::add_instanced(const Mesh& mesh, const InstanceBuffer& instances, uint32_t first,
+                             uint32_t count, uint32_t material, uint8_t pipeline) {
+    if (count == 0) return;
+
+    DrawPacket packet;
+    packet.mesh = &mesh;
+    packet.model = mat4::identity();
+    packet.material = material;
+    packet.instance_buffer = instances.buffer();
+    packet.first_instance = first;
+    packet.instance_count = count;
+
+    push((static_cast<uint64_t>(pipeline) << 56) |
+         (static_cast<uint64_t>(mesh_id(&mesh) & 0xFFFFFF) << 32), packet);
+}
+
+void DrawList::push(uint64_t key, const DrawPacket& packet) {
+    SortEntry entry;
+    entry.key = key;
+    entry.index = static_cast<uint32_t>(packets_.size());
+    entries_.push_back(entry);
+    packets_.push_back(packet);
+}
+
+uint32_t DrawList::mesh_id(const Mesh* mesh) {
+    auto it = mesh_ids_.find(mesh);
+    if (it != mesh_ids_.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(mesh_ids_.size());
+    mesh_ids_.emplace(mesh, id);
+    return id;
+}
+
+void DrawList::sort() {
+    size_t count = entries_.size();
+    if (count < 2) return;
+
+    scratch_.resize(count);
+
+    // LSD radix sort, one byte per pass. Stable, so each pass keeps the
+    // order of the lower bytes; passes where every key has the same byte
+    // are skipped (typically the pipeline byte and the high mesh bytes).
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        uint32_t histogram[256] = {};
+        for (const SortEntry& entry : entries_) {
+            histogram[(entry.key >> shift) & 0xFF]++;
+        }
+
+        uint32_t first_byte = (entries_[0].key >> shift) & 0xFF;
+        if (histogram[first_byte] == count) continue;
+
+        uint32_t offset = 0;
+        for (uint32_t& bucket : histogram) {
+            uint32_t bucket_count = bucket;
+            bucket = offset;
+            offset += bucket_count;
+        }
+
+        for (const SortEntry& entry : entries_) {
+            scratch_[histogram[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        entries_.swap(scratch_);
+    }
+}
+
+} // namespace slam
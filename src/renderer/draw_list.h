@@ -0,0 +1,101 @@
+/**
+ * Slam Engine - Draw List
+ *
+ * Draw packets collected for one pass, sorted by a packed 64-bit key and
+ * then recorded in key order. Sorting groups draws that share a pipeline
+ * and mesh so the recorder can skip redundant binds; within a mesh draws go
+ * front to back for early depth rejection.
+ *
+ * Key layout (most significant first):
+ *   [63:56] pipeline   [55:32] mesh   [31:0] view depth (float bits)
+ *
+ * Positive IEEE floats order the same as their bit patterns, so depth can
+ * be sorted as an integer. Mesh ids are assigned per list on first use.
+ * Only (key, index) pairs move during the sort; packets stay where they
+ * were added.
+ */
+
+#pragma once
+
+#include "utils/math.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace slam {
+
+class Mesh;
+class InstanceBuffer;
+
+// One draw: a mesh with a model matrix, drawn once per instance in
+// [first_instance, first_instance + instance_count) of instance_buffer.
+// Without an instance buffer the recorder supplies a single identity.
+struct DrawPacket {
+    const Mesh* mesh = nullptr;
+    mat4 model;
+    uint32_t material = 0;
+    VkBuffer instance_buffer = VK_NULL_HANDLE;
+    uint32_t first_instance = 0;
+    uint32_t instance_count = 1;
+};
+
+// Per-frame recording statistics (filled when the list is recorded)
+struct DrawListStats {
+    uint32_t draws = 0;
+    uint32_t instances = 0;
+    uint32_t mesh_binds = 0;
+    uint32_t binds_skipped = 0;  // Draws that reused the previous draw's buffers
+};
+
+class DrawList {
+public:
+    DrawList() = default;
+
+    // Remove all packets (keeps allocations). Lists whose contents do not
+    // change can be built and sorted once and recorded every frame.
+    void clear();
+
+    // Queue a draw. view_depth is the distance along the view direction
+    // (negative values clamp to 0); pipeline selects the bucket.
+    void add(const Mesh& mesh, const mat4& model, uint32_t material, float view_depth,
+             uint8_t pipeline = 0);
+
+    // Queue one instanced draw of count transforms from instances, starting
+    // at first. Instanced draws carry no depth; they sort by mesh only.
+    void add_instanced(const Mesh& mesh, const InstanceBuffer& instances, uint32_t first,
+                       uint32_t count, uint32_t material, uint8_t pipeline = 0);
+
+    // Radix sort by key
+    void sort();
+
+    // Packets in key order after sort(), insertion order before
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    const DrawPacket& packet(size_t i) const { return packets_[entries_[i].index]; }
+    uint64_t key(size_t i) const { return entries_[i].key; }
+
+    // Reset and filled by the recorder each time the list is recorded
+    DrawListStats& stats() { return stats_; }
+    const DrawListStats& stats() const { return stats_; }
+
+    static uint8_t key_pipeline(uint64_t key) { return static_cast<uint8_t>(key >> 56); }
+
+private:
+    void push(uint64_t key, const DrawPacket& packet);
+
+    struct SortEntry {
+        uint64_t key;
+        uint32_t index;  // Into packets_
+    };
+
+    uint32_t mesh_id(const Mesh* mesh);
+
+    std::vector<DrawPacket> packets_;
+    std::vector<SortEntry> entries_;
+    std::vector<SortEntry> scratch_;  // Radix sort ping-pong buffer
+    std::unordered_map<const Mesh*, uint32_t> mesh_ids_;
+    DrawListStats stats_;
+};
+
+} // namespace slam
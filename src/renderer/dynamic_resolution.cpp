@@ -0,0 +1,64 @@
+/**
+ * Slam Engine - Dynamic Resolution Implementation
+ */
+
+#include "dynamic_resolution.h"
+#include "utils/math.h"
+#include <cmath>
+
+namespace slam {
+
+// Budget band: shrink above the high mark, grow below the low mark
+constexpr double BUDGET_HIGH = 0.95;
+constexpr double BUDGET_LOW = 0.80;
+constexpr double BUDGET_TARGET = 0.88;
+
+// Exponential smoothing of the measured frame time
+constexpr double FILTER_WEIGHT = 0.1;
+
+void DynamicResolution::init(const DynamicResolutionConfig& config) {
+    config_ = config;
+    scale_ = quantize(config_.max_scale);
+    filtered_ms_ = 0.0;
+    has_sample_ = false;
+    frames_since_change_ = 0;
+}
+
+bool DynamicResolution::update(double gpu_ms) {
+    if (gpu_ms <= 0.0) return false;
+
+    filtered_ms_ = has_sample_ ? filtered_ms_ + (gpu_ms - filtered_ms_) * FILTER_WEIGHT : gpu_ms;
+    has_sample_ = true;
+
+    if (++frames_since_change_ < config_.settle_frames) return false;
+
+    double budget = config_.frame_budget_ms;
+    if (filtered_ms_ <= budget * BUDGET_HIGH && filtered_ms_ >= budget * BUDGET_LOW) {
+        return false;
+    }
+
+    // Pixel cost model: time ~ scale^2
+    float target = scale_ * static_cast<float>(std::sqrt(budget * BUDGET_TARGET / filtered_ms_));
+    float next;
+    if (target < scale_) {
+        // Drop straight to the estimate when over budget
+        next = quantize(std::floor(target / config_.scale_step) * config_.scale_step);
+    } else {
+        // Grow one step at a time to avoid overshooting back over budget
+        next = quantize(std::fmin(target, scale_ + config_.scale_step));
+    }
+
+    if (std::fabs(next - scale_) < config_.scale_step * 0.5f) return false;
+
+    scale_ = next;
+    frames_since_change_ = 0;
+    has_sample_ = false;  // Restart the filter at the new resolution
+    return true;
+}
+
+float DynamicResolution::quantize(float scale) const {
+    float stepped = std::round(scale / config_.scale_step) * config_.scale_step;
+    return clamp(stepped, config_.min_scale, config_.max_scale);
+}
+
+} // namespace slam
@@ -0,0 +1,47 @@
+/**
+ * Slam Engine - Dynamic Resolution
+ *
+ * Picks the internal render scale from measured GPU frame time. The
+ * resolution-dependent passes cost roughly scale^2, so when the filtered
+ * frame time leaves the budget band the scale is moved to where the model
+ * says it would land. Changes are quantized and rate limited so the image
+ * does not visibly pump.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace slam {
+
+struct DynamicResolutionConfig {
+    float frame_budget_ms = 16.6f;   // GPU time target (60 fps)
+    float min_scale = 0.5f;          // Per-axis scale bounds
+    float max_scale = 1.0f;
+    float scale_step = 0.05f;        // Scales are multiples of this
+    uint32_t settle_frames = 30;     // Frames to wait after a change (timings lag a few frames)
+};
+
+class DynamicResolution {
+public:
+    DynamicResolution() = default;
+
+    void init(const DynamicResolutionConfig& config);
+
+    // Feed the latest GPU frame time; returns true if the scale changed
+    bool update(double gpu_ms);
+
+    float scale() const { return scale_; }
+    double filtered_ms() const { return filtered_ms_; }
+
+private:
+    float quantize(float scale) const;
+
+    DynamicResolutionConfig config_;
+    float scale_ = 1.0f;
+    double filtered_ms_ = 0.0;
+    bool has_sample_ = false;
+    uint32_t frames_since_change_ = 0;
+};
+
+} // namespace slam
@@ -0,0 +1,138 @@
+/**
+ * Slam Engine - Frame Uniforms Implementation
+ */
+
+#include "frame_uniforms.h"
+#include "vulkan_context.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace slam {
+
+FrameUniformBuffer::~FrameUniformBuffer() {
+    destroy();
+}
+
+bool FrameUniformBuffer::init(VulkanContext& context, VkShaderStageFlags stages) {
+    context_ = &context;
+    VkDevice device = context.device();
+    uint32_t frame_count = context.max_frames_in_flight();
+
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    binding.descriptorCount = 1;
+    binding.stageFlags = stages;
+
+    VkDescriptorSetLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = 1;
+    layout_info.pBindings = &binding;
+
+    if (vkCreateDescriptorSetLayout(device, &layout_info, nullptr, &descriptor_layout_) != VK_SUCCESS) {
+        fprintf(stderr, "Failed to create frame uniform descriptor layout\n");
+        return false;
+    }
+
+    VkDescriptorPoolSize pool_size{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1};
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.poolSizeCount = 1;
+    pool_info.pPoolSizes = &pool_size;
+    pool_info.maxSets = 1;
+
+    if (vkCreateDescriptorPool(device, &pool_info, nullptr, &descriptor_pool_) != VK_SUCCESS) {
+        fprintf(stderr, "Failed to create frame uniform descriptor pool\n");
+        return false;
+    }
+
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = descriptor_pool_;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = &descriptor_layout_;
+
+    if (vkAllocateDescriptorSets(device, &alloc_info, &descriptor_set_) != VK_SUCCESS) {
+        fprintf(stderr, "Failed to allocate frame uniform descriptor set\n");
+        return false;
+    }
+
+    // One region per frame in flight at a valid dynamic offset
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(context.physical_device(), &properties);
+    VkDeviceSize alignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 16);
+    stride_ = (sizeof(FrameUniformData) + alignment - 1) / alignment * alignment;
+
+    context.create_buffer(stride_ * frame_count,
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        buffer_, memory_, ResourceCategory::Uniforms);
+    vkMapMemory(device, memory_, 0, stride_ * frame_count, 0, reinterpret_cast<void**>(&mapped_));
+
+    VkDescriptorBufferInfo buffer_info{};
+    buffer_info.buffer = buffer_;
+    buffer_info.offset = 0;
+    buffer_info.range = sizeof(FrameUniformData);
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptor_set_;
+    write.dstBinding = 0;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    write.descriptorCount = 1;
+    write.pBufferInfo = &buffer_info;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+
+    data_.view = mat4::identity();
+    data_.projection = mat4::identity();
+    data_.view_projection = mat4::identity();
+    for (uint32_t i = 0; i < frame_count; i++) {
+        memcpy(mapped_ + stride_ * i, &data_, sizeof(FrameUniformData));
+    }
+
+    return true;
+}
+
+void FrameUniformBuffer::destroy() {
+    if (!context_ || !context_->device()) return;
+
+    VkDevice device = context_->device();
+
+    if (buffer_) {
+        vkUnmapMemory(device, memory_);
+        vkDestroyBuffer(device, buffer_, nullptr);
+        context_->free_memory(memory_);
+        buffer_ = VK_NULL_HANDLE;
+        memory_ = VK_NULL_HANDLE;
+        mapped_ = nullptr;
+    }
+    if (descriptor_pool_) {
+        vkDestroyDescriptorPool(device, descriptor_pool_, nullptr);
+        descriptor_pool_ = VK_NULL_HANDLE;
+        descriptor_set_ = VK_NULL_HANDLE;
+    }
+    if (descriptor_layout_) {
+        vkDestroyDescriptorSetLayout(device, descriptor_layout_, nullptr);
+        descriptor_layout_ = VK_NULL_HANDLE;
+    }
+
+    context_ = nullptr;
+}
+
+void FrameUniformBuffer::update(const mat4& view, const mat4& projection) {
+    data_.view = view;
+    data_.projection = projection;
+    data_.view_projection = projection * view;
+
+    uint8_t* region = mapped_ + stride_ * context_->current_frame();
+    memcpy(region, &data_, sizeof(FrameUniformData));
+}
+
+void FrameUniformBuffer::bind(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t set) const {
+    uint32_t offset = static_cast<uint32_t>(stride_ * context_->current_frame());
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, set, 1, &descriptor_set_, 1, &offset);
+}
+
+} // namespace slam
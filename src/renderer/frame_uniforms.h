@@ -0,0 +1,67 @@
+/**
+ * Slam Engine - Frame Uniforms
+ *
+ * Camera matrices uploaded once per frame instead of pushed with every draw.
+ * One persistently mapped buffer holds a region per frame in flight; a
+ * single descriptor set points at it as a dynamic uniform buffer and bind()
+ * selects the current frame's region with the dynamic offset, so writing
+ * this frame's matrices never touches data a previous frame is still
+ * reading.
+ */
+
+#pragma once
+
+#include "utils/math.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+namespace slam {
+
+class VulkanContext;
+
+// Per-frame uniform block (std140, must match FrameUniforms in shaders)
+struct FrameUniformData {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+};
+
+class FrameUniformBuffer {
+public:
+    FrameUniformBuffer() = default;
+    ~FrameUniformBuffer();
+
+    // Non-copyable
+    FrameUniformBuffer(const FrameUniformBuffer&) = delete;
+    FrameUniformBuffer& operator=(const FrameUniformBuffer&) = delete;
+
+    // Create the buffer, layout and set. stages: shader stages that read it.
+    bool init(VulkanContext& context, VkShaderStageFlags stages = VK_SHADER_STAGE_VERTEX_BIT);
+
+    // Cleanup
+    void destroy();
+
+    // Write the current frame's region (after begin_frame)
+    void update(const mat4& view, const mat4& projection);
+
+    // Bind the current frame's region at the given set index
+    void bind(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t set) const;
+
+    VkDescriptorSetLayout descriptor_layout() const { return descriptor_layout_; }
+    const FrameUniformData& data() const { return data_; }
+
+private:
+    VulkanContext* context_ = nullptr;
+    VkDescriptorSetLayout descriptor_layout_ = VK_NULL_HANDLE;
+    VkDescriptorPool descriptor_pool_ = VK_NULL_HANDLE;
+    VkDescriptorSet descriptor_set_ = VK_NULL_HANDLE;
+
+    VkBuffer buffer_ = VK_NULL_HANDLE;
+    VkDeviceMemory memory_ = VK_NULL_HANDLE;
+    uint8_t* mapped_ = nullptr;
+    VkDeviceSize stride_ = 0;  // Region size, aligned for dynamic offsets
+
+    FrameUniformData data_;  // Last written values
+};
+
+} // namespace slam
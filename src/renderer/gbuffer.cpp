@@ -13,44 +13,14 @@ GBuffer::~GBuffer() {
     destroy();
 }
 
-bool GBuffer::init(VulkanContext& context, uint32_t width, uint32_t height) {
+bool GBuffer::init(VulkanContext& context, uint32_t width, uint32_t height,
+                   bool subpass_lighting) {
     context_ = &context;
     width_ = width;
     height_ = height;
+    subpass_lighting_ = subpass_lighting;
 
-    // Create attachments
-    if (!create_attachment(position_, VK_FORMAT_R16G16B16A16_SFLOAT,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_IMAGE_ASPECT_COLOR_BIT)) {
-        fprintf(stderr, "Failed to create position attachment\n");
-        return false;
-    }
-
-    if (!create_attachment(normal_, VK_FORMAT_R16G16B16A16_SFLOAT,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_IMAGE_ASPECT_COLOR_BIT)) {
-        fprintf(stderr, "Failed to create normal attachment\n");
-        return false;
-    }
-
-    if (!create_attachment(albedo_, VK_FORMAT_R8G8B8A8_UNORM,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_IMAGE_ASPECT_COLOR_BIT)) {
-        fprintf(stderr, "Failed to create albedo attachment\n");
-        return false;
-    }
-
-    if (!create_attachment(material_, VK_FORMAT_R8G8_UNORM,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_IMAGE_ASPECT_COLOR_BIT)) {
-        fprintf(stderr, "Failed to create material attachment\n");
-        return false;
-    }
-
-    if (!create_attachment(depth_, VK_FORMAT_D32_SFLOAT,
-            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_IMAGE_ASPECT_DEPTH_BIT)) {
-        fprintf(stderr, "Failed to create depth attachment\n");
+    if (!create_attachments()) {
         return false;
     }
 
@@ -59,7 +29,8 @@ bool GBuffer::init(VulkanContext& context, uint32_t width, uint32_t height) {
         return false;
     }
 
-    if (!create_render_pass()) {
+    bool render_pass_ok = subpass_lighting_ ? create_subpass_render_pass() : create_render_pass();
+    if (!render_pass_ok) {
         fprintf(stderr, "Failed to create G-buffer render pass\n");
         return false;
     }
@@ -77,10 +48,7 @@ void GBuffer::destroy() {
 
     VkDevice device = context_->device();
 
-    if (framebuffer_) {
-        vkDestroyFramebuffer(device, framebuffer_, nullptr);
-        framebuffer_ = VK_NULL_HANDLE;
-    }
+    destroy_framebuffers();
 
     if (render_pass_) {
         vkDestroyRenderPass(device, render_pass_, nullptr);
@@ -92,10 +60,8 @@ void GBuffer::destroy() {
         sampler_ = VK_NULL_HANDLE;
     }
 
-    destroy_attachment(position_);
     destroy_attachment(normal_);
     destroy_attachment(albedo_);
-    destroy_attachment(material_);
     destroy_attachment(depth_);
 
     context_ = nullptr;
@@ -106,44 +72,56 @@ bool GBuffer::resize(uint32_t width, uint32_t height) {
 
     vkDeviceWaitIdle(context_->device());
 
-    // Destroy old framebuffer
-    if (framebuffer_) {
-        vkDestroyFramebuffer(context_->device(), framebuffer_, nullptr);
-        framebuffer_ = VK_NULL_HANDLE;
-    }
+    // Destroy old framebuffers
+    destroy_framebuffers();
 
     // Destroy old attachments
-    destroy_attachment(position_);
     destroy_attachment(normal_);
     destroy_attachment(albedo_);
-    destroy_attachment(material_);
     destroy_attachment(depth_);
 
     width_ = width;
     height_ = height;
 
-    // Recreate attachments
-    if (!create_attachment(position_, VK_FORMAT_R16G16B16A16_SFLOAT,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_IMAGE_ASPECT_COLOR_BIT)) return false;
+    if (!create_attachments()) {
+        return false;
+    }
+
+    return create_framebuffer();
+}
+
+bool GBuffer::create_attachments() {
+    lazily_allocated_ = false;
 
+    // Sampled by a separate lighting pass, or read in-tile by the lighting subpass
+    VkImageUsageFlags read_usage = subpass_lighting_
+        ? (VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT)
+        : VK_IMAGE_USAGE_SAMPLED_BIT;
+
+    // Normal is octahedral-encoded in RG, leaving BA free for roughness/metallic.
+    // World position is not stored; the lighting pass rebuilds it from depth.
     if (!create_attachment(normal_, VK_FORMAT_R16G16B16A16_SFLOAT,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_IMAGE_ASPECT_COLOR_BIT)) return false;
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | read_usage,
+            VK_IMAGE_ASPECT_COLOR_BIT)) {
+        fprintf(stderr, "Failed to create normal attachment\n");
+        return false;
+    }
 
     if (!create_attachment(albedo_, VK_FORMAT_R8G8B8A8_UNORM,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_IMAGE_ASPECT_COLOR_BIT)) return false;
-
-    if (!create_attachment(material_, VK_FORMAT_R8G8_UNORM,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_IMAGE_ASPECT_COLOR_BIT)) return false;
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | read_usage,
+            VK_IMAGE_ASPECT_COLOR_BIT)) {
+        fprintf(stderr, "Failed to create albedo attachment\n");
+        return false;
+    }
 
     if (!create_attachment(depth_, VK_FORMAT_D32_SFLOAT,
-            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_IMAGE_ASPECT_DEPTH_BIT)) return false;
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | read_usage,
+            VK_IMAGE_ASPECT_DEPTH_BIT)) {
+        fprintf(stderr, "Failed to create depth attachment\n");
+        return false;
+    }
 
-    return create_framebuffer();
+    return true;
 }
 
 bool GBuffer::create_attachment(GBufferAttachment& attachment, VkFormat format,
@@ -177,10 +155,20 @@ bool GBuffer::create_attachment(GBufferAttachment& attachment, VkFormat format,
     VkMemoryAllocateInfo alloc_info{};
     alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
     alloc_info.allocationSize = mem_req.size;
-    alloc_info.memoryTypeIndex = context_->find_memory_type(
-        mem_req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-    if (vkAllocateMemory(context_->device(), &alloc_info, nullptr, &attachment.memory) != VK_SUCCESS) {
+    // Transient attachments prefer lazily allocated (memoryless on Apple GPUs) memory
+    uint32_t lazy_type = 0;
+    if ((usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) &&
+        context_->find_memory_type(mem_req.memoryTypeBits,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, lazy_type)) {
+        alloc_info.memoryTypeIndex = lazy_type;
+        lazily_allocated_ = true;
+    } else {
+        alloc_info.memoryTypeIndex = context_->find_memory_type(
+            mem_req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+
+    if (context_->allocate_memory(alloc_info, ResourceCategory::GBuffer, attachment.memory) != VK_SUCCESS) {
         return false;
     }
 
@@ -216,18 +204,15 @@ void GBuffer::destroy_attachment(GBufferAttachment& attachment) {
         vkDestroyImage(context_->device(), attachment.image, nullptr);
         attachment.image = VK_NULL_HANDLE;
     }
-    if (attachment.memory) {
-        vkFreeMemory(context_->device(), attachment.memory, nullptr);
-        attachment.memory = VK_NULL_HANDLE;
-    }
+    context_->free_memory(attachment.memory);
 }
 
 bool GBuffer::create_render_pass() {
     // Attachment descriptions
-    std::array<VkAttachmentDescription, 5> attachments{};
+    std::array<VkAttachmentDescription, 3> attachments{};
 
-    // Position
-    attachments[0].format = VK_FORMAT_R16G16B16A16_SFLOAT;
+    // Normal + material
+    attachments[0].format = normal_.format;
     attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
     attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
@@ -236,8 +221,8 @@ bool GBuffer::create_render_pass() {
     attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     attachments[0].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-    // Normal
-    attachments[1].format = VK_FORMAT_R16G16B16A16_SFLOAT;
+    // Albedo
+    attachments[1].format = albedo_.format;
     attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
     attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
@@ -246,45 +231,23 @@ bool GBuffer::create_render_pass() {
     attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     attachments[1].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-    // Albedo
-    attachments[2].format = VK_FORMAT_R8G8B8A8_UNORM;
+    // Depth
+    attachments[2].format = depth_.format;
     attachments[2].samples = VK_SAMPLE_COUNT_1_BIT;
     attachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     attachments[2].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     attachments[2].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     attachments[2].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     attachments[2].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[2].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-    // Material
-    attachments[3].format = VK_FORMAT_R8G8_UNORM;
-    attachments[3].samples = VK_SAMPLE_COUNT_1_BIT;
-    attachments[3].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachments[3].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    attachments[3].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[3].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[3].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[3].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-    // Depth
-    attachments[4].format = VK_FORMAT_D32_SFLOAT;
-    attachments[4].samples = VK_SAMPLE_COUNT_1_BIT;
-    attachments[4].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachments[4].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    attachments[4].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[4].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[4].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[4].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    attachments[2].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 
     // Color attachment references
-    std::array<VkAttachmentReference, 4> color_refs{};
+    std::array<VkAttachmentReference, 2> color_refs{};
     color_refs[0] = {0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
     color_refs[1] = {1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
-    color_refs[2] = {2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
-    color_refs[3] = {3, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
 
     // Depth attachment reference
-    VkAttachmentReference depth_ref{4, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+    VkAttachmentReference depth_ref{2, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
 
     // Subpass
     VkSubpassDescription subpass{};
@@ -293,8 +256,9 @@ bool GBuffer::create_render_pass() {
     subpass.pColorAttachments = color_refs.data();
     subpass.pDepthStencilAttachment = &depth_ref;
 
-    // Dependencies
-    std::array<VkSubpassDependency, 2> dependencies{};
+    // Dependencies. Only the incoming one: the render graph orders the
+    // lighting pass reads after this pass with its own barrier.
+    std::array<VkSubpassDependency, 1> dependencies{};
 
     dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
     dependencies[0].dstSubpass = 0;
@@ -306,16 +270,6 @@ bool GBuffer::create_render_pass() {
                                     VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
     dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
-    dependencies[1].srcSubpass = 0;
-    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
-                                   VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
-                                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
     // Create render pass
     VkRenderPassCreateInfo render_pass_info{};
     render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -329,12 +283,156 @@ bool GBuffer::create_render_pass() {
     return vkCreateRenderPass(context_->device(), &render_pass_info, nullptr, &render_pass_) == VK_SUCCESS;
 }
 
+bool GBuffer::create_subpass_render_pass() {
+    // Attachment 0 is the swapchain image; the G-buffer attachments are only
+    // live inside this render pass, so their contents are never stored.
+    std::array<VkAttachmentDescription, 4> attachments{};
+
+    // Swapchain color (every pixel is written by the lighting subpass)
+    attachments[0].format = context_->swapchain_format();
+    attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[0].finalLayout = context_->present_layout();
+
+    // Normal + material
+    attachments[1].format = normal_.format;
+    attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[1].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    // Albedo
+    attachments[2].format = albedo_.format;
+    attachments[2].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[2].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[2].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[2].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[2].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[2].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    // Depth
+    attachments[3].format = depth_.format;
+    attachments[3].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[3].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[3].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[3].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[3].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[3].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[3].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+    // Subpass 0: geometry
+    std::array<VkAttachmentReference, 2> gbuffer_refs{};
+    gbuffer_refs[0] = {1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+    gbuffer_refs[1] = {2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+    VkAttachmentReference depth_ref{3, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+
+    // Subpass 1: lighting (input_attachment_index matches the array order)
+    VkAttachmentReference swapchain_ref{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+    std::array<VkAttachmentReference, 3> input_refs{};
+    input_refs[0] = {1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    input_refs[1] = {2, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    input_refs[2] = {3, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+
+    std::array<VkSubpassDescription, 2> subpasses{};
+    subpasses[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpasses[0].colorAttachmentCount = static_cast<uint32_t>(gbuffer_refs.size());
+    subpasses[0].pColorAttachments = gbuffer_refs.data();
+    subpasses[0].pDepthStencilAttachment = &depth_ref;
+
+    subpasses[1].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpasses[1].colorAttachmentCount = 1;
+    subpasses[1].pColorAttachments = &swapchain_ref;
+    subpasses[1].inputAttachmentCount = static_cast<uint32_t>(input_refs.size());
+    subpasses[1].pInputAttachments = input_refs.data();
+
+    // Dependencies
+    std::array<VkSubpassDependency, 3> dependencies{};
+
+    // Previous frame's lighting reads before this frame's G-buffer writes
+    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass = 0;
+    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                                   VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    dependencies[0].srcAccessMask = 0;
+    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+    // Swapchain image acquire (the submit waits at color attachment output)
+    dependencies[1].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[1].dstSubpass = 1;
+    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].srcAccessMask = 0;
+    dependencies[1].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    // G-buffer writes -> same-pixel input attachment reads, stays in tile memory
+    dependencies[2].srcSubpass = 0;
+    dependencies[2].dstSubpass = 1;
+    dependencies[2].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                                   VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[2].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    dependencies[2].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[2].dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+    dependencies[2].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+    VkRenderPassCreateInfo render_pass_info{};
+    render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    render_pass_info.attachmentCount = static_cast<uint32_t>(attachments.size());
+    render_pass_info.pAttachments = attachments.data();
+    render_pass_info.subpassCount = static_cast<uint32_t>(subpasses.size());
+    render_pass_info.pSubpasses = subpasses.data();
+    render_pass_info.dependencyCount = static_cast<uint32_t>(dependencies.size());
+    render_pass_info.pDependencies = dependencies.data();
+
+    return vkCreateRenderPass(context_->device(), &render_pass_info, nullptr, &render_pass_) == VK_SUCCESS;
+}
+
 bool GBuffer::create_framebuffer() {
-    std::array<VkImageView, 5> attachments = {
-        position_.view,
+    if (subpass_lighting_) {
+        // One framebuffer per swapchain image, G-buffer attachments shared
+        const auto& swapchain_views = context_->swapchain_image_views();
+        swapchain_framebuffers_.resize(swapchain_views.size(), VK_NULL_HANDLE);
+
+        for (size_t i = 0; i < swapchain_views.size(); i++) {
+            std::array<VkImageView, 4> attachments = {
+                swapchain_views[i],
+                normal_.view,
+                albedo_.view,
+                depth_.view
+            };
+
+            VkFramebufferCreateInfo fb_info{};
+            fb_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            fb_info.renderPass = render_pass_;
+            fb_info.attachmentCount = static_cast<uint32_t>(attachments.size());
+            fb_info.pAttachments = attachments.data();
+            fb_info.width = width_;
+            fb_info.height = height_;
+            fb_info.layers = 1;
+
+            if (vkCreateFramebuffer(context_->device(), &fb_info, nullptr,
+                    &swapchain_framebuffers_[i]) != VK_SUCCESS) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::array<VkImageView, 3> attachments = {
         normal_.view,
         albedo_.view,
-        material_.view,
         depth_.view
     };
 
@@ -350,6 +448,30 @@ bool GBuffer::create_framebuffer() {
     return vkCreateFramebuffer(context_->device(), &fb_info, nullptr, &framebuffer_) == VK_SUCCESS;
 }
 
+void GBuffer::destroy_framebuffers() {
+    if (framebuffer_) {
+        vkDestroyFramebuffer(context_->device(), framebuffer_, nullptr);
+        framebuffer_ = VK_NULL_HANDLE;
+    }
+
+    for (VkFramebuffer fb : swapchain_framebuffers_) {
+        if (fb) {
+            vkDestroyFramebuffer(context_->device(), fb, nullptr);
+        }
+    }
+    swapchain_framebuffers_.clear();
+}
+
+uint64_t GBuffer::external_bytes_per_frame() const {
+    if (subpass_lighting_) {
+        return 0;  // Cleared, written and consumed in tile memory
+    }
+
+    // Every attachment is stored by the geometry pass and loaded again for lighting
+    const uint64_t bytes_per_pixel = 8 + 4 + 4;  // RGBA16F + RGBA8 + D32F
+    return static_cast<uint64_t>(width_) * height_ * bytes_per_pixel * 2;
+}
+
 bool GBuffer::create_sampler() {
     VkSamplerCreateInfo sampler_info{};
     sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -370,10 +492,6 @@ bool GBuffer::create_sampler() {
     return vkCreateSampler(context_->device(), &sampler_info, nullptr, &sampler_) == VK_SUCCESS;
 }
 
-VkDescriptorImageInfo GBuffer::position_descriptor() const {
-    return {sampler_, position_.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
-}
-
 VkDescriptorImageInfo GBuffer::normal_descriptor() const {
     return {sampler_, normal_.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
 }
@@ -382,10 +500,6 @@ VkDescriptorImageInfo GBuffer::albedo_descriptor() const {
     return {sampler_, albedo_.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
 }
 
-VkDescriptorImageInfo GBuffer::material_descriptor() const {
-    return {sampler_, material_.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
-}
-
 VkDescriptorImageInfo GBuffer::depth_descriptor() const {
     return {sampler_, depth_.view, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
 }
@@ -2,10 +2,16 @@
  * Slam Engine - G-Buffer System
  *
  * Multiple render targets for deferred shading:
- * - Position (RGB16F)
- * - Normal (RGB16F)
+ * - Normal + Material (RGBA16F: octahedral normal, roughness, metallic)
  * - Albedo (RGBA8)
- * - Material (RG8: roughness, metallic)
+ * - Depth (D32F, also used to reconstruct world position)
+ *
+ * 16 bytes per pixel including depth (was 26 with a separate position target).
+ *
+ * In subpass mode the render pass has two subpasses (G-buffer, then lighting
+ * into the swapchain image) and the attachments are transient input
+ * attachments backed by lazily allocated memory where available, so on tile
+ * based GPUs the G-buffer never leaves on-chip memory.
  */
 
 #pragma once
@@ -33,8 +39,10 @@ public:
     GBuffer(const GBuffer&) = delete;
     GBuffer& operator=(const GBuffer&) = delete;
 
-    // Initialize G-buffer with given dimensions
-    bool init(VulkanContext& context, uint32_t width, uint32_t height);
+    // Initialize G-buffer with given dimensions. With subpass_lighting the size
+    // must match the swapchain extent, since the swapchain image is attachment 0.
+    bool init(VulkanContext& context, uint32_t width, uint32_t height,
+              bool subpass_lighting = false);
 
     // Cleanup
     void destroy();
@@ -45,47 +53,54 @@ public:
     // Getters
     VkRenderPass render_pass() const { return render_pass_; }
     VkFramebuffer framebuffer() const { return framebuffer_; }
+    VkFramebuffer framebuffer(uint32_t image_index) const { return swapchain_framebuffers_[image_index]; }
     uint32_t width() const { return width_; }
     uint32_t height() const { return height_; }
+    bool subpass_lighting() const { return subpass_lighting_; }
+    bool lazily_allocated() const { return lazily_allocated_; }
+
+    // G-buffer bytes that travel to/from external memory per frame
+    // (stores in the geometry pass plus loads in the lighting pass)
+    uint64_t external_bytes_per_frame() const;
 
     // Attachment access
-    const GBufferAttachment& position() const { return position_; }
     const GBufferAttachment& normal() const { return normal_; }
     const GBufferAttachment& albedo() const { return albedo_; }
-    const GBufferAttachment& material() const { return material_; }
     const GBufferAttachment& depth() const { return depth_; }
 
     // Descriptor info for lighting pass
-    VkDescriptorImageInfo position_descriptor() const;
     VkDescriptorImageInfo normal_descriptor() const;
     VkDescriptorImageInfo albedo_descriptor() const;
-    VkDescriptorImageInfo material_descriptor() const;
     VkDescriptorImageInfo depth_descriptor() const;
 
     // Sampler for all attachments
     VkSampler sampler() const { return sampler_; }
 
 private:
+    bool create_attachments();
     bool create_attachment(GBufferAttachment& attachment, VkFormat format,
                           VkImageUsageFlags usage, VkImageAspectFlags aspect);
     void destroy_attachment(GBufferAttachment& attachment);
     bool create_render_pass();
+    bool create_subpass_render_pass();
     bool create_framebuffer();
+    void destroy_framebuffers();
     bool create_sampler();
 
     VulkanContext* context_ = nullptr;
     uint32_t width_ = 0;
     uint32_t height_ = 0;
+    bool subpass_lighting_ = false;
+    bool lazily_allocated_ = false;
 
     // Attachments
-    GBufferAttachment position_;   // RGB16F - world position
-    GBufferAttachment normal_;     // RGB16F - world normal
+    GBufferAttachment normal_;     // RGBA16F - octahedral normal, roughness, metallic
     GBufferAttachment albedo_;     // RGBA8 - base color + AO
-    GBufferAttachment material_;   // RG8 - roughness, metallic
     GBufferAttachment depth_;      // D32F - depth buffer
 
     VkRenderPass render_pass_ = VK_NULL_HANDLE;
     VkFramebuffer framebuffer_ = VK_NULL_HANDLE;
+    std::vector<VkFramebuffer> swapchain_framebuffers_;  // Subpass mode, one per swapchain image
     VkSampler sampler_ = VK_NULL_HANDLE;
 };
 
@@ -0,0 +1,265 @@
+/**
+ * Slam Engine - GPU Profiler Implementation
+ */
+
+#include "gpu_profiler.h"
+#include "vulkan_context.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace slam {
+
+GpuProfiler::~GpuProfiler() {
+    destroy();
+}
+
+bool GpuProfiler::init(VulkanContext& context, uint32_t frames_in_flight) {
+    context_ = &context;
+
+    // Timestamps need a non-zero valid bit count on the queue we record on
+    uint32_t family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(context.physical_device(), &family_count, nullptr);
+    std::vector<VkQueueFamilyProperties> families(family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(context.physical_device(), &family_count, families.data());
+
+    uint32_t valid_bits = families[context.graphics_queue_family()].timestampValidBits;
+    if (valid_bits == 0) {
+        printf("GPU profiler: timestamps not supported on graphics queue, disabled\n");
+        return true;
+    }
+    timestamp_mask_ = valid_bits >= 64 ? ~0ull : ((1ull << valid_bits) - 1);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(context.physical_device(), &properties);
+    timestamp_period_ns_ = static_cast<double>(properties.limits.timestampPeriod);
+
+    VkQueryPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    pool_info.queryCount = GPU_PROFILER_MAX_SCOPES * 2;
+
+    frames_.resize(frames_in_flight);
+    for (FrameQueries& frame : frames_) {
+        if (vkCreateQueryPool(context.device(), &pool_info, nullptr, &frame.pool) != VK_SUCCESS) {
+            fprintf(stderr, "Failed to create timestamp query pool\n");
+            return false;
+        }
+        frame.scopes.reserve(GPU_PROFILER_MAX_SCOPES);
+    }
+
+    results_.resize(GPU_PROFILER_MAX_SCOPES * 2 * 2);
+    samples_.reserve(GPU_PROFILER_MAX_SCOPES);
+    history_.reserve(GPU_PROFILER_MAX_SCOPES);
+    enabled_ = true;
+
+    printf("GPU profiler: %u-bit timestamps, %.2f ns/tick\n", valid_bits, timestamp_period_ns_);
+    return true;
+}
+
+void GpuProfiler::destroy() {
+    if (!context_ || !context_->device()) return;
+
+    for (FrameQueries& frame : frames_) {
+        if (frame.pool) {
+            vkDestroyQueryPool(context_->device(), frame.pool, nullptr);
+        }
+    }
+    frames_.clear();
+    history_.clear();
+    current_ = nullptr;
+    enabled_ = false;
+    context_ = nullptr;
+}
+
+void GpuProfiler::begin_frame(VkCommandBuffer cmd, uint32_t frame_index) {
+    if (!enabled_) return;
+
+    current_ = &frames_[frame_index];
+    collect(*current_);
+
+    vkCmdResetQueryPool(cmd, current_->pool, 0, GPU_PROFILER_MAX_SCOPES * 2);
+    current_->scopes.clear();
+    current_->query_count = 0;
+    current_->frame_number = frame_number_++;
+    depth_ = 0;
+
+    frame_scope_ = begin_scope(cmd, "frame");
+}
+
+void GpuProfiler::end_frame(VkCommandBuffer cmd) {
+    if (!enabled_ || !current_) return;
+
+    end_scope(cmd, frame_scope_);
+    frame_scope_ = GPU_PROFILER_INVALID_SCOPE;
+    current_ = nullptr;
+}
+
+uint32_t GpuProfiler::begin_scope(VkCommandBuffer cmd, const char* name) {
+    if (!enabled_ || !current_ || current_->scopes.size() >= GPU_PROFILER_MAX_SCOPES) {
+        return GPU_PROFILER_INVALID_SCOPE;
+    }
+
+    PendingScope scope{name, depth_, current_->query_count++, GPU_PROFILER_INVALID_SCOPE};
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, current_->pool, scope.begin_query);
+
+    current_->scopes.push_back(scope);
+    depth_++;
+    return static_cast<uint32_t>(current_->scopes.size() - 1);
+}
+
+void GpuProfiler::end_scope(VkCommandBuffer cmd, uint32_t scope) {
+    if (scope == GPU_PROFILER_INVALID_SCOPE || !current_) return;
+
+    PendingScope& pending = current_->scopes[scope];
+    pending.end_query = current_->query_count++;
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, current_->pool, pending.end_query);
+    depth_--;
+}
+
+void GpuProfiler::flush() {
+    if (!enabled_) return;
+
+    // Oldest first, so callbacks see frames in order
+    std::vector<FrameQueries*> pending;
+    for (FrameQueries& frame : frames_) {
+        if (frame.query_count > 0) {
+            pending.push_back(&frame);
+        }
+    }
+    std::sort(pending.begin(), pending.end(), [](const FrameQueries* a, const FrameQueries* b) {
+        return a->frame_number < b->frame_number;
+    });
+
+    for (FrameQueries* frame : pending) {
+        collect(*frame);
+        frame->query_count = 0;
+        frame->scopes.clear();
+    }
+}
+
+void GpuProfiler::collect(FrameQueries& frame) {
+    if (frame.query_count == 0) return;
+
+    // The frame's fence has been waited on, so this does not block; the
+    // availability word guards against scopes that were never submitted
+    vkGetQueryPoolResults(context_->device(), frame.pool, 0, frame.query_count,
+                          frame.query_count * 2 * sizeof(uint64_t), results_.data(),
+                          2 * sizeof(uint64_t),
+                          VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+    samples_.clear();
+    for (const PendingScope& scope : frame.scopes) {
+        if (scope.end_query == GPU_PROFILER_INVALID_SCOPE) continue;
+
+        const uint64_t* begin = &results_[scope.begin_query * 2];
+        const uint64_t* end = &results_[scope.end_query * 2];
+        if (!begin[1] || !end[1]) continue;
+
+        uint64_t ticks = (end[0] - begin[0]) & timestamp_mask_;
+        double ms = static_cast<double>(ticks) * timestamp_period_ns_ / 1000000.0;
+
+        ScopeHistory& history = history_for(scope.name, scope.depth);
+        history.samples[history.next] = static_cast<float>(ms);
+        history.next = (history.next + 1) % GPU_PROFILER_HISTORY;
+        history.count = std::min(history.count + 1, GPU_PROFILER_HISTORY);
+
+        samples_.push_back({scope.name, scope.depth, ms});
+        if (scope.depth == 0) {
+            last_frame_ms_ = ms;
+        }
+    }
+
+    if (results_callback_) {
+        results_callback_(frame.frame_number, samples_);
+    }
+}
+
+GpuProfiler::ScopeHistory& GpuProfiler::history_for(const char* name, uint32_t depth) {
+    for (ScopeHistory& history : history_) {
+        if (history.depth == depth && history.name == name) {
+            return history;
+        }
+    }
+
+    history_.push_back(ScopeHistory{});
+    history_.back().name = name;
+    history_.back().depth = depth;
+    return history_.back();
+}
+
+GpuScopeStats GpuProfiler::stats_for(const ScopeHistory& history) const {
+    GpuScopeStats stats;
+    stats.name = history.name.c_str();
+    stats.depth = history.depth;
+    if (history.count == 0) return stats;
+
+    uint32_t last = (history.next + GPU_PROFILER_HISTORY - 1) % GPU_PROFILER_HISTORY;
+    stats.last_ms = history.samples[last];
+
+    std::array<float, GPU_PROFILER_HISTORY> sorted;
+    double sum = 0.0;
+    for (uint32_t i = 0; i < history.count; i++) {
+        sorted[i] = history.samples[i];
+        sum += history.samples[i];
+    }
+    std::sort(sorted.begin(), sorted.begin() + history.count);
+
+    auto percentile = [&](double p) {
+        uint32_t index = static_cast<uint32_t>(p * (history.count - 1) + 0.5);
+        return static_cast<double>(sorted[index]);
+    };
+
+    stats.average_ms = sum / history.count;
+    stats.p50_ms = percentile(0.50);
+    stats.p95_ms = percentile(0.95);
+    stats.p99_ms = percentile(0.99);
+    return stats;
+}
+
+void GpuProfiler::compute_stats(std::vector<GpuScopeStats>& stats) const {
+    stats.clear();
+    for (const ScopeHistory& history : history_) {
+        stats.push_back(stats_for(history));
+    }
+}
+
+double GpuProfiler::frame_ms() const {
+    for (const ScopeHistory& history : history_) {
+        if (history.depth == 0 && history.name == "frame") {
+            return stats_for(history).average_ms;
+        }
+    }
+    return 0.0;
+}
+
+void GpuProfiler::print_summary() const {
+    if (!enabled_ || history_.empty()) return;
+
+    printf("GPU: %.2fms", frame_ms());
+    for (const ScopeHistory& history : history_) {
+        if (history.depth != 1) continue;
+        printf(" | %s %.2f", history.name.c_str(), stats_for(history).average_ms);
+    }
+    printf("\n");
+}
+
+void GpuProfiler::print_report() const {
+    if (!enabled_) {
+        printf("GPU profiler disabled\n");
+        return;
+    }
+
+    printf("GPU timings over last %u frames (ms):\n", GPU_PROFILER_HISTORY);
+    printf("  %-24s %8s %8s %8s %8s %8s\n", "scope", "last", "avg", "p50", "p95", "p99");
+    for (const ScopeHistory& history : history_) {
+        GpuScopeStats stats = stats_for(history);
+
+        char label[64];
+        snprintf(label, sizeof(label), "%*s%s", static_cast<int>(stats.depth * 2), "", stats.name);
+        printf("  %-24s %8.3f %8.3f %8.3f %8.3f %8.3f\n", label,
+            stats.last_ms, stats.average_ms, stats.p50_ms, stats.p95_ms, stats.p99_ms);
+    }
+}
+
+} // namespace slam
@@ -0,0 +1,164 @@
+/**
+ * Slam Engine - GPU Profiler
+ *
+ * Timestamp queries around named scopes, one query pool per frame in flight.
+ * Results for a frame slot are read when that slot comes around again (after
+ * its fence wait), so reading never stalls. Each scope keeps a short history
+ * for rolling averages and percentiles.
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace slam {
+
+class VulkanContext;
+
+constexpr uint32_t GPU_PROFILER_MAX_SCOPES = 64;    // Per frame
+constexpr uint32_t GPU_PROFILER_HISTORY = 128;      // Samples kept per scope
+constexpr uint32_t GPU_PROFILER_INVALID_SCOPE = UINT32_MAX;
+
+// One scope's time in one frame
+struct GpuScopeSample {
+    const char* name;
+    uint32_t depth;
+    double ms;
+};
+
+// Timing summary for one scope (milliseconds)
+struct GpuScopeStats {
+    const char* name = "";
+    uint32_t depth = 0;
+    double last_ms = 0.0;
+    double average_ms = 0.0;
+    double p50_ms = 0.0;
+    double p95_ms = 0.0;
+    double p99_ms = 0.0;
+};
+
+class GpuProfiler {
+public:
+    // Receives each frame's samples once they are read back
+    using ResultsCallback = std::function<void(uint64_t frame_number,
+                                               const std::vector<GpuScopeSample>& samples)>;
+
+    GpuProfiler() = default;
+    ~GpuProfiler();
+
+    // Non-copyable
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    // Initialize query pools. Returns true (profiler disabled) if the queue
+    // does not support timestamps.
+    bool init(VulkanContext& context, uint32_t frames_in_flight);
+
+    // Cleanup
+    void destroy();
+
+    bool enabled() const { return enabled_; }
+
+    // Frame boundaries (called by VulkanContext). begin_frame collects the
+    // previous results of this frame slot, whose fence has already been
+    // waited on, then resets its queries.
+    void begin_frame(VkCommandBuffer cmd, uint32_t frame_index);
+    void end_frame(VkCommandBuffer cmd);
+
+    // Named scopes. name must outlive the profiler (string literal or a
+    // string owned by the caller).
+    uint32_t begin_scope(VkCommandBuffer cmd, const char* name);
+    void end_scope(VkCommandBuffer cmd, uint32_t scope);
+
+    // Per-frame results (e.g. for benchmark logs)
+    void set_results_callback(ResultsCallback callback) { results_callback_ = std::move(callback); }
+
+    // Read back every outstanding frame. Only call once the device is idle.
+    void flush();
+
+    // Frames begun so far; frame_number in callbacks counts from 0
+    uint64_t frame_count() const { return frame_number_; }
+
+    // Statistics over the recorded history, in first-seen order
+    void compute_stats(std::vector<GpuScopeStats>& stats) const;
+
+    // Average GPU frame time (ms) over the history
+    double frame_ms() const;
+
+    // Most recently read back GPU frame time (ms), a few frames behind
+    double last_frame_ms() const { return last_frame_ms_; }
+
+    // One line of top-level scopes, for the FPS log
+    void print_summary() const;
+
+    // Full per-scope table with percentiles
+    void print_report() const;
+
+private:
+    struct PendingScope {
+        const char* name;
+        uint32_t depth;
+        uint32_t begin_query;
+        uint32_t end_query;
+    };
+
+    struct FrameQueries {
+        VkQueryPool pool = VK_NULL_HANDLE;
+        std::vector<PendingScope> scopes;
+        uint32_t query_count = 0;
+        uint64_t frame_number = 0;
+    };
+
+    struct ScopeHistory {
+        std::string name;
+        uint32_t depth = 0;
+        std::array<float, GPU_PROFILER_HISTORY> samples{};
+        uint32_t count = 0;
+        uint32_t next = 0;
+    };
+
+    void collect(FrameQueries& frame);
+    ScopeHistory& history_for(const char* name, uint32_t depth);
+    GpuScopeStats stats_for(const ScopeHistory& history) const;
+
+    VulkanContext* context_ = nullptr;
+    bool enabled_ = false;
+    double timestamp_period_ns_ = 1.0;
+    uint64_t timestamp_mask_ = ~0ull;
+
+    std::vector<FrameQueries> frames_;
+    FrameQueries* current_ = nullptr;
+    uint32_t depth_ = 0;
+    uint32_t frame_scope_ = GPU_PROFILER_INVALID_SCOPE;
+    uint64_t frame_number_ = 0;
+    double last_frame_ms_ = 0.0;
+
+    std::vector<ScopeHistory> history_;
+    std::vector<uint64_t> results_;  // Readback scratch (value, availability pairs)
+    std::vector<GpuScopeSample> samples_;
+    ResultsCallback results_callback_;
+};
+
+// Scope helper: begin on construction, end on destruction
+class GpuScope {
+public:
+    GpuScope(GpuProfiler& profiler, VkCommandBuffer cmd, const char* name)
+        : profiler_(profiler), cmd_(cmd), scope_(profiler.begin_scope(cmd, name)) {}
+    ~GpuScope() { profiler_.end_scope(cmd_, scope_); }
+
+    // Non-copyable
+    GpuScope(const GpuScope&) = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+
+private:
+    GpuProfiler& profiler_;
+    VkCommandBuffer cmd_;
+    uint32_t scope_;
+};
+
+} // namespace slam
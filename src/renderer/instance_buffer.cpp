@@ -0,0 +1,85 @@
+/**
+ * Slam Engine - Instance Buffer Implementation
+ */
+
+#include "instance_buffer.h"
+#include "vulkan_context.h"
+
+namespace slam {
+
+InstanceBuffer::~InstanceBuffer() {
+    destroy();
+}
+
+bool InstanceBuffer::upload(VulkanContext& context, const std::vector<Transform>& transforms) {
+    // Earlier frames may still be reading the old buffer
+    if (buffer_) {
+        context.wait_idle();
+    }
+    destroy();
+
+    context_ = &context;
+    count_ = static_cast<uint32_t>(transforms.size());
+    if (count_ == 0) {
+        return true;
+    }
+
+    VkDeviceSize size = sizeof(mat3x4) * transforms.size();
+
+    VkBuffer staging_buffer;
+    VkDeviceMemory staging_memory;
+    context.create_buffer(size,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        staging_buffer, staging_memory, ResourceCategory::Staging);
+
+    void* data;
+    vkMapMemory(context.device(), staging_memory, 0, size, 0, &data);
+    mat3x4* rows = static_cast<mat3x4*>(data);
+    for (size_t i = 0; i < transforms.size(); i++) {
+        rows[i] = transforms[i].to_mat3x4();
+    }
+    vkUnmapMemory(context.device(), staging_memory);
+
+    context.create_buffer(size,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        buffer_, memory_, ResourceCategory::Instances);
+
+    context.copy_buffer(staging_buffer, buffer_, size);
+
+    vkDestroyBuffer(context.device(), staging_buffer, nullptr);
+    context.free_memory(staging_memory);
+    return true;
+}
+
+void InstanceBuffer::destroy() {
+    if (context_ && context_->device()) {
+        if (buffer_) {
+            vkDestroyBuffer(context_->device(), buffer_, nullptr);
+            buffer_ = VK_NULL_HANDLE;
+        }
+        context_->free_memory(memory_);
+    }
+    count_ = 0;
+    context_ = nullptr;
+}
+
+VkVertexInputBindingDescription InstanceBuffer::binding_description() {
+    VkVertexInputBindingDescription binding{};
+    binding.binding = INSTANCE_BINDING;
+    binding.stride = sizeof(mat3x4);
+    binding.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+    return binding;
+}
+
+void InstanceBuffer::attribute_descriptions(uint32_t first_location,
+                                            std::vector<VkVertexInputAttributeDescription>& attributes) {
+    // One vec4 location per matrix row; the shader restores the (0, 0, 0, 1) row
+    for (uint32_t row = 0; row < 3; row++) {
+        attributes.push_back({first_location + row, INSTANCE_BINDING, VK_FORMAT_R32G32B32A32_SFLOAT,
+                              static_cast<uint32_t>(sizeof(vec4) * row)});
+    }
+}
+
+} // namespace slam
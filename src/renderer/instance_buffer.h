@@ -0,0 +1,56 @@
+/**
+ * Slam Engine - Instance Buffer
+ *
+ * Device-local per-instance model transforms for instanced draws, bound as
+ * vertex binding 1. Each instance is the top three rows of its affine
+ * matrix (mat3x4, three vec4 attributes): 48 bytes instead of a mat4's 64,
+ * since the bottom row is always (0, 0, 0, 1). Meant for
+ * static placements: upload() recreates the buffer and waits for the device,
+ * so call it at load time or when the placements actually change.
+ */
+
+#pragma once
+
+#include "utils/math.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+namespace slam {
+
+class VulkanContext;
+
+// Vertex binding used for per-instance data in instanced pipelines
+constexpr uint32_t INSTANCE_BINDING = 1;
+
+class InstanceBuffer {
+public:
+    InstanceBuffer() = default;
+    ~InstanceBuffer();
+
+    // Non-copyable
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+    // Replace the contents (waits for the device if a buffer already exists)
+    bool upload(VulkanContext& context, const std::vector<Transform>& transforms);
+
+    // Cleanup
+    void destroy();
+
+    VkBuffer buffer() const { return buffer_; }
+    uint32_t count() const { return count_; }
+
+    // Binding and attribute descriptions (locations first_location..+2)
+    static VkVertexInputBindingDescription binding_description();
+    static void attribute_descriptions(uint32_t first_location,
+                                       std::vector<VkVertexInputAttributeDescription>& attributes);
+
+private:
+    VulkanContext* context_ = nullptr;
+    VkBuffer buffer_ = VK_NULL_HANDLE;
+    VkDeviceMemory memory_ = VK_NULL_HANDLE;
+    uint32_t count_ = 0;
+};
+
+} // namespace slam
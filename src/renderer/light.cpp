@@ -4,6 +4,7 @@
 
 #include "light.h"
 #include "vulkan_context.h"
+#include "utils/batch_math.h"
 #include <algorithm>
 #include <cstring>
 #include <cstdio>
@@ -34,10 +35,7 @@ void LightManager::destroy() {
         vkDestroyBuffer(device, light_buffer_, nullptr);
         light_buffer_ = VK_NULL_HANDLE;
     }
-    if (light_memory_) {
-        vkFreeMemory(device, light_memory_, nullptr);
-        light_memory_ = VK_NULL_HANDLE;
-    }
+    context_->free_memory(light_memory_);
 
     // Unmap and destroy uniform buffer
     if (mapped_uniforms_) {
@@ -48,10 +46,7 @@ void LightManager::destroy() {
         vkDestroyBuffer(device, uniform_buffer_, nullptr);
         uniform_buffer_ = VK_NULL_HANDLE;
     }
-    if (uniform_memory_) {
-        vkFreeMemory(device, uniform_memory_, nullptr);
-        uniform_memory_ = VK_NULL_HANDLE;
-    }
+    context_->free_memory(uniform_memory_);
 
     // Unmap and destroy cluster buffer
     if (mapped_clusters_) {
@@ -62,10 +57,7 @@ void LightManager::destroy() {
         vkDestroyBuffer(device, cluster_buffer_, nullptr);
         cluster_buffer_ = VK_NULL_HANDLE;
     }
-    if (cluster_memory_) {
-        vkFreeMemory(device, cluster_memory_, nullptr);
-        cluster_memory_ = VK_NULL_HANDLE;
-    }
+    context_->free_memory(cluster_memory_);
 
     // Unmap and destroy light index buffer
     if (mapped_light_indices_) {
@@ -76,10 +68,7 @@ void LightManager::destroy() {
         vkDestroyBuffer(device, light_index_buffer_, nullptr);
         light_index_buffer_ = VK_NULL_HANDLE;
     }
-    if (light_index_memory_) {
-        vkFreeMemory(device, light_index_memory_, nullptr);
-        light_index_memory_ = VK_NULL_HANDLE;
-    }
+    context_->free_memory(light_index_memory_);
 
     lights_.clear();
     context_ = nullptr;
@@ -93,7 +82,7 @@ bool LightManager::create_buffers() {
     VkDeviceSize light_size = sizeof(PointLight) * MAX_POINT_LIGHTS;
     context_->create_buffer(light_size,
         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-        memory_props, light_buffer_, light_memory_);
+        memory_props, light_buffer_, light_memory_, ResourceCategory::Lights);
 
     vkMapMemory(context_->device(), light_memory_, 0, light_size, 0,
                 reinterpret_cast<void**>(&mapped_lights_));
@@ -102,7 +91,7 @@ bool LightManager::create_buffers() {
     VkDeviceSize uniform_size = sizeof(LightUniforms);
     context_->create_buffer(uniform_size,
         VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-        memory_props, uniform_buffer_, uniform_memory_);
+        memory_props, uniform_buffer_, uniform_memory_, ResourceCategory::Lights);
 
     vkMapMemory(context_->device(), uniform_memory_, 0, uniform_size, 0,
                 reinterpret_cast<void**>(&mapped_uniforms_));
@@ -111,7 +100,7 @@ bool LightManager::create_buffers() {
     VkDeviceSize cluster_size = sizeof(LightCluster) * TOTAL_CLUSTERS;
     context_->create_buffer(cluster_size,
         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-        memory_props, cluster_buffer_, cluster_memory_);
+        memory_props, cluster_buffer_, cluster_memory_, ResourceCategory::Lights);
 
     vkMapMemory(context_->device(), cluster_memory_, 0, cluster_size, 0,
                 reinterpret_cast<void**>(&mapped_clusters_));
@@ -120,7 +109,7 @@ bool LightManager::create_buffers() {
     VkDeviceSize index_size = sizeof(uint32_t) * TOTAL_CLUSTERS * MAX_LIGHTS_PER_CLUSTER;
     context_->create_buffer(index_size,
         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-        memory_props, light_index_buffer_, light_index_memory_);
+        memory_props, light_index_buffer_, light_index_memory_, ResourceCategory::Lights);
 
     vkMapMemory(context_->device(), light_index_memory_, 0, index_size, 0,
                 reinterpret_cast<void**>(&mapped_light_indices_));
@@ -147,6 +136,11 @@ void LightManager::clear_lights() {
     lights_.clear();
 }
 
+void LightManager::set_lights(const std::vector<PointLight>& lights) {
+    size_t count = std::min(lights.size(), static_cast<size_t>(MAX_POINT_LIGHTS));
+    lights_.assign(lights.begin(), lights.begin() + count);
+}
+
 void LightManager::set_light_position(int index, const vec3& position) {
     if (index >= 0 && index < static_cast<int>(lights_.size())) {
         lights_[index].position = position;
@@ -204,6 +198,24 @@ void LightManager::update_clusters(const mat4& view, const mat4& projection,
 
     uint32_t total_indices = 0;
 
+    // Light spheres in view space, once per frame rather than once per
+    // cluster; SoA so each cluster tests BATCH_WIDTH lights at a time
+    FrameAllocator& frame = context_->frame_allocator();
+    SpheresSoA view_lights = SpheresSoA::allocate(frame, lights_.size());
+    for (size_t i = 0; i < lights_.size(); i++) {
+        view_lights.set(i, lights_[i].position, lights_[i].radius);
+    }
+    transform_spheres(view, view_lights, view_lights);
+
+    // Exponential depth slices (matching the shader's log lookup), once per
+    // slice rather than twice per cluster
+    float slice_depths[CLUSTER_Z + 1];
+    for (uint32_t z = 0; z <= CLUSTER_Z; z++) {
+        slice_depths[z] = near_plane * std::pow(far_plane / near_plane, float(z) / CLUSTER_Z);
+    }
+    float aspect = std::abs(projection.data()[5] / projection.data()[0]);
+    float tan_half_fov = 1.0f / projection.data()[5];
+
     // For each cluster, find intersecting lights
     for (uint32_t z = 0; z < CLUSTER_Z; z++) {
         for (uint32_t y = 0; y < CLUSTER_Y; y++) {
@@ -211,9 +223,8 @@ void LightManager::update_clusters(const mat4& view, const mat4& projection,
                 uint32_t cluster_idx = x + y * CLUSTER_X + z * CLUSTER_X * CLUSTER_Y;
 
                 // Calculate cluster bounds in view space
-                // Using exponential depth slicing for better distribution
-                float z_near = near_plane * std::pow(far_plane / near_plane, float(z) / CLUSTER_Z);
-                float z_far = near_plane * std::pow(far_plane / near_plane, float(z + 1) / CLUSTER_Z);
+                float z_near = slice_depths[z];
+                float z_far = slice_depths[z + 1];
 
                 // Cluster bounds in NDC
                 float ndc_x_min = (float(x) / CLUSTER_X) * 2.0f - 1.0f;
@@ -223,9 +234,6 @@ void LightManager::update_clusters(const mat4& view, const mat4& projection,
 
                 // Simple AABB in view space for culling
                 // Calculate view-space corners of cluster frustum
-                float aspect = std::abs(projection.data()[5] / projection.data()[0]);
-                float tan_half_fov = 1.0f / projection.data()[5];
-
                 vec3 cluster_min(
                     ndc_x_min * z_far * tan_half_fov * aspect,
                     ndc_y_min * z_far * tan_half_fov,
@@ -242,41 +250,10 @@ void LightManager::update_clusters(const mat4& view, const mat4& projection,
                 if (cluster_min.y > cluster_max.y) std::swap(cluster_min.y, cluster_max.y);
                 if (cluster_min.z > cluster_max.z) std::swap(cluster_min.z, cluster_max.z);
 
-                // Set cluster offset
+                // Lights touching the cluster, in index order
                 mapped_clusters_[cluster_idx].offset = total_indices;
-                uint32_t count = 0;
-
-                // Test each light against cluster bounds
-                for (size_t i = 0; i < lights_.size() && count < MAX_LIGHTS_PER_CLUSTER; i++) {
-                    // Transform light to view space
-                    vec4 light_pos_view = view * vec4(lights_[i].position, 1.0f);
-                    vec3 light_view(light_pos_view.x, light_pos_view.y, light_pos_view.z);
-                    float radius = lights_[i].radius;
-
-                    // Sphere-AABB intersection test
-                    float dist_sq = 0.0f;
-
-                    if (light_view.x < cluster_min.x)
-                        dist_sq += (cluster_min.x - light_view.x) * (cluster_min.x - light_view.x);
-                    else if (light_view.x > cluster_max.x)
-                        dist_sq += (light_view.x - cluster_max.x) * (light_view.x - cluster_max.x);
-
-                    if (light_view.y < cluster_min.y)
-                        dist_sq += (cluster_min.y - light_view.y) * (cluster_min.y - light_view.y);
-                    else if (light_view.y > cluster_max.y)
-                        dist_sq += (light_view.y - cluster_max.y) * (light_view.y - cluster_max.y);
-
-                    if (light_view.z < cluster_min.z)
-                        dist_sq += (cluster_min.z - light_view.z) * (cluster_min.z - light_view.z);
-                    else if (light_view.z > cluster_max.z)
-                        dist_sq += (light_view.z - cluster_max.z) * (light_view.z - cluster_max.z);
-
-                    if (dist_sq <= radius * radius) {
-                        // Light intersects cluster
-                        mapped_light_indices_[total_indices + count] = static_cast<uint32_t>(i);
-                        count++;
-                    }
-                }
+                uint32_t count = spheres_touching_aabb(view_lights, cluster_min, cluster_max,
+                    mapped_light_indices_ + total_indices, MAX_LIGHTS_PER_CLUSTER);
 
                 mapped_clusters_[cluster_idx].count = count;
                 total_indices += count;
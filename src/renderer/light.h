@@ -70,6 +70,10 @@ public:
     void remove_light(int index);
     void clear_lights();
 
+    // Replace every light (e.g. with a render packet's copy); extra lights
+    // beyond MAX_POINT_LIGHTS are dropped
+    void set_lights(const std::vector<PointLight>& lights);
+
     // Update light data
     void set_light_position(int index, const vec3& position);
     void set_light_color(int index, const vec3& color);
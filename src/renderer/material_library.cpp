@@ -0,0 +1,359 @@
+/**
+ * Slam Engine - Material Library Implementation
+ */
+
+#include "material_library.h"
+#include "texture_loader.h"
+#include "vulkan_context.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+namespace slam {
+
+MaterialLibrary::~MaterialLibrary() {
+    destroy();
+}
+
+bool MaterialLibrary::init(VulkanContext& context) {
+    context_ = &context;
+    VkDevice device = context.device();
+    uint32_t frame_count = context.max_frames_in_flight();
+
+    // gbuffer.frag indexes one texture array per draw; the spec only
+    // guarantees 16 sampled images per stage and 96 per set, so the array
+    // shrinks to fit. Without dynamic indexing, each material gets its own
+    // set with fixed slots (gbuffer_bound.frag).
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(context.physical_device(), &properties);
+    const VkPhysicalDeviceLimits& limits = properties.limits;
+    bound_per_material_ = !context.supports_sampled_image_indexing();
+    if (bound_per_material_) {
+        texture_capacity_ = MATERIAL_MAPS;
+        printf("Material library: no dynamic texture indexing, binding one set per material\n");
+    } else {
+        texture_capacity_ = std::min({MATERIAL_MAX_TEXTURES, limits.maxPerStageDescriptorSampledImages,
+                                      limits.maxDescriptorSetSampledImages});
+        if (texture_capacity_ < MATERIAL_MAX_TEXTURES) {
+            printf("Material library: %u texture slots (device limit)\n", texture_capacity_);
+        }
+    }
+
+    // Unused and not-yet-loaded slots sample this
+    if (!fallback_.create_solid(context, 255, 255, 255)) {
+        fprintf(stderr, "Failed to create fallback material texture\n");
+        return false;
+    }
+    slots_.assign(1, &fallback_);
+    slot_owners_.assign(1, SlotOwner{MATERIAL_NONE, 0});
+
+    // Shared by every material map
+    VkSamplerCreateInfo sampler_info{};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = VK_FILTER_LINEAR;
+    sampler_info.minFilter = VK_FILTER_LINEAR;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_info.anisotropyEnable = VK_TRUE;
+    sampler_info.maxAnisotropy = 16.0f;
+    sampler_info.minLod = 0.0f;
+    sampler_info.maxLod = 16.0f;
+    sampler_info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+
+    if (vkCreateSampler(device, &sampler_info, nullptr, &sampler_) != VK_SUCCESS) {
+        fprintf(stderr, "Failed to create material sampler\n");
+        return false;
+    }
+
+    // Set layout: textures[], sampler, material table
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    bindings[0].descriptorCount = texture_capacity_;
+    bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    bindings[1].pImmutableSamplers = &sampler_;
+
+    bindings[2].binding = 2;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[2].descriptorCount = 1;
+    bindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
+    layout_info.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layout_info, nullptr, &descriptor_layout_) != VK_SUCCESS) {
+        fprintf(stderr, "Failed to create material descriptor layout\n");
+        return false;
+    }
+
+    // Per frame: the shared set, plus one per material when bound per
+    // material (the shared set then holds only the fallback, for untextured
+    // draws)
+    uint32_t sets_per_frame = 1 + (bound_per_material_ ? MATERIAL_MAX_MATERIALS : 0);
+    uint32_t set_count = sets_per_frame * frame_count;
+
+    std::array<VkDescriptorPoolSize, 3> pool_sizes{};
+    pool_sizes[0] = {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, texture_capacity_ * set_count};
+    pool_sizes[1] = {VK_DESCRIPTOR_TYPE_SAMPLER, set_count};
+    pool_sizes[2] = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, set_count};
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+    pool_info.pPoolSizes = pool_sizes.data();
+    pool_info.maxSets = set_count;
+
+    if (vkCreateDescriptorPool(device, &pool_info, nullptr, &descriptor_pool_) != VK_SUCCESS) {
+        fprintf(stderr, "Failed to create material descriptor pool\n");
+        return false;
+    }
+
+    // One table region per frame, at valid storage buffer offsets
+    VkDeviceSize alignment = std::max<VkDeviceSize>(limits.minStorageBufferOffsetAlignment, 16);
+    table_stride_ = (sizeof(GpuMaterial) * MATERIAL_MAX_MATERIALS + alignment - 1) / alignment * alignment;
+
+    context.create_buffer(table_stride_ * frame_count,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        table_buffer_, table_memory_, ResourceCategory::Materials);
+    vkMapMemory(device, table_memory_, 0, table_stride_ * frame_count, 0,
+                reinterpret_cast<void**>(&table_mapped_));
+
+    std::vector<VkDescriptorSetLayout> layouts(set_count, descriptor_layout_);
+    std::vector<VkDescriptorSet> sets(set_count);
+
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = descriptor_pool_;
+    alloc_info.descriptorSetCount = set_count;
+    alloc_info.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(device, &alloc_info, sets.data()) != VK_SUCCESS) {
+        fprintf(stderr, "Failed to allocate material descriptor sets\n");
+        return false;
+    }
+
+    frames_.resize(frame_count);
+    for (uint32_t i = 0; i < frame_count; i++) {
+        FrameState& frame = frames_[i];
+        frame.set = sets[i * sets_per_frame];
+        frame.material_sets.assign(sets.begin() + i * sets_per_frame + 1, sets.begin() + (i + 1) * sets_per_frame);
+        frame.views.assign(texture_capacity_ * sets_per_frame, VK_NULL_HANDLE);
+        frame.table_version = 0;
+
+        // Every set of the frame reads the frame's table region
+        VkDescriptorBufferInfo table_info{};
+        table_info.buffer = table_buffer_;
+        table_info.offset = table_stride_ * i;
+        table_info.range = sizeof(GpuMaterial) * MATERIAL_MAX_MATERIALS;
+
+        for (uint32_t j = 0; j < sets_per_frame; j++) {
+            VkWriteDescriptorSet write{};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = sets[i * sets_per_frame + j];
+            write.dstBinding = 2;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            write.descriptorCount = 1;
+            write.pBufferInfo = &table_info;
+            vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+        }
+    }
+
+    return true;
+}
+
+void MaterialLibrary::destroy() {
+    if (!context_ || !context_->device()) return;
+
+    VkDevice device = context_->device();
+
+    for (auto& material : materials_) {
+        material->destroy();
+    }
+    materials_.clear();
+    names_.clear();
+    table_.clear();
+    slots_.clear();
+    slot_owners_.clear();
+    frames_.clear();
+    fallback_.destroy();
+
+    if (table_buffer_) {
+        vkUnmapMemory(device, table_memory_);
+        vkDestroyBuffer(device, table_buffer_, nullptr);
+        context_->free_memory(table_memory_);
+        table_buffer_ = VK_NULL_HANDLE;
+        table_memory_ = VK_NULL_HANDLE;
+        table_mapped_ = nullptr;
+    }
+    if (descriptor_pool_) {
+        vkDestroyDescriptorPool(device, descriptor_pool_, nullptr);
+        descriptor_pool_ = VK_NULL_HANDLE;
+    }
+    if (descriptor_layout_) {
+        vkDestroyDescriptorSetLayout(device, descriptor_layout_, nullptr);
+        descriptor_layout_ = VK_NULL_HANDLE;
+    }
+    if (sampler_) {
+        vkDestroySampler(device, sampler_, nullptr);
+        sampler_ = VK_NULL_HANDLE;
+    }
+
+    context_ = nullptr;
+}
+
+uint32_t MaterialLibrary::add(TextureLoader& loader, const std::string& directory, const std::string& name,
+                              const MaterialParams& params) {
+    // Bound per material, slots only number the maps; each set has its own
+    bool slots_full = !bound_per_material_ && slots_.size() + MATERIAL_MAPS > texture_capacity_;
+    if (materials_.size() >= MATERIAL_MAX_MATERIALS || slots_full) {
+        fprintf(stderr, "Material table full, cannot add %s\n", name.c_str());
+        return MATERIAL_NONE;
+    }
+
+    uint32_t index = static_cast<uint32_t>(materials_.size());
+    materials_.push_back(std::make_unique<Material>());
+    names_.push_back(name);
+    Material& material = *materials_.back();
+
+    GpuMaterial entry;
+    entry.albedo = add_slot(material.albedo, index, MATERIAL_ALBEDO_BIT);
+    entry.normal = add_slot(material.normal, index, MATERIAL_NORMAL_BIT);
+    entry.roughness = add_slot(material.roughness, index, MATERIAL_ROUGHNESS_BIT);
+    entry.metallic = add_slot(material.metallic, index, MATERIAL_METALLIC_BIT);
+    entry.ao = add_slot(material.ao, index, MATERIAL_AO_BIT);
+    entry.flags = 0;
+    entry.uv_scale = params.uv_scale;
+    entry.normal_strength = params.normal_strength;
+    entry.tint = vec4(params.tint, 1.0f);
+    table_.push_back(entry);
+    table_version_++;
+
+    loader.set_loaded_callback([this](const Texture& texture) { on_texture_loaded(texture); });
+    material.load_async(loader, directory, name);
+    return index;
+}
+
+uint32_t MaterialLibrary::add_slot(Texture& texture, uint32_t material, uint32_t bit) {
+    slots_.push_back(&texture);
+    slot_owners_.push_back(SlotOwner{material, bit});
+    return static_cast<uint32_t>(slots_.size() - 1);
+}
+
+void MaterialLibrary::on_texture_loaded(const Texture& texture) {
+    for (size_t slot = 1; slot < slots_.size(); slot++) {
+        if (slots_[slot] == &texture) {
+            const SlotOwner& owner = slot_owners_[slot];
+            table_[owner.material].flags |= owner.bit;
+            table_version_++;
+            return;
+        }
+    }
+}
+
+void MaterialLibrary::prepare() {
+    FrameState& frame = frames_[context_->current_frame()];
+
+    // Rewrite only slots whose image changed (placeholder or real texture
+    // swapped in; every slot on first use). This frame's previous submission
+    // has completed, so its set can be updated. Scratch comes from the frame
+    // allocator, so a frame with rewrites still does not touch the heap.
+    //
+    // Indexed, a descriptor is a slot of the shared set. Bound per material,
+    // sets take MATERIAL_MAPS descriptors each: the shared set (fallback
+    // only) first, then one set per material with its maps in slot order.
+    uint32_t descriptor_count = bound_per_material_ ? MATERIAL_MAPS * (1 + material_count()) : texture_capacity_;
+
+    FrameAllocator& frame_memory = context_->frame_allocator();
+    FrameVector<VkDescriptorImageInfo> image_infos{FrameStlAllocator<VkDescriptorImageInfo>(frame_memory)};
+    FrameVector<VkWriteDescriptorSet> writes{FrameStlAllocator<VkWriteDescriptorSet>(frame_memory)};
+    image_infos.reserve(descriptor_count);
+    writes.reserve(descriptor_count);
+
+    for (uint32_t descriptor = 0; descriptor < descriptor_count; descriptor++) {
+        VkDescriptorSet set = frame.set;
+        uint32_t element = descriptor;
+        const Texture* texture = descriptor < slots_.size() ? slots_[descriptor] : &fallback_;
+        if (bound_per_material_) {
+            uint32_t set_index = descriptor / MATERIAL_MAPS;
+            element = descriptor % MATERIAL_MAPS;
+            if (set_index == 0) {
+                texture = &fallback_;
+            } else {
+                set = frame.material_sets[set_index - 1];
+                texture = slots_[1 + (set_index - 1) * MATERIAL_MAPS + element];
+            }
+        }
+
+        VkImageView view = texture->image_view() ? texture->image_view() : fallback_.image_view();
+        if (frame.views[descriptor] == view) continue;
+        frame.views[descriptor] = view;
+
+        VkDescriptorImageInfo info{};
+        info.imageView = view;
+        info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        image_infos.push_back(info);
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = set;
+        write.dstBinding = 0;
+        write.dstArrayElement = element;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        write.descriptorCount = 1;
+        writes.push_back(write);
+    }
+
+    // Pointers only after image_infos has stopped growing
+    for (size_t i = 0; i < writes.size(); i++) {
+        writes[i].pImageInfo = &image_infos[i];
+    }
+    if (!writes.empty()) {
+        vkUpdateDescriptorSets(context_->device(), static_cast<uint32_t>(writes.size()),
+                               writes.data(), 0, nullptr);
+    }
+
+    if (frame.table_version != table_version_) {
+        uint8_t* region = table_mapped_ + table_stride_ * context_->current_frame();
+        memcpy(region, table_.data(), table_.size() * sizeof(GpuMaterial));
+        frame.table_version = table_version_;
+    }
+}
+
+void MaterialLibrary::bind(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t set) {
+    const FrameState& frame = frames_[context_->current_frame()];
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, set, 1, &frame.set, 0, nullptr);
+    bound_set_ = frame.set;
+}
+
+void MaterialLibrary::bind_material(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t set,
+                                    uint32_t material) {
+    if (!bound_per_material_) return;
+
+    const FrameState& frame = frames_[context_->current_frame()];
+    VkDescriptorSet material_set = material < material_count() ? frame.material_sets[material] : frame.set;
+    if (material_set == bound_set_) return;
+
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, set, 1, &material_set, 0, nullptr);
+    bound_set_ = material_set;
+}
+
+VkDeviceSize MaterialLibrary::memory_size() const {
+    VkDeviceSize total = 0;
+    for (const auto& material : materials_) {
+        total += material->memory_size();
+    }
+    return total;
+}
+
+} // namespace slam
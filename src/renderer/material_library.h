@@ -0,0 +1,156 @@
+/**
+ * Slam Engine - Material Library
+ *
+ * All materials share one descriptor set: a fixed-size array of sampled
+ * images (every material map gets a slot), a single anisotropic sampler and
+ * a storage buffer with one GpuMaterial per material. The geometry pass binds
+ * the set once and each draw selects its material with a push constant index,
+ * so adding textured surfaces costs no extra binds or pipeline switches.
+ *
+ * Maps stream in through TextureLoader. Until a map has loaded its bit in
+ * GpuMaterial::flags stays clear and the shader uses the vertex color or a
+ * constant instead. There is one set and one table copy per frame in flight;
+ * prepare() refreshes the current frame's copy when slots or flags changed.
+ *
+ * The array is sized to the device's sampled-image limits (gbuffer.frag
+ * takes the size as a specialization constant). Devices without dynamic
+ * indexing of sampled image arrays get one set per material instead, each
+ * holding that material's MATERIAL_MAPS maps in fixed slots
+ * (gbuffer_bound.frag); draws then switch sets through bind_material().
+ */
+
+#pragma once
+
+#include "texture.h"
+#include "utils/math.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace slam {
+
+class VulkanContext;
+class TextureLoader;
+
+// Texture slots when the device allows it; init() lowers it to the
+// sampled-image limits (desktop GPUs and MoltenVK allow far more)
+constexpr uint32_t MATERIAL_MAX_TEXTURES = 128;
+constexpr uint32_t MATERIAL_MAX_MATERIALS = 64;
+constexpr uint32_t MATERIAL_MAPS = 5;  // Slots per material, in MaterialMapBits order
+constexpr uint32_t MATERIAL_NONE = UINT32_MAX;  // Untextured: vertex color only
+
+// GpuMaterial::flags: which maps have loaded
+enum MaterialMapBits : uint32_t {
+    MATERIAL_ALBEDO_BIT = 1u << 0,
+    MATERIAL_NORMAL_BIT = 1u << 1,
+    MATERIAL_ROUGHNESS_BIT = 1u << 2,
+    MATERIAL_METALLIC_BIT = 1u << 3,
+    MATERIAL_AO_BIT = 1u << 4,
+};
+
+// Material table entry (std430, 48 bytes)
+struct GpuMaterial {
+    uint32_t albedo = 0;     // Texture slots
+    uint32_t normal = 0;
+    uint32_t roughness = 0;
+    uint32_t metallic = 0;
+    uint32_t ao = 0;
+    uint32_t flags = 0;
+    float uv_scale = 1.0f;
+    float normal_strength = 1.0f;
+    vec4 tint = vec4(1.0f);  // Multiplies the albedo map
+};
+
+// Per-material shading parameters
+struct MaterialParams {
+    float uv_scale = 1.0f;
+    float normal_strength = 1.0f;
+    vec3 tint = vec3(1.0f);
+};
+
+class MaterialLibrary {
+public:
+    MaterialLibrary() = default;
+    ~MaterialLibrary();
+
+    // Non-copyable
+    MaterialLibrary(const MaterialLibrary&) = delete;
+    MaterialLibrary& operator=(const MaterialLibrary&) = delete;
+
+    // Create the descriptor layout, sets, sampler and table buffer
+    bool init(VulkanContext& context);
+
+    // Cleanup (the loader must be shut down first)
+    void destroy();
+
+    // Stream <directory>/<name>_<map> through the loader. Returns the
+    // material index for draw calls, or MATERIAL_NONE if the table is full.
+    uint32_t add(TextureLoader& loader, const std::string& directory, const std::string& name,
+                 const MaterialParams& params = {});
+
+    // Bring the current frame's descriptor set and table up to date. Call
+    // once per frame before recording the geometry pass.
+    void prepare();
+
+    // Bind for the current frame (set index within the given layout)
+    void bind(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t set);
+
+    // Before each draw: switches to the material's own set when bound per
+    // material, does nothing otherwise
+    void bind_material(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t set, uint32_t material);
+
+    VkDescriptorSetLayout descriptor_layout() const { return descriptor_layout_; }
+    uint32_t texture_capacity() const { return texture_capacity_; }  // Size of the texture array
+    bool bound_per_material() const { return bound_per_material_; }
+    uint32_t material_count() const { return static_cast<uint32_t>(materials_.size()); }
+    const std::string& name(uint32_t material) const { return names_[material]; }
+
+    // Device memory used by all material maps
+    VkDeviceSize memory_size() const;
+
+private:
+    struct FrameState {
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        std::vector<VkDescriptorSet> material_sets;  // Bound per material only
+        std::vector<VkImageView> views;  // Written into each descriptor
+        uint64_t table_version = 0;
+    };
+
+    struct SlotOwner {
+        uint32_t material;
+        uint32_t bit;
+    };
+
+    uint32_t add_slot(Texture& texture, uint32_t material, uint32_t bit);
+    void on_texture_loaded(const Texture& texture);
+
+    VulkanContext* context_ = nullptr;
+    VkDescriptorSetLayout descriptor_layout_ = VK_NULL_HANDLE;
+    VkDescriptorPool descriptor_pool_ = VK_NULL_HANDLE;
+    VkSampler sampler_ = VK_NULL_HANDLE;
+    uint32_t texture_capacity_ = MATERIAL_MAX_TEXTURES;
+    bool bound_per_material_ = false;
+    VkDescriptorSet bound_set_ = VK_NULL_HANDLE;  // Last set bound this frame
+
+    // Table: one region per frame in flight, persistently mapped
+    VkBuffer table_buffer_ = VK_NULL_HANDLE;
+    VkDeviceMemory table_memory_ = VK_NULL_HANDLE;
+    uint8_t* table_mapped_ = nullptr;
+    VkDeviceSize table_stride_ = 0;
+
+    std::vector<FrameState> frames_;
+    uint64_t table_version_ = 1;
+
+    // Slot 0 is a white fallback; unused slots point at it too
+    Texture fallback_;
+    std::vector<const Texture*> slots_;
+    std::vector<SlotOwner> slot_owners_;
+
+    std::vector<std::unique_ptr<Material>> materials_;  // Stable addresses for the loader
+    std::vector<std::string> names_;
+    std::vector<GpuMaterial> table_;
+};
+
+} // namespace slam
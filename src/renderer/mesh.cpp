@@ -69,7 +69,7 @@ bool Mesh::create(VulkanContext& context,
     context_->create_buffer(vertex_size,
         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        staging_buffer, staging_buffer_memory);
+        staging_buffer, staging_buffer_memory, ResourceCategory::Staging);
 
     // Copy vertex data
     void* data;
@@ -81,14 +81,14 @@ bool Mesh::create(VulkanContext& context,
     context_->create_buffer(vertex_size,
         VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        vertex_buffer_, vertex_buffer_memory_);
+        vertex_buffer_, vertex_buffer_memory_, ResourceCategory::Meshes);
 
     // Copy to device
     context_->copy_buffer(staging_buffer, vertex_buffer_, vertex_size);
 
     // Cleanup staging buffer
     vkDestroyBuffer(context_->device(), staging_buffer, nullptr);
-    vkFreeMemory(context_->device(), staging_buffer_memory, nullptr);
+    context_->free_memory(staging_buffer_memory);
 
     // Create index buffer
     VkDeviceSize index_size = sizeof(uint32_t) * indices.size();
@@ -96,7 +96,7 @@ bool Mesh::create(VulkanContext& context,
     context_->create_buffer(index_size,
         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        staging_buffer, staging_buffer_memory);
+        staging_buffer, staging_buffer_memory, ResourceCategory::Staging);
 
     vkMapMemory(context_->device(), staging_buffer_memory, 0, index_size, 0, &data);
     memcpy(data, indices.data(), index_size);
@@ -105,12 +105,12 @@ bool Mesh::create(VulkanContext& context,
     context_->create_buffer(index_size,
         VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        index_buffer_, index_buffer_memory_);
+        index_buffer_, index_buffer_memory_, ResourceCategory::Meshes);
 
     context_->copy_buffer(staging_buffer, index_buffer_, index_size);
 
     vkDestroyBuffer(context_->device(), staging_buffer, nullptr);
-    vkFreeMemory(context_->device(), staging_buffer_memory, nullptr);
+    context_->free_memory(staging_buffer_memory);
 
     return true;
 }
@@ -121,18 +121,12 @@ void Mesh::destroy() {
             vkDestroyBuffer(context_->device(), index_buffer_, nullptr);
             index_buffer_ = VK_NULL_HANDLE;
         }
-        if (index_buffer_memory_) {
-            vkFreeMemory(context_->device(), index_buffer_memory_, nullptr);
-            index_buffer_memory_ = VK_NULL_HANDLE;
-        }
+        context_->free_memory(index_buffer_memory_);
         if (vertex_buffer_) {
             vkDestroyBuffer(context_->device(), vertex_buffer_, nullptr);
             vertex_buffer_ = VK_NULL_HANDLE;
         }
-        if (vertex_buffer_memory_) {
-            vkFreeMemory(context_->device(), vertex_buffer_memory_, nullptr);
-            vertex_buffer_memory_ = VK_NULL_HANDLE;
-        }
+        context_->free_memory(vertex_buffer_memory_);
     }
 }
 
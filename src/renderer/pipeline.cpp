@@ -18,7 +18,8 @@ Pipeline::~Pipeline() {
 
 bool Pipeline::create(VulkanContext& context,
                       const std::string& vert_shader_path,
-                      const std::string& frag_shader_path) {
+                      const std::string& frag_shader_path,
+                      const std::vector<VkDescriptorSetLayout>& set_layouts) {
     context_ = &context;
 
     // Load shaders
@@ -147,7 +148,7 @@ bool Pipeline::create(VulkanContext& context,
     dynamic_state.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
     dynamic_state.pDynamicStates = dynamic_states.data();
 
-    // Push constants for MVP matrices
+    // Push constants for the model matrix
     VkPushConstantRange push_constant_range{};
     push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
     push_constant_range.offset = 0;
@@ -156,6 +157,8 @@ bool Pipeline::create(VulkanContext& context,
     // Pipeline layout
     VkPipelineLayoutCreateInfo pipeline_layout_info{};
     pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(set_layouts.size());
+    pipeline_layout_info.pSetLayouts = set_layouts.data();
     pipeline_layout_info.pushConstantRangeCount = 1;
     pipeline_layout_info.pPushConstantRanges = &push_constant_range;
 
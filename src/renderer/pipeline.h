@@ -14,11 +14,10 @@ namespace slam {
 
 class VulkanContext;
 
-// Push constants for per-object data
+// Push constants for per-object data (view/projection come from the
+// frame uniform buffer)
 struct PushConstants {
     float model[16];      // Model matrix
-    float view[16];       // View matrix
-    float projection[16]; // Projection matrix
 };
 
 class Pipeline {
@@ -30,10 +29,11 @@ public:
     Pipeline(const Pipeline&) = delete;
     Pipeline& operator=(const Pipeline&) = delete;
 
-    // Create pipeline
+    // Create pipeline. set_layouts are bound at sets 0..n-1 by the caller.
     bool create(VulkanContext& context,
                 const std::string& vert_shader_path,
-                const std::string& frag_shader_path);
+                const std::string& frag_shader_path,
+                const std::vector<VkDescriptorSetLayout>& set_layouts = {});
 
     // Cleanup
     void destroy();
@@ -41,7 +41,7 @@ public:
     // Bind pipeline for rendering
     void bind(VkCommandBuffer command_buffer);
 
-    // Push MVP matrices
+    // Push model matrix
     void push_constants(VkCommandBuffer command_buffer, const PushConstants& constants);
 
     // Getters
@@ -0,0 +1,501 @@
+/**
+ * Slam Engine - Render Graph Implementation
+ */
+
+#include "render_graph.h"
+#include "vulkan_context.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace slam {
+
+RenderGraph::~RenderGraph() {
+    destroy();
+}
+
+bool RenderGraph::init(VulkanContext& context) {
+    context_ = &context;
+    return true;
+}
+
+void RenderGraph::destroy() {
+    if (!context_) return;
+
+    reset();
+    context_ = nullptr;
+}
+
+void RenderGraph::reset() {
+    destroy_transients();
+
+    resources_.clear();
+    passes_.clear();
+    final_barriers_ = BarrierBatch{};
+
+    culled_pass_count_ = 0;
+    barrier_count_ = 0;
+    transient_bytes_ = 0;
+    transient_bytes_unaliased_ = 0;
+}
+
+RGResource RenderGraph::import_image(const char* name, VkImage image, VkImageAspectFlags aspect,
+                                     VkImageLayout initial_layout, VkImageLayout final_layout) {
+    Resource resource;
+    resource.name = name;
+    resource.imported = true;
+    resource.image = image;
+    resource.aspect = aspect;
+    resource.initial_layout = initial_layout;
+    resource.final_layout = final_layout;
+
+    resources_.push_back(resource);
+    return static_cast<RGResource>(resources_.size() - 1);
+}
+
+RGResource RenderGraph::create_image(const char* name, const RGImageDesc& desc) {
+    Resource resource;
+    resource.name = name;
+    resource.aspect = desc.aspect;
+    resource.desc = desc;
+
+    resources_.push_back(resource);
+    return static_cast<RGResource>(resources_.size() - 1);
+}
+
+void RenderGraph::set_imported_image(RGResource resource, VkImage image) {
+    resources_[resource].image = image;
+}
+
+uint32_t RenderGraph::add_pass(const char* name, ExecuteFn execute) {
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+
+    passes_.push_back(std::move(pass));
+    return static_cast<uint32_t>(passes_.size() - 1);
+}
+
+void RenderGraph::read(uint32_t pass, RGResource resource, RGAccess access) {
+    passes_[pass].accesses.push_back({resource, access, false, VK_IMAGE_LAYOUT_UNDEFINED});
+}
+
+void RenderGraph::write(uint32_t pass, RGResource resource, RGAccess access,
+                        VkImageLayout render_pass_final_layout) {
+    passes_[pass].accesses.push_back({resource, access, true, render_pass_final_layout});
+}
+
+void RenderGraph::set_side_effect(uint32_t pass) {
+    passes_[pass].side_effect = true;
+}
+
+void RenderGraph::set_output(RGResource resource) {
+    resources_[resource].output = true;
+}
+
+bool RenderGraph::compile() {
+    cull_passes();
+    compute_lifetimes();
+
+    if (!allocate_transients()) {
+        fprintf(stderr, "Failed to allocate render graph transient images\n");
+        return false;
+    }
+
+    plan_barriers();
+    return true;
+}
+
+void RenderGraph::execute(VkCommandBuffer cmd) {
+    for (const Pass& pass : passes_) {
+        if (pass.culled) continue;
+
+        record_barriers(cmd, pass.before);
+
+        GpuScope scope(context_->profiler(), cmd, pass.name);
+        pass.execute(cmd);
+    }
+
+    record_barriers(cmd, final_barriers_);
+}
+
+RenderGraph::AccessInfo RenderGraph::access_info(RGAccess access) {
+    switch (access) {
+        case RGAccess::ColorAttachment:
+            return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                    VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        case RGAccess::DepthAttachment:
+            return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+        case RGAccess::ShaderRead:
+            return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                    VK_ACCESS_SHADER_READ_BIT,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        case RGAccess::DepthShaderRead:
+            return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                    VK_ACCESS_SHADER_READ_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+        case RGAccess::TransferSrc:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    VK_ACCESS_TRANSFER_READ_BIT,
+                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
+        case RGAccess::TransferDst:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    VK_ACCESS_TRANSFER_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
+    }
+    return {VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT, VK_IMAGE_LAYOUT_GENERAL};
+}
+
+void RenderGraph::cull_passes() {
+    // Walk backwards from the outputs: a pass is needed if it writes a
+    // resource that a later needed pass (or the frame output) consumes
+    std::vector<bool> needed(resources_.size(), false);
+    for (size_t i = 0; i < resources_.size(); i++) {
+        needed[i] = resources_[i].output;
+    }
+
+    culled_pass_count_ = 0;
+    for (size_t p = passes_.size(); p-- > 0;) {
+        Pass& pass = passes_[p];
+
+        bool keep = pass.side_effect;
+        for (const ResourceAccess& access : pass.accesses) {
+            if (access.write && needed[access.resource]) {
+                keep = true;
+            }
+        }
+
+        pass.culled = !keep;
+        if (pass.culled) {
+            culled_pass_count_++;
+            continue;
+        }
+
+        for (const ResourceAccess& access : pass.accesses) {
+            if (!access.write) {
+                needed[access.resource] = true;
+            } else if (access.final_layout != VK_IMAGE_LAYOUT_UNDEFINED) {
+                // Render pass starts from UNDEFINED: earlier contents are discarded
+                needed[access.resource] = false;
+            }
+        }
+    }
+}
+
+void RenderGraph::compute_lifetimes() {
+    for (Resource& resource : resources_) {
+        resource.first_pass = -1;
+        resource.last_pass = -1;
+    }
+
+    for (size_t p = 0; p < passes_.size(); p++) {
+        if (passes_[p].culled) continue;
+
+        for (const ResourceAccess& access : passes_[p].accesses) {
+            Resource& resource = resources_[access.resource];
+            if (resource.first_pass < 0) {
+                resource.first_pass = static_cast<int>(p);
+            }
+            resource.last_pass = static_cast<int>(p);
+        }
+    }
+}
+
+bool RenderGraph::allocate_transients() {
+    destroy_transients();
+
+    VkDevice device = context_->device();
+
+    // Create images first so their memory requirements are known
+    std::vector<RGResource> transients;
+    std::vector<VkMemoryRequirements> requirements(resources_.size());
+
+    for (size_t i = 0; i < resources_.size(); i++) {
+        Resource& resource = resources_[i];
+        if (resource.imported || resource.first_pass < 0) continue;
+
+        VkImageCreateInfo image_info{};
+        image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        image_info.imageType = VK_IMAGE_TYPE_2D;
+        image_info.extent.width = resource.desc.width;
+        image_info.extent.height = resource.desc.height;
+        image_info.extent.depth = 1;
+        image_info.mipLevels = 1;
+        image_info.arrayLayers = 1;
+        image_info.format = resource.desc.format;
+        image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        image_info.usage = resource.desc.usage;
+        image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateImage(device, &image_info, nullptr, &resource.image) != VK_SUCCESS) {
+            fprintf(stderr, "Failed to create transient image '%s'\n", resource.name);
+            return false;
+        }
+
+        vkGetImageMemoryRequirements(device, resource.image, &requirements[i]);
+        resource.size = requirements[i].size;
+        transient_bytes_unaliased_ += requirements[i].size;
+        transients.push_back(static_cast<RGResource>(i));
+    }
+
+    // Greedy aliasing: place each image (largest first) in the first slot
+    // whose occupants are all dead before it starts or born after it ends
+    std::sort(transients.begin(), transients.end(), [this](RGResource a, RGResource b) {
+        return resources_[a].size > resources_[b].size;
+    });
+
+    for (RGResource index : transients) {
+        Resource& resource = resources_[index];
+
+        int chosen = -1;
+        for (size_t s = 0; s < memory_slots_.size() && chosen < 0; s++) {
+            MemorySlot& slot = memory_slots_[s];
+            if (!(slot.type_bits & requirements[index].memoryTypeBits)) continue;
+
+            bool overlaps = false;
+            for (RGResource other : slot.occupants) {
+                const Resource& o = resources_[other];
+                if (resource.first_pass <= o.last_pass && o.first_pass <= resource.last_pass) {
+                    overlaps = true;
+                    break;
+                }
+            }
+            if (!overlaps) {
+                chosen = static_cast<int>(s);
+            }
+        }
+
+        if (chosen < 0) {
+            memory_slots_.push_back(MemorySlot{});
+            memory_slots_.back().type_bits = requirements[index].memoryTypeBits;
+            chosen = static_cast<int>(memory_slots_.size() - 1);
+        }
+
+        // Images are bound at offset 0, so the slot alignment is the image's
+        MemorySlot& slot = memory_slots_[chosen];
+        slot.size = std::max(slot.size, requirements[index].size);
+        slot.type_bits &= requirements[index].memoryTypeBits;
+        slot.occupants.push_back(index);
+        resource.memory_slot = chosen;
+    }
+
+    // Allocate slots and bind images
+    for (MemorySlot& slot : memory_slots_) {
+        VkMemoryAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = slot.size;
+        alloc_info.memoryTypeIndex = context_->find_memory_type(slot.type_bits,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        if (context_->allocate_memory(alloc_info, ResourceCategory::RenderTargets, slot.memory) != VK_SUCCESS) {
+            return false;
+        }
+        transient_bytes_ += slot.size;
+
+        for (RGResource index : slot.occupants) {
+            Resource& resource = resources_[index];
+            vkBindImageMemory(device, resource.image, slot.memory, 0);
+
+            VkImageViewCreateInfo view_info{};
+            view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            view_info.image = resource.image;
+            view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            view_info.format = resource.desc.format;
+            view_info.subresourceRange.aspectMask = resource.desc.aspect;
+            view_info.subresourceRange.baseMipLevel = 0;
+            view_info.subresourceRange.levelCount = 1;
+            view_info.subresourceRange.baseArrayLayer = 0;
+            view_info.subresourceRange.layerCount = 1;
+
+            if (vkCreateImageView(device, &view_info, nullptr, &resource.view) != VK_SUCCESS) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void RenderGraph::plan_barriers() {
+    // Simulated state of each resource (and each transient memory slot) as
+    // the compiled passes execute
+    struct State {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags write_stages = 0;
+        VkAccessFlags write_access = 0;
+        VkPipelineStageFlags read_stages = 0;
+        VkPipelineStageFlags visible_stages = 0;  // Readers that already saw the last write
+        bool touched = false;
+    };
+
+    struct SlotState {
+        VkPipelineStageFlags stages = 0;
+        VkAccessFlags write_access = 0;
+    };
+
+    std::vector<State> states(resources_.size());
+    std::vector<SlotState> slot_states(memory_slots_.size());
+    for (size_t i = 0; i < resources_.size(); i++) {
+        states[i].layout = resources_[i].imported ? resources_[i].initial_layout
+                                                  : VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+
+    barrier_count_ = 0;
+    size_t max_batch = 0;
+
+    for (Pass& pass : passes_) {
+        pass.before = BarrierBatch{};
+        if (pass.culled) continue;
+
+        for (const ResourceAccess& access : pass.accesses) {
+            const Resource& resource = resources_[access.resource];
+            State& state = states[access.resource];
+            AccessInfo info = access_info(access.access);
+            bool managed = access.write && access.final_layout != VK_IMAGE_LAYOUT_UNDEFINED;
+
+            PlannedBarrier barrier{access.resource, state.layout, info.layout,
+                                   state.write_access, info.access};
+            VkPipelineStageFlags src_stages = state.write_stages | state.read_stages;
+            bool needed = false;
+
+            if (!resource.imported && !state.touched) {
+                // First use of a transient: contents are undefined, but an
+                // earlier image sharing its memory may still be in flight
+                const SlotState& slot = slot_states[resource.memory_slot];
+                barrier.old_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+                barrier.src_access = slot.write_access;
+                src_stages = slot.stages;
+                needed = src_stages != 0 || !managed;
+            } else if (managed) {
+                // The render pass transitions from UNDEFINED itself; only
+                // order it after earlier accesses in this frame
+                barrier.old_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+                needed = state.touched;
+            } else if (state.layout != info.layout) {
+                needed = true;
+            } else if (access.write) {
+                needed = state.touched;
+            } else {
+                needed = state.write_stages != 0 && !(state.visible_stages & info.stages);
+            }
+
+            if (needed) {
+                pass.before.src_stages |= src_stages ? src_stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                pass.before.dst_stages |= info.stages;
+                pass.before.barriers.push_back(barrier);
+            }
+
+            // Advance the simulated state
+            state.layout = managed ? access.final_layout : info.layout;
+            if (access.write) {
+                state.write_stages = info.stages;
+                state.write_access = info.access;
+                state.read_stages = 0;
+                state.visible_stages = 0;
+            } else {
+                state.read_stages |= info.stages;
+                if (needed) {
+                    state.visible_stages |= info.stages;
+                }
+            }
+            state.touched = true;
+
+            if (resource.memory_slot >= 0) {
+                SlotState& slot = slot_states[resource.memory_slot];
+                slot.stages |= info.stages;
+                if (access.write) {
+                    slot.write_access |= info.access;
+                }
+            }
+        }
+
+        barrier_count_ += static_cast<uint32_t>(pass.before.barriers.size());
+        max_batch = std::max(max_batch, pass.before.barriers.size());
+    }
+
+    // Leave imported images in the layout their owners expect
+    final_barriers_ = BarrierBatch{};
+    for (size_t i = 0; i < resources_.size(); i++) {
+        const Resource& resource = resources_[i];
+        const State& state = states[i];
+        if (!resource.imported || !state.touched ||
+            resource.final_layout == VK_IMAGE_LAYOUT_UNDEFINED ||
+            resource.final_layout == state.layout) {
+            continue;
+        }
+
+        final_barriers_.src_stages |= state.write_stages | state.read_stages;
+        final_barriers_.dst_stages |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        final_barriers_.barriers.push_back({static_cast<RGResource>(i), state.layout,
+                                            resource.final_layout, state.write_access, 0});
+    }
+    barrier_count_ += static_cast<uint32_t>(final_barriers_.barriers.size());
+    max_batch = std::max(max_batch, final_barriers_.barriers.size());
+
+    image_barriers_.reserve(max_batch);
+}
+
+void RenderGraph::record_barriers(VkCommandBuffer cmd, const BarrierBatch& batch) {
+    if (batch.barriers.empty()) return;
+
+    image_barriers_.clear();
+    for (const PlannedBarrier& planned : batch.barriers) {
+        const Resource& resource = resources_[planned.resource];
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = planned.src_access;
+        barrier.dstAccessMask = planned.dst_access;
+        barrier.oldLayout = planned.old_layout;
+        barrier.newLayout = planned.new_layout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = resource.image;
+        barrier.subresourceRange.aspectMask = resource.aspect;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+        image_barriers_.push_back(barrier);
+    }
+
+    vkCmdPipelineBarrier(cmd, batch.src_stages, batch.dst_stages, 0,
+                         0, nullptr, 0, nullptr,
+                         static_cast<uint32_t>(image_barriers_.size()), image_barriers_.data());
+}
+
+void RenderGraph::destroy_transients() {
+    if (!context_ || !context_->device()) return;
+
+    VkDevice device = context_->device();
+
+    for (Resource& resource : resources_) {
+        if (resource.imported) continue;
+
+        if (resource.view) {
+            vkDestroyImageView(device, resource.view, nullptr);
+            resource.view = VK_NULL_HANDLE;
+        }
+        if (resource.image) {
+            vkDestroyImage(device, resource.image, nullptr);
+            resource.image = VK_NULL_HANDLE;
+        }
+        resource.memory_slot = -1;
+    }
+
+    for (MemorySlot& slot : memory_slots_) {
+        if (slot.memory) {
+            context_->free_memory(slot.memory);
+        }
+    }
+    memory_slots_.clear();
+
+    transient_bytes_ = 0;
+    transient_bytes_unaliased_ = 0;
+}
+
+} // namespace slam
@@ -0,0 +1,196 @@
+/**
+ * Slam Engine - Render Graph
+ *
+ * Frame graph of passes that declare the images they read and write.
+ * compile() culls passes that do not contribute to an output, plans the
+ * minimal set of image barriers between passes (one vkCmdPipelineBarrier per
+ * pass at most) and aliases the memory of transient images whose lifetimes
+ * do not overlap. execute() records the barriers and pass callbacks, each
+ * pass inside a GPU profiler scope named after it.
+ *
+ * Passes run in the order they were added. Render passes that transition
+ * their own attachments (initialLayout UNDEFINED -> finalLayout) declare the
+ * final layout on write; the graph then only orders them.
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace slam {
+
+class VulkanContext;
+
+// Handle to a graph image
+using RGResource = uint32_t;
+constexpr RGResource RG_INVALID_RESOURCE = UINT32_MAX;
+
+// How a pass uses an image
+enum class RGAccess {
+    ColorAttachment,    // Color attachment write
+    DepthAttachment,    // Depth attachment write (with depth test reads)
+    ShaderRead,         // Sampled in a fragment shader
+    DepthShaderRead,    // Depth sampled in a fragment shader (read-only depth layout)
+    TransferSrc,        // Copy source
+    TransferDst,        // Copy destination
+};
+
+// Description of a graph-owned (transient) image
+struct RGImageDesc {
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VkImageUsageFlags usage = 0;
+    VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+};
+
+class RenderGraph {
+public:
+    using ExecuteFn = std::function<void(VkCommandBuffer cmd)>;
+
+    RenderGraph() = default;
+    ~RenderGraph();
+
+    // Non-copyable
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    // Initialize graph
+    bool init(VulkanContext& context);
+
+    // Cleanup (also frees transient memory)
+    void destroy();
+
+    // Drop all passes and resources so the graph can be rebuilt
+    void reset();
+
+    // Resources. Imported images are owned elsewhere; initial_layout is the
+    // layout at the start of the frame, final_layout (if not UNDEFINED) is
+    // the layout the graph leaves them in at the end.
+    RGResource import_image(const char* name, VkImage image, VkImageAspectFlags aspect,
+                            VkImageLayout initial_layout,
+                            VkImageLayout final_layout = VK_IMAGE_LAYOUT_UNDEFINED);
+    RGResource create_image(const char* name, const RGImageDesc& desc);
+
+    // Update an imported image handle (e.g. the acquired swapchain image)
+    void set_imported_image(RGResource resource, VkImage image);
+
+    // Passes. A pass may access each resource once.
+    uint32_t add_pass(const char* name, ExecuteFn execute);
+    void read(uint32_t pass, RGResource resource, RGAccess access);
+    void write(uint32_t pass, RGResource resource, RGAccess access,
+               VkImageLayout render_pass_final_layout = VK_IMAGE_LAYOUT_UNDEFINED);
+    void set_side_effect(uint32_t pass);  // Never culled
+
+    // Mark a resource as a frame output (e.g. the swapchain image)
+    void set_output(RGResource resource);
+
+    // Cull, plan barriers and allocate transient memory
+    bool compile();
+
+    // Record the compiled frame
+    void execute(VkCommandBuffer cmd);
+
+    // Transient image access (valid after compile)
+    VkImage image(RGResource resource) const { return resources_[resource].image; }
+    VkImageView image_view(RGResource resource) const { return resources_[resource].view; }
+
+    // Statistics (valid after compile)
+    uint32_t pass_count() const { return static_cast<uint32_t>(passes_.size()); }
+    uint32_t culled_pass_count() const { return culled_pass_count_; }
+    uint32_t barrier_count() const { return barrier_count_; }
+    VkDeviceSize transient_bytes() const { return transient_bytes_; }
+    VkDeviceSize transient_bytes_unaliased() const { return transient_bytes_unaliased_; }
+
+private:
+    struct AccessInfo {
+        VkPipelineStageFlags stages;
+        VkAccessFlags access;
+        VkImageLayout layout;
+    };
+
+    struct ResourceAccess {
+        RGResource resource;
+        RGAccess access;
+        bool write;
+        VkImageLayout final_layout;  // Set when a render pass transitions the image itself
+    };
+
+    struct Resource {
+        const char* name = "";
+        bool imported = false;
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        VkImageLayout initial_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageLayout final_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        RGImageDesc desc;
+        bool output = false;
+
+        // Compile state
+        int first_pass = -1;
+        int last_pass = -1;
+        int memory_slot = -1;
+        VkDeviceSize size = 0;
+    };
+
+    struct PlannedBarrier {
+        RGResource resource;
+        VkImageLayout old_layout;
+        VkImageLayout new_layout;
+        VkAccessFlags src_access;
+        VkAccessFlags dst_access;
+    };
+
+    struct BarrierBatch {
+        VkPipelineStageFlags src_stages = 0;
+        VkPipelineStageFlags dst_stages = 0;
+        std::vector<PlannedBarrier> barriers;
+    };
+
+    struct Pass {
+        const char* name = "";
+        ExecuteFn execute;
+        std::vector<ResourceAccess> accesses;
+        bool side_effect = false;
+        bool culled = false;
+        BarrierBatch before;  // Recorded before the pass callback
+    };
+
+    // Transient memory block shared by images with disjoint lifetimes
+    struct MemorySlot {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+        uint32_t type_bits = 0;
+        std::vector<RGResource> occupants;
+    };
+
+    static AccessInfo access_info(RGAccess access);
+
+    void cull_passes();
+    void compute_lifetimes();
+    bool allocate_transients();
+    void plan_barriers();
+    void record_barriers(VkCommandBuffer cmd, const BarrierBatch& batch);
+    void destroy_transients();
+
+    VulkanContext* context_ = nullptr;
+
+    std::vector<Resource> resources_;
+    std::vector<Pass> passes_;
+    std::vector<MemorySlot> memory_slots_;
+    BarrierBatch final_barriers_;
+
+    // Scratch for execute(), sized at compile time
+    std::vector<VkImageMemoryBarrier> image_barriers_;
+
+    uint32_t culled_pass_count_ = 0;
+    uint32_t barrier_count_ = 0;
+    VkDeviceSize transient_bytes_ = 0;
+    VkDeviceSize transient_bytes_unaliased_ = 0;
+};
+
+} // namespace slam
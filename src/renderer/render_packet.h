@@ -0,0 +1,53 @@
+/**
+ * Slam Engine - Render Packet
+ *
+ * Everything the render thread needs for one frame, produced by the
+ * simulation thread. Packets are self-contained copies (camera, lights,
+ * settings) except the draw lists, which are built once at map load and
+ * only read afterwards; their stats are written by the render thread.
+ * Rebuilding them (and their instance buffers) is only safe while the
+ * render thread is stopped.
+ */
+
+#pragma once
+
+#include "draw_list.h"
+#include "light.h"
+#include "utils/math.h"
+#include "utils/timer.h"
+#include <cstdint>
+#include <vector>
+
+namespace slam {
+
+struct RenderPacket {
+    uint64_t sequence = 0;  // Set by RenderThread::publish()
+
+    // Camera
+    mat4 view;
+    mat4 projection;
+    vec3 camera_pos;
+    float near_plane = 0.1f;
+    float far_plane = 100.0f;
+
+    // Every light, already animated; the render thread uploads and bins them
+    std::vector<PointLight> lights;
+
+    // Static scene draws, shared with the main thread (see above)
+    DrawList* draws = nullptr;
+    const DrawList* shadow_casters = nullptr;
+
+    // Window size (0 while minimized) and renderer settings
+    uint32_t width = 0;
+    uint32_t height = 0;
+    bool depth_prepass = false;
+    bool shadows = true;
+
+    // One-shot requests, handled once per packet
+    bool print_gpu_report = false;
+
+    double sim_frame_ms = 0.0;  // For the FPS log
+    Timer::TimePoint input_time;  // When the input behind this frame was polled
+};
+
+} // namespace slam
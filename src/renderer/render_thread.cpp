@@ -0,0 +1,71 @@
+/**
+ * Slam Engine - Render Thread Implementation
+ */
+
+#include "render_thread.h"
+
+namespace slam {
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+void RenderThread::start(RenderFn render) {
+    render_ = std::move(render);
+    published_ = 0;
+    picked_up_ = 0;
+    frames_rendered_ = 0;
+    running_ = true;
+    thread_ = std::thread(&RenderThread::thread_main, this);
+}
+
+void RenderThread::stop() {
+    if (!thread_.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    published_signal_.notify_all();
+    picked_up_signal_.notify_all();
+    thread_.join();
+}
+
+void RenderThread::publish() {
+    // Packet first, count second: a render thread woken by the count always
+    // finds the packet. Only this thread writes published_.
+    packets_.write_buffer().sequence = published_ + 1;
+    packets_.publish();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        published_++;
+    }
+    published_signal_.notify_one();
+}
+
+void RenderThread::wait_for_pickup() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    picked_up_signal_.wait(lock, [this] { return !running_ || picked_up_ >= published_; });
+}
+
+void RenderThread::thread_main() {
+    while (running_) {
+        // Wait for a packet newer than the last one rendered
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            published_signal_.wait(lock, [this] { return !running_ || published_ > picked_up_; });
+        }
+        if (!running_ || !packets_.acquire()) continue;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            picked_up_ = packets_.read_buffer().sequence;
+        }
+        picked_up_signal_.notify_one();
+
+        render_(packets_.read_buffer());
+        frames_rendered_++;
+    }
+}
+
+} // namespace slam
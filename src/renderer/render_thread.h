@@ -0,0 +1,76 @@
+/**
+ * Slam Engine - Render Thread
+ *
+ * Runs command recording and presentation on its own thread so a slow
+ * simulation frame no longer delays GPU submission. The simulation thread
+ * fills packet(), calls publish(), and the render thread picks the packet
+ * up through a lock-free triple buffer. Each packet is rendered once: with
+ * no new packet the render thread waits instead of repeating GPU work
+ * (and input latency samples) for a stale one.
+ *
+ * Pacing: wait_for_pickup() lets the simulation run at most one packet
+ * ahead of the renderer. The mutex and condition variable only carry that
+ * wakeup; packets themselves never take a lock.
+ */
+
+#pragma once
+
+#include "render_packet.h"
+#include "utils/triple_buffer.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace slam {
+
+class RenderThread {
+public:
+    // Records and presents one frame from a packet it has not seen before
+    using RenderFn = std::function<void(const RenderPacket& packet)>;
+
+    RenderThread() = default;
+    ~RenderThread();
+
+    // Non-copyable
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // Start consuming packets
+    void start(RenderFn render);
+
+    // Finish the frame in progress and join
+    void stop();
+
+    bool running() const { return running_; }
+
+    // Simulation side: fill packet() completely, then publish it
+    RenderPacket& packet() { return packets_.write_buffer(); }
+    void publish();
+
+    // Block until the render thread has picked up the last published packet
+    void wait_for_pickup();
+
+    // Frames recorded so far (one per packet picked up)
+    uint64_t frames_rendered() const { return frames_rendered_; }
+
+private:
+    void thread_main();
+
+    TripleBuffer<RenderPacket> packets_;
+    RenderFn render_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    // Pacing only
+    std::mutex mutex_;
+    std::condition_variable picked_up_signal_;
+    std::condition_variable published_signal_;
+    uint64_t published_ = 0;   // Written by the simulation thread
+    uint64_t picked_up_ = 0;   // Written by the render thread
+    std::atomic<uint64_t> frames_rendered_{0};
+};
+
+} // namespace slam
@@ -0,0 +1,177 @@
+/**
+ * Slam Engine - Resource Tracker Implementation
+ */
+
+#include "resource_tracker.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace slam {
+
+const char* resource_category_name(ResourceCategory category) {
+    switch (category) {
+        case ResourceCategory::Swapchain:     return "swapchain";
+        case ResourceCategory::RenderTargets: return "render targets";
+        case ResourceCategory::GBuffer:       return "g-buffer";
+        case ResourceCategory::ShadowMaps:    return "shadow maps";
+        case ResourceCategory::Lights:        return "lights";
+        case ResourceCategory::Meshes:        return "meshes";
+        case ResourceCategory::Instances:     return "instances";
+        case ResourceCategory::Textures:      return "textures";
+        case ResourceCategory::Materials:     return "materials";
+        case ResourceCategory::Uniforms:      return "uniforms";
+        case ResourceCategory::Staging:       return "staging";
+        case ResourceCategory::Other:         return "other";
+        default:                              return "unknown";
+    }
+}
+
+static double to_mb(VkDeviceSize bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+void ResourceTracker::init(VkPhysicalDevice physical_device, bool memory_budget) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    physical_device_ = physical_device;
+    memory_budget_ = memory_budget;
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties_);
+    heap_bytes_.assign(memory_properties_.memoryHeapCount, 0);
+}
+
+void ResourceTracker::track(VkDeviceMemory memory, VkDeviceSize size, uint32_t memory_type,
+                            ResourceCategory category) {
+    const VkMemoryType& type = memory_properties_.memoryTypes[memory_type];
+
+    Allocation allocation;
+    allocation.size = size;
+    allocation.heap = type.heapIndex;
+    allocation.category = category;
+    allocation.lazy = (type.propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    allocations_[memory] = allocation;
+
+    ResourceCategoryStats& stats = categories_[static_cast<size_t>(category)];
+    stats.bytes += size;
+    stats.peak_bytes = std::max(stats.peak_bytes, stats.bytes);
+    stats.allocations++;
+
+    if (allocation.heap < heap_bytes_.size()) {
+        heap_bytes_[allocation.heap] += size;
+    }
+    if (allocation.lazy) {
+        lazy_bytes_ += size;
+    }
+    total_allocations_++;
+}
+
+void ResourceTracker::untrack(VkDeviceMemory memory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = allocations_.find(memory);
+    if (it == allocations_.end()) {
+        fprintf(stderr, "Warning: freeing untracked device memory\n");
+        return;
+    }
+
+    const Allocation& allocation = it->second;
+    ResourceCategoryStats& stats = categories_[static_cast<size_t>(allocation.category)];
+    stats.bytes -= allocation.size;
+    stats.allocations--;
+
+    if (allocation.heap < heap_bytes_.size()) {
+        heap_bytes_[allocation.heap] -= allocation.size;
+    }
+    if (allocation.lazy) {
+        lazy_bytes_ -= allocation.size;
+    }
+    allocations_.erase(it);
+}
+
+ResourceCategoryStats ResourceTracker::stats(ResourceCategory category) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return categories_[static_cast<size_t>(category)];
+}
+
+VkDeviceSize ResourceTracker::total_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    VkDeviceSize total = 0;
+    for (const ResourceCategoryStats& stats : categories_) {
+        total += stats.bytes;
+    }
+    return total;
+}
+
+uint32_t ResourceTracker::live_allocations() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<uint32_t>(allocations_.size());
+}
+
+uint64_t ResourceTracker::total_allocations() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_allocations_;
+}
+
+std::vector<MemoryHeapBudget> ResourceTracker::heap_budgets() const {
+    std::vector<MemoryHeapBudget> heaps(memory_properties_.memoryHeapCount);
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+    budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    if (memory_budget_) {
+        VkPhysicalDeviceMemoryProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        properties.pNext = &budget;
+        vkGetPhysicalDeviceMemoryProperties2(physical_device_, &properties);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (uint32_t i = 0; i < heaps.size(); i++) {
+        const VkMemoryHeap& heap = memory_properties_.memoryHeaps[i];
+        heaps[i].size = heap.size;
+        heaps[i].device_local = (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        heaps[i].tracked = heap_bytes_[i];
+        heaps[i].budget = memory_budget_ ? budget.heapBudget[i] : heap.size;
+        heaps[i].usage = memory_budget_ ? budget.heapUsage[i] : heap_bytes_[i];
+    }
+    return heaps;
+}
+
+void ResourceTracker::print_report() const {
+    std::vector<MemoryHeapBudget> heaps = heap_budgets();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    VkDeviceSize total = 0;
+    for (const ResourceCategoryStats& stats : categories_) {
+        total += stats.bytes;
+    }
+
+    printf("=== Device memory: %.1f MB in %zu allocations (%llu made) ===\n",
+        to_mb(total), allocations_.size(), static_cast<unsigned long long>(total_allocations_));
+    printf("  %-16s %10s %10s %8s\n", "category", "MB", "peak MB", "allocs");
+    for (size_t i = 0; i < categories_.size(); i++) {
+        const ResourceCategoryStats& stats = categories_[i];
+        if (stats.peak_bytes == 0) continue;
+        printf("  %-16s %10.2f %10.2f %8u\n", resource_category_name(static_cast<ResourceCategory>(i)),
+            to_mb(stats.bytes), to_mb(stats.peak_bytes), stats.allocations);
+    }
+    if (lazy_bytes_ > 0) {
+        printf("  (%.1f MB lazily allocated, may not be resident)\n", to_mb(lazy_bytes_));
+    }
+
+    for (size_t i = 0; i < heaps.size(); i++) {
+        const MemoryHeapBudget& heap = heaps[i];
+        if (memory_budget_) {
+            printf("  heap %zu%s: %.1f MB tracked, %.1f / %.1f MB used / budget (%.1f MB heap)\n",
+                i, heap.device_local ? " (device local)" : "", to_mb(heap.tracked),
+                to_mb(heap.usage), to_mb(heap.budget), to_mb(heap.size));
+        } else {
+            printf("  heap %zu%s: %.1f MB tracked of %.1f MB\n",
+                i, heap.device_local ? " (device local)" : "", to_mb(heap.tracked), to_mb(heap.size));
+        }
+    }
+    if (!memory_budget_) {
+        printf("  (VK_EXT_memory_budget not available: usage is tracked allocations only)\n");
+    }
+}
+
+} // namespace slam
@@ -0,0 +1,105 @@
+/**
+ * Slam Engine - Resource Tracker
+ *
+ * Accounts for every device memory allocation by category. VulkanContext
+ * owns one; allocate_memory(), free_memory() and create_buffer() report to
+ * it, so subsystems only name the category their memory belongs to. Heap
+ * usage and budget come from VK_EXT_memory_budget when the device has it
+ * (they then include other processes and driver overhead); otherwise only
+ * the heap sizes and our own totals are known.
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace slam {
+
+enum class ResourceCategory : uint32_t {
+    Swapchain,      // Headless offscreen images
+    RenderTargets,  // Render graph transients, temporal history
+    GBuffer,
+    ShadowMaps,
+    Lights,         // Light, cluster and index buffers
+    Meshes,
+    Instances,
+    Textures,
+    Materials,      // Material table
+    Uniforms,
+    Staging,        // Upload and readback buffers (short-lived)
+    Other,
+    Count
+};
+
+const char* resource_category_name(ResourceCategory category);
+
+// Live totals for one category
+struct ResourceCategoryStats {
+    VkDeviceSize bytes = 0;
+    VkDeviceSize peak_bytes = 0;
+    uint32_t allocations = 0;
+};
+
+// One memory heap as the device reports it
+struct MemoryHeapBudget {
+    VkDeviceSize size = 0;
+    VkDeviceSize budget = 0;   // VK_EXT_memory_budget: what this process may use (else size)
+    VkDeviceSize usage = 0;    // VK_EXT_memory_budget: process-wide usage (else tracked bytes)
+    VkDeviceSize tracked = 0;  // Allocations registered with the tracker
+    bool device_local = false;
+};
+
+class ResourceTracker {
+public:
+    ResourceTracker() = default;
+
+    // Non-copyable
+    ResourceTracker(const ResourceTracker&) = delete;
+    ResourceTracker& operator=(const ResourceTracker&) = delete;
+
+    // Read the heap layout; memory_budget: VK_EXT_memory_budget is enabled
+    void init(VkPhysicalDevice physical_device, bool memory_budget);
+
+    // Register and release an allocation (thread-safe)
+    void track(VkDeviceMemory memory, VkDeviceSize size, uint32_t memory_type,
+               ResourceCategory category);
+    void untrack(VkDeviceMemory memory);
+
+    ResourceCategoryStats stats(ResourceCategory category) const;
+    VkDeviceSize total_bytes() const;
+    uint32_t live_allocations() const;
+    uint64_t total_allocations() const;  // Ever made, including freed ones
+
+    // Current per-heap usage and budget
+    std::vector<MemoryHeapBudget> heap_budgets() const;
+    bool has_memory_budget() const { return memory_budget_; }
+
+    // Per-category and per-heap report
+    void print_report() const;
+
+private:
+    struct Allocation {
+        VkDeviceSize size;
+        uint32_t heap;
+        ResourceCategory category;
+        bool lazy;  // Lazily allocated: may never be backed by physical memory
+    };
+
+    VkPhysicalDevice physical_device_ = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties memory_properties_{};
+    bool memory_budget_ = false;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<VkDeviceMemory, Allocation> allocations_;
+    std::array<ResourceCategoryStats, static_cast<size_t>(ResourceCategory::Count)> categories_{};
+    std::vector<VkDeviceSize> heap_bytes_;
+    VkDeviceSize lazy_bytes_ = 0;
+    uint64_t total_allocations_ = 0;
+};
+
+} // namespace slam
@@ -22,6 +22,7 @@ bool ShadowMapArray::init(VulkanContext& context, uint32_t resolution, uint32_t
         fprintf(stderr, "Failed to create shadow cubemap array\n");
         return false;
     }
+    initialize_layout();
 
     if (!create_sampler()) {
         fprintf(stderr, "Failed to create shadow sampler\n");
@@ -76,10 +77,7 @@ void ShadowMapArray::destroy() {
         cubemap_array_ = VK_NULL_HANDLE;
     }
 
-    if (cubemap_memory_) {
-        vkFreeMemory(device, cubemap_memory_, nullptr);
-        cubemap_memory_ = VK_NULL_HANDLE;
-    }
+    context_->free_memory(cubemap_memory_);
 
     context_ = nullptr;
 }
@@ -98,7 +96,8 @@ bool ShadowMapArray::create_cubemap_array() {
     image_info.format = VK_FORMAT_D32_SFLOAT;
     image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
     image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    image_info.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    image_info.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+                       VK_IMAGE_USAGE_TRANSFER_DST_BIT;
     image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     image_info.samples = VK_SAMPLE_COUNT_1_BIT;
 
@@ -116,7 +115,7 @@ bool ShadowMapArray::create_cubemap_array() {
     alloc_info.memoryTypeIndex = context_->find_memory_type(
         mem_req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-    if (vkAllocateMemory(context_->device(), &alloc_info, nullptr, &cubemap_memory_) != VK_SUCCESS) {
+    if (context_->allocate_memory(alloc_info, ResourceCategory::ShadowMaps, cubemap_memory_) != VK_SUCCESS) {
         return false;
     }
 
@@ -160,6 +159,42 @@ bool ShadowMapArray::create_cubemap_array() {
     return true;
 }
 
+// Every face cleared to the far plane and left in SHADER_READ_ONLY, the
+// layout the frame graph imports the array in. Without this, a run that
+// never renders shadows (--no-shadows) binds faces still in UNDEFINED.
+void ShadowMapArray::initialize_layout() {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = cubemap_array_;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 6 * max_lights_;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    VkCommandBuffer cmd = context_->begin_single_time_commands();
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkClearDepthStencilValue far_plane{1.0f, 0};
+    vkCmdClearDepthStencilImage(cmd, cubemap_array_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        &far_plane, 1, &barrier.subresourceRange);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+    context_->end_single_time_commands(cmd);
+}
+
 bool ShadowMapArray::create_render_pass() {
     VkAttachmentDescription depth_attachment{};
     depth_attachment.format = VK_FORMAT_D32_SFLOAT;
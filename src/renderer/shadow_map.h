@@ -41,6 +41,7 @@ public:
     // Getters
     VkRenderPass render_pass() const { return render_pass_; }
     VkFramebuffer framebuffer(uint32_t light_index, uint32_t face) const;
+    VkImage image() const { return cubemap_array_; }
     VkImageView array_view() const { return array_view_; }
     VkSampler sampler() const { return sampler_; }
     uint32_t resolution() const { return resolution_; }
@@ -52,6 +53,7 @@ private:
     bool create_cubemap_array();
     bool create_render_pass();
     bool create_framebuffers();
+    void initialize_layout();
     bool create_sampler();
 
     VulkanContext* context_ = nullptr;
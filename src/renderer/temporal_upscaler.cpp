@@ -0,0 +1,641 @@
+/**
+ * Slam Engine - Temporal Upscaler Implementation
+ */
+
+#include "temporal_upscaler.h"
+#include "vulkan_context.h"
+#include <array>
+#include <cstdio>
+
+namespace slam {
+
+// Jitter pattern length; 8 samples cover a pixel well at 0.5x scale
+constexpr uint32_t JITTER_PHASES = 8;
+
+// Share of the output taken from the reprojected history each frame
+constexpr float HISTORY_WEIGHT = 0.9f;
+
+static float halton(uint32_t index, uint32_t base) {
+    float result = 0.0f;
+    float fraction = 1.0f;
+    while (index > 0) {
+        fraction /= static_cast<float>(base);
+        result += fraction * static_cast<float>(index % base);
+        index /= base;
+    }
+    return result;
+}
+
+TemporalUpscaler::~TemporalUpscaler() {
+    destroy();
+}
+
+bool TemporalUpscaler::init(VulkanContext& context, uint32_t width, uint32_t height,
+                            VkBuffer quad_vertex_buffer) {
+    context_ = &context;
+    width_ = width;
+    height_ = height;
+    quad_vertex_buffer_ = quad_vertex_buffer;
+
+    if (!create_history()) {
+        fprintf(stderr, "Failed to create temporal history\n");
+        return false;
+    }
+
+    if (!create_render_pass() || !create_pipeline()) {
+        fprintf(stderr, "Failed to create temporal resolve pipeline\n");
+        return false;
+    }
+
+    if (!create_framebuffers()) {
+        fprintf(stderr, "Failed to create temporal resolve framebuffers\n");
+        return false;
+    }
+
+    update_history_descriptors();
+    return true;
+}
+
+void TemporalUpscaler::destroy() {
+    if (!context_ || !context_->device()) return;
+
+    VkDevice device = context_->device();
+    vkDeviceWaitIdle(device);
+
+    destroy_framebuffers();
+    destroy_history();
+
+    if (pipeline_) {
+        vkDestroyPipeline(device, pipeline_, nullptr);
+        pipeline_ = VK_NULL_HANDLE;
+    }
+    if (layout_) {
+        vkDestroyPipelineLayout(device, layout_, nullptr);
+        layout_ = VK_NULL_HANDLE;
+    }
+    if (descriptor_pool_) {
+        vkDestroyDescriptorPool(device, descriptor_pool_, nullptr);
+        descriptor_pool_ = VK_NULL_HANDLE;
+    }
+    if (descriptor_layout_) {
+        vkDestroyDescriptorSetLayout(device, descriptor_layout_, nullptr);
+        descriptor_layout_ = VK_NULL_HANDLE;
+    }
+    if (sampler_) {
+        vkDestroySampler(device, sampler_, nullptr);
+        sampler_ = VK_NULL_HANDLE;
+    }
+    if (render_pass_) {
+        vkDestroyRenderPass(device, render_pass_, nullptr);
+        render_pass_ = VK_NULL_HANDLE;
+    }
+
+    context_ = nullptr;
+}
+
+bool TemporalUpscaler::resize(uint32_t width, uint32_t height) {
+    vkDeviceWaitIdle(context_->device());
+
+    destroy_framebuffers();
+    destroy_history();
+
+    width_ = width;
+    height_ = height;
+
+    if (!create_history() || !create_framebuffers()) {
+        return false;
+    }
+
+    update_history_descriptors();
+    return true;
+}
+
+// ============================================================================
+// History
+// ============================================================================
+
+bool TemporalUpscaler::create_history() {
+    VkDevice device = context_->device();
+
+    for (HistoryImage& history : history_) {
+        VkImageCreateInfo image_info{};
+        image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        image_info.imageType = VK_IMAGE_TYPE_2D;
+        image_info.extent.width = width_;
+        image_info.extent.height = height_;
+        image_info.extent.depth = 1;
+        image_info.mipLevels = 1;
+        image_info.arrayLayers = 1;
+        image_info.format = context_->swapchain_format();
+        image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        image_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+
+        if (vkCreateImage(device, &image_info, nullptr, &history.image) != VK_SUCCESS) {
+            return false;
+        }
+
+        VkMemoryRequirements mem_req;
+        vkGetImageMemoryRequirements(device, history.image, &mem_req);
+
+        VkMemoryAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = mem_req.size;
+        alloc_info.memoryTypeIndex = context_->find_memory_type(
+            mem_req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        if (context_->allocate_memory(alloc_info, ResourceCategory::RenderTargets, history.memory) != VK_SUCCESS) {
+            return false;
+        }
+
+        vkBindImageMemory(device, history.image, history.memory, 0);
+
+        VkImageViewCreateInfo view_info{};
+        view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        view_info.image = history.image;
+        view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        view_info.format = context_->swapchain_format();
+        view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        view_info.subresourceRange.levelCount = 1;
+        view_info.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(device, &view_info, nullptr, &history.view) != VK_SUCCESS) {
+            return false;
+        }
+    }
+
+    // The frame graph expects both images in SHADER_READ_ONLY at the start
+    // of a frame. Contents stay undefined until the first resolve, which
+    // ignores them (history_valid_ is clear).
+    VkCommandBuffer cmd = context_->begin_single_time_commands();
+
+    std::array<VkImageMemoryBarrier, 2> barriers{};
+    for (size_t i = 0; i < barriers.size(); i++) {
+        barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[i].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[i].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].image = history_[i].image;
+        barriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barriers[i].subresourceRange.levelCount = 1;
+        barriers[i].subresourceRange.layerCount = 1;
+        barriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    }
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0, 0, nullptr, 0, nullptr,
+                         static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    context_->end_single_time_commands(cmd);
+
+    history_index_ = 0;
+    history_valid_ = false;
+    return true;
+}
+
+void TemporalUpscaler::destroy_history() {
+    VkDevice device = context_->device();
+
+    for (HistoryImage& history : history_) {
+        if (history.view) {
+            vkDestroyImageView(device, history.view, nullptr);
+            history.view = VK_NULL_HANDLE;
+        }
+        if (history.image) {
+            vkDestroyImage(device, history.image, nullptr);
+            history.image = VK_NULL_HANDLE;
+        }
+        context_->free_memory(history.memory);
+    }
+}
+
+// ============================================================================
+// Resolve pass
+// ============================================================================
+
+bool TemporalUpscaler::create_render_pass() {
+    // 0 = swapchain image, 1 = history written this frame. The full-screen
+    // quad covers both, so neither is loaded.
+    std::array<VkAttachmentDescription, 2> attachments{};
+    for (VkAttachmentDescription& attachment : attachments) {
+        attachment.format = context_->swapchain_format();
+        attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+    attachments[0].finalLayout = context_->present_layout();
+    attachments[1].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    std::array<VkAttachmentReference, 2> color_refs{};
+    color_refs[0] = {0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+    color_refs[1] = {1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = static_cast<uint32_t>(color_refs.size());
+    subpass.pColorAttachments = color_refs.data();
+
+    // The previous resolve wrote the history this one samples and sampled
+    // the one it overwrites; it also orders after the image acquire
+    VkSubpassDependency dependency{};
+    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependency.dstSubpass = 0;
+    dependency.srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                              VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                              VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    VkRenderPassCreateInfo render_pass_info{};
+    render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    render_pass_info.attachmentCount = static_cast<uint32_t>(attachments.size());
+    render_pass_info.pAttachments = attachments.data();
+    render_pass_info.subpassCount = 1;
+    render_pass_info.pSubpasses = &subpass;
+    render_pass_info.dependencyCount = 1;
+    render_pass_info.pDependencies = &dependency;
+
+    return vkCreateRenderPass(context_->device(), &render_pass_info, nullptr,
+            &render_pass_) == VK_SUCCESS;
+}
+
+bool TemporalUpscaler::create_pipeline() {
+    VkDevice device = context_->device();
+
+    // Bilinear sampler for scene color and history (depth is fetched)
+    VkSamplerCreateInfo sampler_info{};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = VK_FILTER_LINEAR;
+    sampler_info.minFilter = VK_FILTER_LINEAR;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.maxAnisotropy = 1.0f;
+    sampler_info.minLod = 0.0f;
+    sampler_info.maxLod = 0.0f;
+
+    if (vkCreateSampler(device, &sampler_info, nullptr, &sampler_) != VK_SUCCESS) {
+        return false;
+    }
+
+    // Bindings: 0 = scene color, 1 = depth, 2 = history
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo descriptor_layout_info{};
+    descriptor_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    descriptor_layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
+    descriptor_layout_info.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &descriptor_layout_info, nullptr,
+            &descriptor_layout_) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkDescriptorPoolSize pool_size{};
+    pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    pool_size.descriptorCount = 6;  // 3 per set
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.poolSizeCount = 1;
+    pool_info.pPoolSizes = &pool_size;
+    pool_info.maxSets = 2;
+
+    if (vkCreateDescriptorPool(device, &pool_info, nullptr, &descriptor_pool_) != VK_SUCCESS) {
+        return false;
+    }
+
+    std::array<VkDescriptorSetLayout, 2> set_layouts = {descriptor_layout_, descriptor_layout_};
+
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = descriptor_pool_;
+    alloc_info.descriptorSetCount = static_cast<uint32_t>(set_layouts.size());
+    alloc_info.pSetLayouts = set_layouts.data();
+
+    if (vkAllocateDescriptorSets(device, &alloc_info, descriptor_sets_) != VK_SUCCESS) {
+        return false;
+    }
+
+    // Shaders: the lighting pass's full-screen quad vertex shader
+    auto vert_code = context_->load_shader("shaders/lighting.vert.spv");
+    auto frag_code = context_->load_shader("shaders/temporal.frag.spv");
+
+    if (vert_code.empty() || frag_code.empty()) {
+        fprintf(stderr, "Failed to load temporal resolve shaders\n");
+        return false;
+    }
+
+    VkShaderModule vert_module = context_->create_shader_module(vert_code);
+    VkShaderModule frag_module = context_->create_shader_module(frag_code);
+
+    VkPipelineShaderStageCreateInfo shader_stages[2]{};
+    shader_stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shader_stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shader_stages[0].module = vert_module;
+    shader_stages[0].pName = "main";
+
+    shader_stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shader_stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shader_stages[1].module = frag_module;
+    shader_stages[1].pName = "main";
+
+    VkVertexInputBindingDescription vertex_binding{};
+    vertex_binding.binding = 0;
+    vertex_binding.stride = sizeof(float) * 4;  // pos.xy, uv.xy
+    vertex_binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    std::array<VkVertexInputAttributeDescription, 2> attributes{};
+    attributes[0] = {0, 0, VK_FORMAT_R32G32_SFLOAT, 0};
+    attributes[1] = {1, 0, VK_FORMAT_R32G32_SFLOAT, sizeof(float) * 2};
+
+    VkPipelineVertexInputStateCreateInfo vertex_input{};
+    vertex_input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertex_input.vertexBindingDescriptionCount = 1;
+    vertex_input.pVertexBindingDescriptions = &vertex_binding;
+    vertex_input.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributes.size());
+    vertex_input.pVertexAttributeDescriptions = attributes.data();
+
+    VkPipelineInputAssemblyStateCreateInfo input_assembly{};
+    input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo viewport_state{};
+    viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewport_state.viewportCount = 1;
+    viewport_state.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depth_stencil{};
+    depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depth_stencil.depthTestEnable = VK_FALSE;
+    depth_stencil.depthWriteEnable = VK_FALSE;
+
+    // Swapchain and history get the same color
+    std::array<VkPipelineColorBlendAttachmentState, 2> blend_attachments{};
+    for (auto& att : blend_attachments) {
+        att.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                             VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        att.blendEnable = VK_FALSE;
+    }
+
+    VkPipelineColorBlendStateCreateInfo color_blend{};
+    color_blend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    color_blend.attachmentCount = static_cast<uint32_t>(blend_attachments.size());
+    color_blend.pAttachments = blend_attachments.data();
+
+    std::array<VkDynamicState, 2> dynamic_states = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamic_state{};
+    dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic_state.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
+    dynamic_state.pDynamicStates = dynamic_states.data();
+
+    VkPushConstantRange push_range{};
+    push_range.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    push_range.offset = 0;
+    push_range.size = sizeof(TemporalPushConstants);
+
+    VkPipelineLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layout_info.setLayoutCount = 1;
+    layout_info.pSetLayouts = &descriptor_layout_;
+    layout_info.pushConstantRangeCount = 1;
+    layout_info.pPushConstantRanges = &push_range;
+
+    if (vkCreatePipelineLayout(device, &layout_info, nullptr, &layout_) != VK_SUCCESS) {
+        vkDestroyShaderModule(device, vert_module, nullptr);
+        vkDestroyShaderModule(device, frag_module, nullptr);
+        return false;
+    }
+
+    VkGraphicsPipelineCreateInfo pipeline_info{};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipeline_info.stageCount = 2;
+    pipeline_info.pStages = shader_stages;
+    pipeline_info.pVertexInputState = &vertex_input;
+    pipeline_info.pInputAssemblyState = &input_assembly;
+    pipeline_info.pViewportState = &viewport_state;
+    pipeline_info.pRasterizationState = &rasterizer;
+    pipeline_info.pMultisampleState = &multisampling;
+    pipeline_info.pDepthStencilState = &depth_stencil;
+    pipeline_info.pColorBlendState = &color_blend;
+    pipeline_info.pDynamicState = &dynamic_state;
+    pipeline_info.layout = layout_;
+    pipeline_info.renderPass = render_pass_;
+    pipeline_info.subpass = 0;
+
+    VkResult result = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE,
+        1, &pipeline_info, nullptr, &pipeline_);
+
+    vkDestroyShaderModule(device, vert_module, nullptr);
+    vkDestroyShaderModule(device, frag_module, nullptr);
+
+    return result == VK_SUCCESS;
+}
+
+bool TemporalUpscaler::create_framebuffers() {
+    const std::vector<VkImageView>& swapchain_views = context_->swapchain_image_views();
+    framebuffers_.assign(swapchain_views.size() * 2, VK_NULL_HANDLE);
+    swapchain_generation_ = context_->swapchain_generation();
+
+    for (size_t image = 0; image < swapchain_views.size(); image++) {
+        for (uint32_t history = 0; history < 2; history++) {
+            std::array<VkImageView, 2> views = {swapchain_views[image], history_[history].view};
+
+            VkFramebufferCreateInfo framebuffer_info{};
+            framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebuffer_info.renderPass = render_pass_;
+            framebuffer_info.attachmentCount = static_cast<uint32_t>(views.size());
+            framebuffer_info.pAttachments = views.data();
+            framebuffer_info.width = width_;
+            framebuffer_info.height = height_;
+            framebuffer_info.layers = 1;
+
+            if (vkCreateFramebuffer(context_->device(), &framebuffer_info, nullptr,
+                    &framebuffers_[image * 2 + history]) != VK_SUCCESS) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void TemporalUpscaler::destroy_framebuffers() {
+    for (VkFramebuffer framebuffer : framebuffers_) {
+        if (framebuffer) {
+            vkDestroyFramebuffer(context_->device(), framebuffer, nullptr);
+        }
+    }
+    framebuffers_.clear();
+}
+
+void TemporalUpscaler::update_history_descriptors() {
+    // The set used while writing history i samples the other image
+    for (uint32_t i = 0; i < 2; i++) {
+        VkDescriptorImageInfo image_info{};
+        image_info.sampler = sampler_;
+        image_info.imageView = history_[i ^ 1].view;
+        image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = descriptor_sets_[i];
+        write.dstBinding = 2;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &image_info;
+
+        vkUpdateDescriptorSets(context_->device(), 1, &write, 0, nullptr);
+    }
+}
+
+void TemporalUpscaler::set_sources(VkImageView scene_color, const VkDescriptorImageInfo& depth) {
+    VkDescriptorImageInfo scene_info{};
+    scene_info.sampler = sampler_;
+    scene_info.imageView = scene_color;
+    scene_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    std::array<VkWriteDescriptorSet, 4> writes{};
+    for (uint32_t i = 0; i < 2; i++) {
+        writes[i * 2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i * 2].dstSet = descriptor_sets_[i];
+        writes[i * 2].dstBinding = 0;
+        writes[i * 2].descriptorCount = 1;
+        writes[i * 2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[i * 2].pImageInfo = &scene_info;
+
+        writes[i * 2 + 1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i * 2 + 1].dstSet = descriptor_sets_[i];
+        writes[i * 2 + 1].dstBinding = 1;
+        writes[i * 2 + 1].descriptorCount = 1;
+        writes[i * 2 + 1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[i * 2 + 1].pImageInfo = &depth;
+    }
+
+    vkUpdateDescriptorSets(context_->device(), static_cast<uint32_t>(writes.size()),
+                          writes.data(), 0, nullptr);
+
+    // Reallocated inputs usually mean a resize; old history no longer lines up
+    history_valid_ = false;
+}
+
+// ============================================================================
+// Per frame
+// ============================================================================
+
+mat4 TemporalUpscaler::jitter_projection(const mat4& view, const mat4& proj,
+                                         uint32_t render_width, uint32_t render_height) {
+    view_proj_ = proj * view;
+
+    // Sub-pixel offset in [-0.5, 0.5] render pixels, as an NDC offset
+    frame_index_ = (frame_index_ + 1) % JITTER_PHASES;
+    float offset_x = halton(frame_index_ + 1, 2) - 0.5f;
+    float offset_y = halton(frame_index_ + 1, 3) - 0.5f;
+    jitter_ = vec2(offset_x * 2.0f / static_cast<float>(render_width),
+                   offset_y * 2.0f / static_cast<float>(render_height));
+
+    // Shift clip xy by jitter * w so it survives the perspective divide
+    mat4 jittered = proj;
+    for (int col = 0; col < 4; col++) {
+        jittered[col][0] += jitter_.x * proj[col][3];
+        jittered[col][1] += jitter_.y * proj[col][3];
+    }
+    return jittered;
+}
+
+void TemporalUpscaler::resolve(VkCommandBuffer cmd, uint32_t render_width, uint32_t render_height) {
+    // Framebuffers reference the swapchain views
+    if (swapchain_generation_ != context_->swapchain_generation()) {
+        destroy_framebuffers();
+        if (!create_framebuffers()) {
+            fprintf(stderr, "Failed to recreate temporal resolve framebuffers\n");
+            return;
+        }
+    }
+
+    VkRenderPassBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    begin_info.renderPass = render_pass_;
+    begin_info.framebuffer = framebuffers_[context_->current_image_index() * 2 + history_index_];
+    begin_info.renderArea.offset = {0, 0};
+    begin_info.renderArea.extent = {width_, height_};
+
+    vkCmdBeginRenderPass(cmd, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout_,
+                           0, 1, &descriptor_sets_[history_index_], 0, nullptr);
+
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(width_);
+    viewport.height = static_cast<float>(height_);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = {width_, height_};
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+    float width = static_cast<float>(width_);
+    float height = static_cast<float>(height_);
+
+    TemporalPushConstants push{};
+    push.reprojection = prev_view_proj_ * view_proj_.inverse();
+    push.uv_scale = vec4(static_cast<float>(render_width) / width,
+                         static_cast<float>(render_height) / height,
+                         (static_cast<float>(render_width) - 0.5f) / width,
+                         (static_cast<float>(render_height) - 0.5f) / height);
+    // NDC [-1, 1] spans the rendered region, so half the offset in its UVs
+    push.jitter = vec4(jitter_.x * 0.5f * push.uv_scale.x, jitter_.y * 0.5f * push.uv_scale.y,
+                       HISTORY_WEIGHT, history_valid_ ? 1.0f : 0.0f);
+
+    vkCmdPushConstants(cmd, layout_, VK_SHADER_STAGE_FRAGMENT_BIT,
+                       0, sizeof(TemporalPushConstants), &push);
+
+    VkBuffer vertex_buffers[] = {quad_vertex_buffer_};
+    VkDeviceSize offsets[] = {0};
+    vkCmdBindVertexBuffers(cmd, 0, 1, vertex_buffers, offsets);
+    vkCmdDraw(cmd, 6, 1, 0, 0);
+
+    vkCmdEndRenderPass(cmd);
+
+    // This frame's output is next frame's history
+    prev_view_proj_ = view_proj_;
+    history_valid_ = true;
+    history_index_ ^= 1;
+}
+
+} // namespace slam
@@ -0,0 +1,119 @@
+/**
+ * Slam Engine - Temporal Upscaler
+ *
+ * Reconstructs a full-resolution image from reduced-resolution lighting.
+ * Each frame's projection is offset by a sub-pixel jitter (Halton 2,3), so
+ * successive low-resolution frames sample different points of every output
+ * pixel. The resolve pass reprojects the previous output (the history) into
+ * the current frame, clamps it to the colour range of the new samples
+ * around each pixel and blends the two, writing both the swapchain image
+ * and the next frame's history in one render pass.
+ *
+ * Motion comes from depth and the previous frame's view-projection, which
+ * covers everything that moves in the scene (the camera); the clamp rejects
+ * history where lighting or disocclusion changed the result.
+ */
+
+#pragma once
+
+#include "utils/math.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+namespace slam {
+
+class VulkanContext;
+
+// Push constants for the resolve pass (must match temporal.frag)
+struct TemporalPushConstants {
+    mat4 reprojection;  // Current clip -> previous frame's clip (unjittered)
+    vec4 uv_scale;      // xy = render size / image size, zw = UV clamp
+    vec4 jitter;        // xy = jitter in scene UV, z = history weight, w = 1 if history is valid
+};
+
+class TemporalUpscaler {
+public:
+    TemporalUpscaler() = default;
+    ~TemporalUpscaler();
+
+    // Non-copyable
+    TemporalUpscaler(const TemporalUpscaler&) = delete;
+    TemporalUpscaler& operator=(const TemporalUpscaler&) = delete;
+
+    // Create the history images (output size), render pass and pipeline.
+    // quad_vertex_buffer is the full-screen quad shared with the lighting pass.
+    bool init(VulkanContext& context, uint32_t width, uint32_t height, VkBuffer quad_vertex_buffer);
+
+    // Cleanup
+    void destroy();
+
+    // Recreate the history for a new output size (discards it)
+    bool resize(uint32_t width, uint32_t height);
+
+    // Point the resolve at this frame's inputs (after they are reallocated)
+    void set_sources(VkImageView scene_color, const VkDescriptorImageInfo& depth);
+
+    // Start a frame: remember the camera for reprojection, advance the
+    // jitter and return proj offset by it (render size in pixels)
+    mat4 jitter_projection(const mat4& view, const mat4& proj,
+                           uint32_t render_width, uint32_t render_height);
+
+    // Record the resolve into the current swapchain image and the history.
+    // Call once per frame, after jitter_projection().
+    void resolve(VkCommandBuffer cmd, uint32_t render_width, uint32_t render_height);
+
+    // Drop the history (camera cut, resize); the next frame is a plain upscale
+    void invalidate() { history_valid_ = false; }
+
+    // History images: the resolve reads history_read() and writes history_write()
+    VkImage history_read() const { return history_[history_index_ ^ 1].image; }
+    VkImage history_write() const { return history_[history_index_].image; }
+
+    vec2 jitter() const { return jitter_; }
+
+private:
+    struct HistoryImage {
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+    };
+
+    bool create_history();
+    void destroy_history();
+    bool create_render_pass();
+    bool create_pipeline();
+    bool create_framebuffers();
+    void destroy_framebuffers();
+    void update_history_descriptors();
+
+    VulkanContext* context_ = nullptr;
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+    VkBuffer quad_vertex_buffer_ = VK_NULL_HANDLE;
+
+    // Ping-pong history; both rest in SHADER_READ_ONLY between frames
+    HistoryImage history_[2];
+    uint32_t history_index_ = 0;  // Written this frame
+    bool history_valid_ = false;
+
+    // One framebuffer per swapchain image and history image
+    VkRenderPass render_pass_ = VK_NULL_HANDLE;
+    std::vector<VkFramebuffer> framebuffers_;
+    uint32_t swapchain_generation_ = 0;
+
+    VkSampler sampler_ = VK_NULL_HANDLE;
+    VkDescriptorSetLayout descriptor_layout_ = VK_NULL_HANDLE;
+    VkDescriptorPool descriptor_pool_ = VK_NULL_HANDLE;
+    VkDescriptorSet descriptor_sets_[2] = {};  // Indexed by the history written
+    VkPipelineLayout layout_ = VK_NULL_HANDLE;
+    VkPipeline pipeline_ = VK_NULL_HANDLE;
+
+    // Camera state
+    uint32_t frame_index_ = 0;
+    vec2 jitter_;  // NDC offset applied this frame
+    mat4 view_proj_;
+    mat4 prev_view_proj_;
+};
+
+} // namespace slam
@@ -4,6 +4,8 @@
 
 #include "texture.h"
 #include "vulkan_context.h"
+#include "texture_loader.h"
+#include <algorithm>
 #include <fstream>
 #include <cstring>
 #include <cstdio>
@@ -23,7 +25,10 @@ Texture::Texture(Texture&& other) noexcept
     , image_view_(other.image_view_)
     , sampler_(other.sampler_)
     , width_(other.width_)
-    , height_(other.height_) {
+    , height_(other.height_)
+    , mip_levels_(other.mip_levels_)
+    , format_(other.format_)
+    , memory_size_(other.memory_size_) {
     other.context_ = nullptr;
     other.image_ = VK_NULL_HANDLE;
     other.image_memory_ = VK_NULL_HANDLE;
@@ -41,6 +46,9 @@ Texture& Texture::operator=(Texture&& other) noexcept {
         sampler_ = other.sampler_;
         width_ = other.width_;
         height_ = other.height_;
+        mip_levels_ = other.mip_levels_;
+        format_ = other.format_;
+        memory_size_ = other.memory_size_;
         other.context_ = nullptr;
         other.image_ = VK_NULL_HANDLE;
         other.image_memory_ = VK_NULL_HANDLE;
@@ -64,25 +72,86 @@ void Texture::destroy() {
             vkDestroyImage(context_->device(), image_, nullptr);
             image_ = VK_NULL_HANDLE;
         }
-        if (image_memory_) {
-            vkFreeMemory(context_->device(), image_memory_, nullptr);
-            image_memory_ = VK_NULL_HANDLE;
-        }
+        context_->free_memory(image_memory_);
     }
+    memory_size_ = 0;
     context_ = nullptr;
 }
 
-bool Texture::load_tga(VulkanContext& context, const std::string& path) {
-    std::ifstream file(path, std::ios::binary);
+bool Texture::load_tga(VulkanContext& context, const std::string& path, bool srgb) {
+    TextureData data;
+    return decode_tga(path, data, srgb) && upload_now(context, data);
+}
+
+bool Texture::load_rgba(VulkanContext& context, const uint8_t* data, int width, int height) {
+    TextureData texture_data;
+    texture_data.format = VK_FORMAT_R8G8B8A8_SRGB;
+    texture_data.width = width;
+    texture_data.height = height;
+    texture_data.generate_mips = true;
+    texture_data.bytes.assign(data, data + static_cast<size_t>(width) * height * 4);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
+    texture_data.regions.push_back(region);
+
+    return upload_now(context, texture_data);
+}
+
+bool Texture::create_solid(VulkanContext& context, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    TextureData data;
+    decode_solid(r, g, b, a, data);
+    return upload_now(context, data);
+}
+
+bool Texture::load_ktx2(VulkanContext& context, const std::string& path) {
+    TextureData data;
+    if (!decode_ktx2(path, data)) {
+        return false;
+    }
+
+    if (!format_supported(context, data.format)) {
+        fprintf(stderr, "KTX2 format %d not supported by device: %s\n",
+                static_cast<int>(data.format), path.c_str());
+        return false;
+    }
+
+    return upload_now(context, data);
+}
+
+bool Texture::format_supported(const VulkanContext& context, VkFormat format) {
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(context.physical_device(), format, &properties);
+    return (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+bool Texture::decode_tga(const std::string& path, TextureData& data, bool srgb) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         fprintf(stderr, "Failed to open texture file: %s\n", path.c_str());
         return false;
     }
 
-    // Read TGA header
-    uint8_t header[18];
-    file.read(reinterpret_cast<char*>(header), 18);
+    // One read for the whole file
+    std::vector<uint8_t> bytes(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
 
+    if (bytes.size() < 18) {
+        fprintf(stderr, "Truncated TGA file: %s\n", path.c_str());
+        return false;
+    }
+
+    // TGA header
+    const uint8_t* header = bytes.data();
     int id_length = header[0];
     int color_map_type = header[1];
     int image_type = header[2];
@@ -91,13 +160,9 @@ bool Texture::load_tga(VulkanContext& context, const std::string& path) {
     int bits_per_pixel = header[16];
     int descriptor = header[17];
 
-    // Skip ID field
-    if (id_length > 0) {
-        file.seekg(id_length, std::ios::cur);
-    }
-
     // Only support uncompressed RGB/RGBA
-    if (color_map_type != 0 || (image_type != 2 && image_type != 3)) {
+    if (color_map_type != 0 || (image_type != 2 && image_type != 3) ||
+        (bits_per_pixel != 24 && bits_per_pixel != 32)) {
         fprintf(stderr, "Unsupported TGA format in: %s\n", path.c_str());
         return false;
     }
@@ -105,75 +170,201 @@ bool Texture::load_tga(VulkanContext& context, const std::string& path) {
     bool has_alpha = (bits_per_pixel == 32);
     int bytes_per_pixel = bits_per_pixel / 8;
 
-    // Read pixel data
-    std::vector<uint8_t> raw_data(width * height * bytes_per_pixel);
-    file.read(reinterpret_cast<char*>(raw_data.data()), raw_data.size());
+    size_t pixel_offset = 18 + id_length;
+    if (bytes.size() < pixel_offset + static_cast<size_t>(width) * height * bytes_per_pixel) {
+        fprintf(stderr, "Truncated TGA file: %s\n", path.c_str());
+        return false;
+    }
 
     // Convert to RGBA
-    std::vector<uint8_t> rgba_data(width * height * 4);
+    data.format = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    data.width = width;
+    data.height = height;
+    data.mip_levels = 1;
+    data.generate_mips = true;
+    data.bytes.resize(static_cast<size_t>(width) * height * 4);
 
     bool bottom_up = !(descriptor & 0x20);
 
     for (int y = 0; y < height; y++) {
         int src_y = bottom_up ? (height - 1 - y) : y;
-        for (int x = 0; x < width; x++) {
-            int src_idx = (src_y * width + x) * bytes_per_pixel;
-            int dst_idx = (y * width + x) * 4;
+        const uint8_t* src = &bytes[pixel_offset + static_cast<size_t>(src_y) * width * bytes_per_pixel];
+        uint8_t* dst = &data.bytes[static_cast<size_t>(y) * width * 4];
 
+        for (int x = 0; x < width; x++) {
             // TGA stores BGRA
-            rgba_data[dst_idx + 0] = raw_data[src_idx + 2]; // R
-            rgba_data[dst_idx + 1] = raw_data[src_idx + 1]; // G
-            rgba_data[dst_idx + 2] = raw_data[src_idx + 0]; // B
-            rgba_data[dst_idx + 3] = has_alpha ? raw_data[src_idx + 3] : 255; // A
+            dst[0] = src[2]; // R
+            dst[1] = src[1]; // G
+            dst[2] = src[0]; // B
+            dst[3] = has_alpha ? src[3] : 255; // A
+            src += bytes_per_pixel;
+            dst += 4;
         }
     }
 
-    return load_rgba(context, rgba_data.data(), width, height);
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
+    data.regions.assign(1, region);
+    return true;
 }
 
-bool Texture::load_rgba(VulkanContext& context, const uint8_t* data, int width, int height) {
-    context_ = &context;
-    width_ = width;
-    height_ = height;
+bool Texture::decode_ktx2(const std::string& path, TextureData& data) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;  // Optional variant; callers fall back to other files
+    }
+
+    std::vector<uint8_t> bytes(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+
+    static const uint8_t KTX2_IDENTIFIER[12] = {
+        0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'
+    };
+
+    auto read_u32 = [&](size_t offset) {
+        uint32_t value;
+        memcpy(&value, &bytes[offset], sizeof(value));
+        return value;
+    };
+    auto read_u64 = [&](size_t offset) {
+        uint64_t value;
+        memcpy(&value, &bytes[offset], sizeof(value));
+        return value;
+    };
+
+    // Identifier, 9-word header, 32-byte index, then the level index
+    const size_t HEADER_SIZE = 80;
+    if (bytes.size() < HEADER_SIZE || memcmp(bytes.data(), KTX2_IDENTIFIER, 12) != 0) {
+        fprintf(stderr, "Not a KTX2 file: %s\n", path.c_str());
+        return false;
+    }
+
+    VkFormat format = static_cast<VkFormat>(read_u32(12));
+    uint32_t width = read_u32(20);
+    uint32_t height = read_u32(24);
+    uint32_t depth = read_u32(28);
+    uint32_t layers = read_u32(32);
+    uint32_t faces = read_u32(36);
+    uint32_t levels = std::max(read_u32(40), 1u);
+    uint32_t supercompression = read_u32(44);
+
+    if (format == VK_FORMAT_UNDEFINED || supercompression != 0 || depth > 1 || layers > 1 ||
+        faces != 1 || width == 0 || height == 0) {
+        fprintf(stderr, "Unsupported KTX2 layout in: %s\n", path.c_str());
+        return false;
+    }
+
+    if (bytes.size() < HEADER_SIZE + levels * 24) {
+        fprintf(stderr, "Truncated KTX2 level index in: %s\n", path.c_str());
+        return false;
+    }
+
+    // One copy per level straight out of the file image (KTX2 aligns level
+    // data to the texel block size)
+    std::vector<VkBufferImageCopy> regions(levels);
+    for (uint32_t level = 0; level < levels; level++) {
+        uint64_t offset = read_u64(HEADER_SIZE + level * 24);
+        uint64_t length = read_u64(HEADER_SIZE + level * 24 + 8);
+        if (offset + length > bytes.size()) {
+            fprintf(stderr, "Truncated KTX2 level data in: %s\n", path.c_str());
+            return false;
+        }
+
+        VkBufferImageCopy& region = regions[level];
+        region.bufferOffset = offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {std::max(width >> level, 1u), std::max(height >> level, 1u), 1};
+    }
 
-    return create_image(context, width, height, data);
+    data.format = format;
+    data.width = static_cast<int>(width);
+    data.height = static_cast<int>(height);
+    data.mip_levels = levels;
+    data.generate_mips = false;
+    data.bytes = std::move(bytes);
+    data.regions = std::move(regions);
+    return true;
 }
 
-bool Texture::create_solid(VulkanContext& context, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
-    uint8_t pixel[4] = {r, g, b, a};
-    return load_rgba(context, pixel, 1, 1);
+void Texture::decode_solid(uint8_t r, uint8_t g, uint8_t b, uint8_t a, TextureData& data, bool srgb) {
+    data.format = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    data.width = 1;
+    data.height = 1;
+    data.mip_levels = 1;
+    data.generate_mips = false;
+    data.bytes = {r, g, b, a};
+
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {1, 1, 1};
+    data.regions.assign(1, region);
 }
 
-bool Texture::create_image(VulkanContext& context, int width, int height, const uint8_t* data) {
-    VkDeviceSize image_size = width * height * 4;
+// ============================================================================
+// Device resources
+// ============================================================================
 
-    // Create staging buffer
-    VkBuffer staging_buffer;
-    VkDeviceMemory staging_memory;
-    context.create_buffer(image_size,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        staging_buffer, staging_memory);
+bool Texture::allocate(VulkanContext& context, const TextureData& data) {
+    destroy();
+    context_ = &context;
+    width_ = data.width;
+    height_ = data.height;
+    mip_levels_ = data.mip_levels;
+
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+    if (data.generate_mips) {
+        // Full chain down to 1x1, if the format can be linearly blitted
+        VkFormatProperties format_properties;
+        vkGetPhysicalDeviceFormatProperties(context.physical_device(), data.format, &format_properties);
+        bool can_blit = (format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) &&
+                        (format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_SRC_BIT) &&
+                        (format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT);
+
+        mip_levels_ = 1;
+        if (can_blit) {
+            for (int size = std::max(data.width, data.height); size > 1; size /= 2) {
+                mip_levels_++;
+            }
+            usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        }
+    }
 
-    // Copy data to staging buffer
-    void* mapped;
-    vkMapMemory(context.device(), staging_memory, 0, image_size, 0, &mapped);
-    memcpy(mapped, data, image_size);
-    vkUnmapMemory(context.device(), staging_memory);
+    if (!create_storage(context, data.format, usage) || !create_view_and_sampler(context)) {
+        // Release whatever was created before the failure
+        destroy();
+        return false;
+    }
+    return true;
+}
+
+bool Texture::create_storage(VulkanContext& context, VkFormat format, VkImageUsageFlags usage) {
+    format_ = format;
 
     // Create image
     VkImageCreateInfo image_info{};
     image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     image_info.imageType = VK_IMAGE_TYPE_2D;
-    image_info.extent.width = width;
-    image_info.extent.height = height;
+    image_info.extent.width = width_;
+    image_info.extent.height = height_;
     image_info.extent.depth = 1;
-    image_info.mipLevels = 1;
+    image_info.mipLevels = mip_levels_;
     image_info.arrayLayers = 1;
-    image_info.format = VK_FORMAT_R8G8B8A8_SRGB;
+    image_info.format = format;
     image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
     image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    image_info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    image_info.usage = usage;
     image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     image_info.samples = VK_SAMPLE_COUNT_1_BIT;
 
@@ -192,52 +383,100 @@ bool Texture::create_image(VulkanContext& context, int width, int height, const
     alloc_info.memoryTypeIndex = context.find_memory_type(
         mem_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-    if (vkAllocateMemory(context.device(), &alloc_info, nullptr, &image_memory_) != VK_SUCCESS) {
+    if (context.allocate_memory(alloc_info, ResourceCategory::Textures, image_memory_) != VK_SUCCESS) {
         fprintf(stderr, "Failed to allocate texture memory\n");
         return false;
     }
 
     vkBindImageMemory(context.device(), image_, image_memory_, 0);
+    memory_size_ = mem_requirements.size;
+    return true;
+}
 
-    // Transition to transfer destination
-    transition_image_layout(context, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+void Texture::record_upload(VkCommandBuffer cmd, VkBuffer staging_buffer, VkDeviceSize staging_offset,
+                            const TextureData& data) {
+    // All levels to transfer destination
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image_;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = mip_levels_;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 
-    // Copy buffer to image
-    VkCommandBuffer cmd = context.begin_single_time_commands();
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
 
-    VkBufferImageCopy region{};
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-    region.imageOffset = {0, 0, 0};
-    region.imageExtent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
+    std::vector<VkBufferImageCopy> regions = data.regions;
+    for (VkBufferImageCopy& region : regions) {
+        region.bufferOffset += staging_offset;
+    }
 
     vkCmdCopyBufferToImage(cmd, staging_buffer, image_,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
 
-    context.end_single_time_commands(cmd);
+    if (data.generate_mips) {
+        // Blit the chain; leaves every level in SHADER_READ_ONLY
+        generate_mipmaps(cmd);
+    } else {
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-    // Transition to shader read
-    transition_image_layout(context, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+}
+
+bool Texture::upload_now(VulkanContext& context, const TextureData& data) {
+    if (!allocate(context, data)) {
+        return false;
+    }
+
+    // Create staging buffer
+    VkDeviceSize size = data.bytes.size();
+    VkBuffer staging_buffer;
+    VkDeviceMemory staging_memory;
+    context.create_buffer(size,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        staging_buffer, staging_memory, ResourceCategory::Staging);
+
+    // Copy data to staging buffer
+    void* mapped;
+    vkMapMemory(context.device(), staging_memory, 0, size, 0, &mapped);
+    memcpy(mapped, data.bytes.data(), size);
+    vkUnmapMemory(context.device(), staging_memory);
+
+    // Upload (and mip generation) in one submission
+    VkCommandBuffer cmd = context.begin_single_time_commands();
+    record_upload(cmd, staging_buffer, 0, data);
+    context.end_single_time_commands(cmd);
 
     // Cleanup staging buffer
     vkDestroyBuffer(context.device(), staging_buffer, nullptr);
-    vkFreeMemory(context.device(), staging_memory, nullptr);
+    context.free_memory(staging_memory);
+    return true;
+}
 
+bool Texture::create_view_and_sampler(VulkanContext& context) {
     // Create image view
     VkImageViewCreateInfo view_info{};
     view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     view_info.image = image_;
     view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
-    view_info.format = VK_FORMAT_R8G8B8A8_SRGB;
+    view_info.format = format_;
     view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     view_info.subresourceRange.baseMipLevel = 0;
-    view_info.subresourceRange.levelCount = 1;
+    view_info.subresourceRange.levelCount = mip_levels_;
     view_info.subresourceRange.baseArrayLayer = 0;
     view_info.subresourceRange.layerCount = 1;
 
@@ -260,6 +499,9 @@ bool Texture::create_image(VulkanContext& context, int width, int height, const
     sampler_info.unnormalizedCoordinates = VK_FALSE;
     sampler_info.compareEnable = VK_FALSE;
     sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    sampler_info.minLod = 0.0f;
+    sampler_info.maxLod = static_cast<float>(mip_levels_);
+    sampler_info.mipLodBias = 0.0f;
 
     if (vkCreateSampler(context.device(), &sampler_info, nullptr, &sampler_) != VK_SUCCESS) {
         fprintf(stderr, "Failed to create texture sampler\n");
@@ -269,42 +511,75 @@ bool Texture::create_image(VulkanContext& context, int width, int height, const
     return true;
 }
 
-void Texture::transition_image_layout(VulkanContext& context, VkImageLayout old_layout, VkImageLayout new_layout) {
-    VkCommandBuffer cmd = context.begin_single_time_commands();
-
+void Texture::generate_mipmaps(VkCommandBuffer cmd) {
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = old_layout;
-    barrier.newLayout = new_layout;
     barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.image = image_;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
     barrier.subresourceRange.levelCount = 1;
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = 1;
 
-    VkPipelineStageFlags src_stage, dst_stage;
+    int32_t mip_width = width_;
+    int32_t mip_height = height_;
 
-    if (old_layout == VK_IMAGE_LAYOUT_UNDEFINED && new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        src_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        dst_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    } else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+    for (uint32_t level = 1; level < mip_levels_; level++) {
+        // Previous level: written -> blit source
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
         barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        int32_t next_width = std::max(mip_width / 2, 1);
+        int32_t next_height = std::max(mip_height / 2, 1);
+
+        VkImageBlit blit{};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = level - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = 1;
+        blit.srcOffsets[0] = {0, 0, 0};
+        blit.srcOffsets[1] = {mip_width, mip_height, 1};
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel = level;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstSubresource.layerCount = 1;
+        blit.dstOffsets[0] = {0, 0, 0};
+        blit.dstOffsets[1] = {next_width, next_height, 1};
+
+        vkCmdBlitImage(cmd,
+            image_, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            image_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &blit, VK_FILTER_LINEAR);
+
+        // Previous level is final
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
         barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        src_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        dst_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    } else {
-        src_stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-        dst_stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        mip_width = next_width;
+        mip_height = next_height;
     }
 
-    vkCmdPipelineBarrier(cmd, src_stage, dst_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    // Last level was only written
+    barrier.subresourceRange.baseMipLevel = mip_levels_ - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-    context.end_single_time_commands(cmd);
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
 }
 
 VkDescriptorImageInfo Texture::descriptor_info() const {
@@ -319,40 +594,73 @@ VkDescriptorImageInfo Texture::descriptor_info() const {
 // Material
 // ============================================================================
 
+// Best available encoding of one material map: compressed containers the
+// device can sample first, then the baker's TGA
+static bool load_material_map(Texture& texture, VulkanContext& context, const std::string& base_path,
+                              bool srgb) {
+    if (context.supports_astc() && texture.load_ktx2(context, base_path + ".astc.ktx2")) {
+        return true;
+    }
+    if (context.supports_bc() && texture.load_ktx2(context, base_path + ".bc.ktx2")) {
+        return true;
+    }
+    return texture.load_tga(context, base_path + ".tga", srgb);
+}
+
 bool Material::load(VulkanContext& context, const std::string& directory, const std::string& material_name) {
     std::string base_path = directory + "/" + material_name;
 
     bool success = true;
 
-    if (!albedo.load_tga(context, base_path + "_albedo.tga")) {
+    if (!load_material_map(albedo, context, base_path + "_albedo", true)) {
         fprintf(stderr, "Failed to load albedo texture for %s\n", material_name.c_str());
         success = false;
     }
 
-    if (!normal.load_tga(context, base_path + "_normal.tga")) {
+    if (!load_material_map(normal, context, base_path + "_normal", false)) {
         fprintf(stderr, "Warning: No normal map for %s\n", material_name.c_str());
         // Create default flat normal map
         normal.create_solid(context, 128, 128, 255);
     }
 
-    if (!roughness.load_tga(context, base_path + "_roughness.tga")) {
+    if (!load_material_map(roughness, context, base_path + "_roughness", false)) {
         fprintf(stderr, "Warning: No roughness map for %s\n", material_name.c_str());
         roughness.create_solid(context, 128, 128, 128); // 0.5 roughness
     }
 
-    if (!metallic.load_tga(context, base_path + "_metallic.tga")) {
+    if (!load_material_map(metallic, context, base_path + "_metallic", false)) {
         fprintf(stderr, "Warning: No metallic map for %s\n", material_name.c_str());
         metallic.create_solid(context, 0, 0, 0); // Non-metallic
     }
 
-    if (!ao.load_tga(context, base_path + "_ao.tga")) {
+    if (!load_material_map(ao, context, base_path + "_ao", false)) {
         fprintf(stderr, "Warning: No AO map for %s\n", material_name.c_str());
         ao.create_solid(context, 255, 255, 255); // No occlusion
     }
 
+    printf("    Material %s: %.1f MB\n", material_name.c_str(),
+        static_cast<double>(memory_size()) / (1024.0 * 1024.0));
+
     return success;
 }
 
+void Material::load_async(TextureLoader& loader, const std::string& directory, const std::string& material_name) {
+    std::string base_path = directory + "/" + material_name;
+
+    // Placeholders match the synchronous fallbacks (albedo: mid gray).
+    // Only albedo is color; the other maps hold linear data.
+    loader.load_map(albedo, base_path + "_albedo", true, 128, 128, 128);
+    loader.load_map(normal, base_path + "_normal", false, 128, 128, 255);
+    loader.load_map(roughness, base_path + "_roughness", false, 128, 128, 128);
+    loader.load_map(metallic, base_path + "_metallic", false, 0, 0, 0);
+    loader.load_map(ao, base_path + "_ao", false, 255, 255, 255);
+}
+
+VkDeviceSize Material::memory_size() const {
+    return albedo.memory_size() + normal.memory_size() + roughness.memory_size() +
+           metallic.memory_size() + ao.memory_size();
+}
+
 void Material::destroy() {
     albedo.destroy();
     normal.destroy();
@@ -2,6 +2,18 @@
  * Slam Engine - Texture System
  *
  * Vulkan texture loading and management
+ *
+ * Textures get a full mip chain, generated on upload by blitting each level
+ * from the one above (linear filtered, so sRGB data is averaged in linear
+ * space). Formats that cannot be linearly blitted fall back to a single level.
+ *
+ * Block-compressed textures (BC1/BC4/BC5/BC7, ASTC) load from KTX2 files
+ * with their precomputed mip chains and are uploaded as-is.
+ *
+ * Loading is split into decode (file -> TextureData, CPU only and safe on
+ * any thread), allocate (image, view and sampler) and upload (recorded into
+ * a caller's command buffer), so TextureLoader can decode on workers and
+ * batch uploads; the load_* functions run all three and wait.
  */
 
 #pragma once
@@ -13,6 +25,19 @@
 namespace slam {
 
 class VulkanContext;
+class TextureLoader;
+
+// Decoded texture ready for upload: pixel or block data for every level
+// stored in the file, with one copy region per level
+struct TextureData {
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    int width = 0;
+    int height = 0;
+    uint32_t mip_levels = 1;
+    bool generate_mips = false;  // Blit the rest of the chain from level 0
+    std::vector<uint8_t> bytes;
+    std::vector<VkBufferImageCopy> regions;  // bufferOffset relative to bytes
+};
 
 class Texture {
 public:
@@ -27,12 +52,38 @@ public:
     Texture(Texture&& other) noexcept;
     Texture& operator=(Texture&& other) noexcept;
 
-    // Load texture from TGA file
-    bool load_tga(VulkanContext& context, const std::string& path);
+    // Load texture from TGA file. Color maps are sRGB; data maps (normal,
+    // roughness, metallic, ao) must be loaded with srgb = false.
+    bool load_tga(VulkanContext& context, const std::string& path, bool srgb = true);
 
-    // Load texture from raw RGBA data
+    // Load texture from raw RGBA data (mip chain generated on the GPU)
     bool load_rgba(VulkanContext& context, const uint8_t* data, int width, int height);
 
+    // Load a KTX2 container: a single 2D image in any format the device can
+    // sample, with all its mip levels (no supercompression)
+    bool load_ktx2(VulkanContext& context, const std::string& path);
+
+    // Can the device sample this format from optimally tiled images?
+    static bool format_supported(const VulkanContext& context, VkFormat format);
+
+    // Decode files without touching the device (thread-safe). decode_ktx2
+    // is silent if the file does not exist, since it is an optional variant.
+    static bool decode_tga(const std::string& path, TextureData& data, bool srgb = true);
+    static bool decode_ktx2(const std::string& path, TextureData& data);
+    static void decode_solid(uint8_t r, uint8_t g, uint8_t b, uint8_t a, TextureData& data, bool srgb = true);
+
+    // Create the image, view and sampler for decoded data (contents undefined)
+    bool allocate(VulkanContext& context, const TextureData& data);
+
+    // Record the copy from a staging buffer holding data.bytes at
+    // staging_offset (plus mip generation). Leaves every level in
+    // SHADER_READ_ONLY once the command buffer has executed.
+    void record_upload(VkCommandBuffer cmd, VkBuffer staging_buffer, VkDeviceSize staging_offset,
+                       const TextureData& data);
+
+    // allocate + record_upload in a one-off submission that is waited on
+    bool upload_now(VulkanContext& context, const TextureData& data);
+
     // Create solid color texture (for defaults)
     bool create_solid(VulkanContext& context, uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255);
 
@@ -45,13 +96,17 @@ public:
     VkSampler sampler() const { return sampler_; }
     int width() const { return width_; }
     int height() const { return height_; }
+    uint32_t mip_levels() const { return mip_levels_; }
+    VkFormat format() const { return format_; }
+    VkDeviceSize memory_size() const { return memory_size_; }  // Device memory, all levels
 
     // Descriptor info for shader binding
     VkDescriptorImageInfo descriptor_info() const;
 
 private:
-    bool create_image(VulkanContext& context, int width, int height, const uint8_t* data);
-    void transition_image_layout(VulkanContext& context, VkImageLayout old_layout, VkImageLayout new_layout);
+    bool create_storage(VulkanContext& context, VkFormat format, VkImageUsageFlags usage);
+    bool create_view_and_sampler(VulkanContext& context);
+    void generate_mipmaps(VkCommandBuffer cmd);
 
     VulkanContext* context_ = nullptr;
     VkImage image_ = VK_NULL_HANDLE;
@@ -60,6 +115,9 @@ private:
     VkSampler sampler_ = VK_NULL_HANDLE;
     int width_ = 0;
     int height_ = 0;
+    uint32_t mip_levels_ = 1;
+    VkFormat format_ = VK_FORMAT_UNDEFINED;
+    VkDeviceSize memory_size_ = 0;
 };
 
 // PBR Material - collection of textures
@@ -70,9 +128,19 @@ struct Material {
     Texture metallic;
     Texture ao;
 
-    // Load all textures for a material from directory
+    // Load all textures for a material from directory. Each map prefers a
+    // compressed container the device supports (<map>.astc.ktx2, then
+    // <map>.bc.ktx2) and falls back to <map>.tga.
     bool load(VulkanContext& context, const std::string& directory, const std::string& material_name);
 
+    // Queue all maps on the loader instead: each map gets a 1x1 placeholder
+    // now and its real texture once decoded and uploaded. The material must
+    // stay at the same address until the loader is idle.
+    void load_async(TextureLoader& loader, const std::string& directory, const std::string& material_name);
+
+    // Device memory used by all maps
+    VkDeviceSize memory_size() const;
+
     void destroy();
 };
 
@@ -0,0 +1,342 @@
+/**
+ * Slam Engine - Texture Loader Implementation
+ */
+
+#include "texture_loader.h"
+#include "vulkan_context.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace slam {
+
+TextureLoader::~TextureLoader() {
+    shutdown();
+}
+
+bool TextureLoader::init(VulkanContext& context, const TextureLoaderConfig& config) {
+    context_ = &context;
+    config_ = config;
+    supports_astc_ = context.supports_astc();
+    supports_bc_ = context.supports_bc();
+
+    // Own pool: batch command buffers are freed individually as they retire
+    VkCommandPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = context.graphics_queue_family();
+
+    if (vkCreateCommandPool(context.device(), &pool_info, nullptr, &command_pool_) != VK_SUCCESS) {
+        fprintf(stderr, "Failed to create texture upload command pool\n");
+        return false;
+    }
+
+    uint32_t worker_count = config_.worker_count;
+    if (worker_count == 0) {
+        uint32_t hardware = std::thread::hardware_concurrency();
+        worker_count = std::min(std::max(hardware, 2u) - 1, 4u);
+    }
+
+    stopping_ = false;
+    for (uint32_t i = 0; i < worker_count; i++) {
+        workers_.emplace_back(&TextureLoader::worker_main, this);
+    }
+
+    printf("Texture loader: %u worker threads\n", worker_count);
+    return true;
+}
+
+void TextureLoader::shutdown() {
+    if (!context_) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+
+    // Land whatever is already on the GPU so targets end up consistent
+    while (!batches_.empty()) {
+        finish_batch(batches_.front(), true);
+        batches_.pop_front();
+    }
+
+    vkDeviceWaitIdle(context_->device());
+    retired_.clear();
+    queue_.clear();
+    decoded_.clear();
+    placeholders_.clear();
+    pending_ = 0;
+
+    if (command_pool_) {
+        vkDestroyCommandPool(context_->device(), command_pool_, nullptr);
+        command_pool_ = VK_NULL_HANDLE;
+    }
+    context_ = nullptr;
+}
+
+void TextureLoader::load_map(Texture& target, const std::string& base_path, bool srgb,
+                             uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    if (pending_ == 0) {
+        timer_.reset();
+    }
+    reported_ = false;
+
+    auto placeholder = std::make_unique<Request>();
+    placeholder->target = &target;
+    placeholder->placeholder = true;
+    Texture::decode_solid(r, g, b, a, placeholder->data, srgb);
+    placeholders_.push_back(std::move(placeholder));
+
+    auto request = std::make_unique<Request>();
+    request->target = &target;
+    request->base_path = base_path;
+    request->srgb = srgb;
+    pending_++;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(request));
+    }
+    work_available_.notify_one();
+}
+
+// ============================================================================
+// Worker threads
+// ============================================================================
+
+void TextureLoader::worker_main() {
+    for (;;) {
+        std::unique_ptr<Request> request;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) return;
+
+            request = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        decode(*request);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        decoded_.push_back(std::move(request));
+    }
+}
+
+void TextureLoader::decode(Request& request) {
+    // Same preference order as Material::load. Physical device format
+    // queries need no external synchronization, so workers can make them.
+    const std::string& base = request.base_path;
+    if (supports_astc_ && Texture::decode_ktx2(base + ".astc.ktx2", request.data) &&
+        Texture::format_supported(*context_, request.data.format)) {
+        request.found = true;
+        return;
+    }
+    if (supports_bc_ && Texture::decode_ktx2(base + ".bc.ktx2", request.data) &&
+        Texture::format_supported(*context_, request.data.format)) {
+        request.found = true;
+        return;
+    }
+
+    request.data = TextureData{};
+    request.found = Texture::decode_tga(base + ".tga", request.data, request.srgb);
+}
+
+// ============================================================================
+// Uploads (frame-recording thread: the render thread when there is one)
+// ============================================================================
+
+void TextureLoader::update() {
+    if (!context_) return;
+    frame_number_++;
+
+    // Batches complete in submission order
+    while (!batches_.empty() && finish_batch(batches_.front(), false)) {
+        batches_.pop_front();
+    }
+
+    // Placeholders could still be bound by a frame in flight
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+        [this](const Retired& retired) { return retired.release_frame <= frame_number_; }),
+        retired_.end());
+
+    // Next batch: all placeholders (a few bytes each), then decoded
+    // textures up to the budget. At least one texture always goes, so a
+    // single large texture cannot stall the queue.
+    std::vector<std::unique_ptr<Request>> requests;
+    while (!placeholders_.empty()) {
+        requests.push_back(std::move(placeholders_.front()));
+        placeholders_.pop_front();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        VkDeviceSize bytes = 0;
+        while (!decoded_.empty()) {
+            Request& next = *decoded_.front();
+            VkDeviceSize size = next.data.bytes.size();
+            if (bytes > 0 && bytes + size > config_.upload_budget) break;
+
+            bytes += size;
+            requests.push_back(std::move(decoded_.front()));
+            decoded_.pop_front();
+        }
+    }
+
+    // Missing files: the placeholder stays
+    auto missing = std::stable_partition(requests.begin(), requests.end(),
+        [](const std::unique_ptr<Request>& request) { return request->placeholder || request->found; });
+    for (auto it = missing; it != requests.end(); ++it) {
+        fprintf(stderr, "Warning: No texture for %s, keeping placeholder\n", (*it)->base_path.c_str());
+        missing_count_++;
+        pending_--;
+    }
+    requests.erase(missing, requests.end());
+
+    if (!requests.empty()) {
+        submit_batch(requests);
+    }
+
+    if (pending_ == 0 && !reported_) {
+        printf("Textures: %u loaded (%.1f MB), %u missing, %.0f ms\n", loaded_count_,
+            static_cast<double>(loaded_bytes_) / (1024.0 * 1024.0), missing_count_,
+            timer_.elapsed() * 1000.0);
+        reported_ = true;
+    }
+}
+
+void TextureLoader::submit_batch(std::vector<std::unique_ptr<Request>>& requests) {
+    VkDevice device = context_->device();
+    Batch batch;
+
+    // One staging buffer for the whole batch; offsets keep each texture's
+    // regions aligned for block-compressed copies (16 covers every format
+    // the loader accepts)
+    std::vector<VkDeviceSize> offsets(requests.size());
+    VkDeviceSize total = 0;
+    for (size_t i = 0; i < requests.size(); i++) {
+        total = (total + 15) & ~VkDeviceSize(15);
+        offsets[i] = total;
+        total += requests[i]->data.bytes.size();
+    }
+
+    context_->create_buffer(total,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        batch.staging_buffer, batch.staging_memory, ResourceCategory::Staging);
+
+    uint8_t* mapped;
+    vkMapMemory(device, batch.staging_memory, 0, total, 0, reinterpret_cast<void**>(&mapped));
+    for (size_t i = 0; i < requests.size(); i++) {
+        memcpy(mapped + offsets[i], requests[i]->data.bytes.data(), requests[i]->data.bytes.size());
+    }
+    vkUnmapMemory(device, batch.staging_memory);
+
+    VkCommandBufferAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandPool = command_pool_;
+    alloc_info.commandBufferCount = 1;
+    vkAllocateCommandBuffers(device, &alloc_info, &batch.cmd);
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(batch.cmd, &begin_info);
+
+    batch.textures.resize(requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+        Texture& texture = batch.textures[i];
+        if (!texture.allocate(*context_, requests[i]->data)) {
+            continue;  // Left empty; finish_batch skips it
+        }
+        texture.record_upload(batch.cmd, batch.staging_buffer, offsets[i], requests[i]->data);
+
+        // CPU copy is no longer needed
+        requests[i]->data.bytes.clear();
+        requests[i]->data.bytes.shrink_to_fit();
+    }
+
+    vkEndCommandBuffer(batch.cmd);
+
+    VkFenceCreateInfo fence_info{};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    vkCreateFence(device, &fence_info, nullptr, &batch.fence);
+
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &batch.cmd;
+
+    if (vkQueueSubmit(context_->graphics_queue(), 1, &submit_info, batch.fence) != VK_SUCCESS) {
+        fprintf(stderr, "Failed to submit texture upload batch\n");
+    }
+
+    batch.requests = std::move(requests);
+    batches_.push_back(std::move(batch));
+}
+
+bool TextureLoader::finish_batch(Batch& batch, bool wait) {
+    VkDevice device = context_->device();
+    if (wait) {
+        vkWaitForFences(device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+    } else if (vkGetFenceStatus(device, batch.fence) != VK_SUCCESS) {
+        return false;
+    }
+
+    uint64_t release_frame = frame_number_ + context_->max_frames_in_flight() + 1;
+    for (size_t i = 0; i < batch.requests.size(); i++) {
+        Request& request = *batch.requests[i];
+        Texture& texture = batch.textures[i];
+
+        if (!request.placeholder) {
+            pending_--;
+            if (texture.image()) {
+                loaded_count_++;
+                loaded_bytes_ += texture.memory_size();
+            }
+        }
+        if (!texture.image()) continue;
+
+        // Swap in; the old image goes to the retire list
+        Retired retired;
+        retired.texture = std::move(*request.target);
+        retired.release_frame = release_frame;
+        if (retired.texture.image()) {
+            retired_.push_back(std::move(retired));
+        }
+        *request.target = std::move(texture);
+
+        if (!request.placeholder && loaded_callback_) {
+            loaded_callback_(*request.target);
+        }
+    }
+
+    destroy_batch(batch);
+    return true;
+}
+
+void TextureLoader::destroy_batch(Batch& batch) {
+    VkDevice device = context_->device();
+    if (batch.fence) {
+        vkDestroyFence(device, batch.fence, nullptr);
+        batch.fence = VK_NULL_HANDLE;
+    }
+    if (batch.cmd) {
+        vkFreeCommandBuffers(device, command_pool_, 1, &batch.cmd);
+        batch.cmd = VK_NULL_HANDLE;
+    }
+    if (batch.staging_buffer) {
+        vkDestroyBuffer(device, batch.staging_buffer, nullptr);
+        batch.staging_buffer = VK_NULL_HANDLE;
+    }
+    context_->free_memory(batch.staging_memory);
+    batch.textures.clear();
+}
+
+} // namespace slam
@@ -0,0 +1,141 @@
+/**
+ * Slam Engine - Texture Loader
+ *
+ * Asynchronous texture streaming. Requests are decoded on worker threads
+ * (file read, TGA swizzle or KTX2 parse); update() runs once per frame on
+ * the thread that records frames (the render thread, when there is one)
+ * and uploads finished decodes in batches: one staging
+ * buffer and one command buffer per batch, submitted with a fence and never
+ * waited on. A texture keeps its placeholder until its batch's fence has
+ * signaled, then the real image is moved in and the placeholder is retired
+ * once no frame in flight can still reference it.
+ *
+ * load_map() shares the placeholder and pending lists with update() without
+ * a lock, so queue every map before the render thread starts.
+ */
+
+#pragma once
+
+#include "texture.h"
+#include "utils/timer.h"
+#include <vulkan/vulkan.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace slam {
+
+class VulkanContext;
+
+struct TextureLoaderConfig {
+    uint32_t worker_count = 0;                    // 0: hardware threads - 1, at most 4
+    VkDeviceSize upload_budget = 32ull << 20;     // Staging bytes submitted per update()
+};
+
+class TextureLoader {
+public:
+    TextureLoader() = default;
+    ~TextureLoader();
+
+    // Non-copyable
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    // Start the worker threads
+    bool init(VulkanContext& context, const TextureLoaderConfig& config = {});
+
+    // Stop the workers and release everything (waits for in-flight uploads).
+    // Requests that have not been uploaded keep their placeholders.
+    void shutdown();
+
+    // Give target a 1x1 placeholder now (uploaded with the next batch) and
+    // queue the map at base_path: <base>.astc.ktx2 or <base>.bc.ktx2 when the
+    // device supports them, else <base>.tga (sRGB only if srgb is set).
+    // target must stay at the same address until the request completes or
+    // the loader shuts down. Not while the render thread is running: it
+    // runs update(), and the lists they share are not locked.
+    void load_map(Texture& target, const std::string& base_path, bool srgb,
+                  uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255);
+
+    // Called from update() each time a real texture (not a placeholder or
+    // missing file) has been moved into its target
+    using LoadedCallback = std::function<void(const Texture& target)>;
+    void set_loaded_callback(LoadedCallback callback) { loaded_callback_ = std::move(callback); }
+
+    // Per-frame, on the thread that records frames: retire finished batches,
+    // submit the next batch of decoded textures within the upload budget.
+    // Never blocks on the GPU.
+    void update();
+
+    // Requests not yet visible (queued, decoding, or uploading)
+    uint32_t pending() const { return pending_; }
+    bool idle() const { return pending_ == 0; }
+
+    uint32_t loaded_count() const { return loaded_count_; }
+    uint32_t missing_count() const { return missing_count_; }
+
+private:
+    struct Request {
+        Texture* target = nullptr;
+        std::string base_path;
+        bool srgb = true;
+        TextureData data;
+        bool placeholder = false;  // Solid color; already decoded
+        bool found = false;
+    };
+
+    struct Batch {
+        VkCommandBuffer cmd = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        VkBuffer staging_buffer = VK_NULL_HANDLE;
+        VkDeviceMemory staging_memory = VK_NULL_HANDLE;
+        std::vector<std::unique_ptr<Request>> requests;
+        std::vector<Texture> textures;  // Uploading; moved into targets when done
+    };
+
+    struct Retired {
+        Texture texture;
+        uint64_t release_frame = 0;
+    };
+
+    void worker_main();
+    void decode(Request& request);
+    void submit_batch(std::vector<std::unique_ptr<Request>>& requests);
+    bool finish_batch(Batch& batch, bool wait);
+    void destroy_batch(Batch& batch);
+
+    VulkanContext* context_ = nullptr;
+    TextureLoaderConfig config_;
+    VkCommandPool command_pool_ = VK_NULL_HANDLE;
+    bool supports_astc_ = false;  // Snapshot for workers
+    bool supports_bc_ = false;
+
+    // Worker side (guarded by mutex_)
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::deque<std::unique_ptr<Request>> queue_;     // Waiting for a worker
+    std::deque<std::unique_ptr<Request>> decoded_;   // Waiting for upload
+    bool stopping_ = false;
+
+    // Frame-recording thread only (load_map before the render thread starts)
+    std::deque<std::unique_ptr<Request>> placeholders_;
+    std::deque<Batch> batches_;
+    std::vector<Retired> retired_;
+    uint64_t frame_number_ = 0;
+    uint32_t pending_ = 0;
+    uint32_t loaded_count_ = 0;
+    uint32_t missing_count_ = 0;
+    VkDeviceSize loaded_bytes_ = 0;
+    Timer timer_;  // Since the first request, for the completion log
+    bool reported_ = true;
+    LoadedCallback loaded_callback_;
+};
+
+} // namespace slam
@@ -26,6 +26,10 @@ VulkanContext::~VulkanContext() {
 bool VulkanContext::init(Window& window, const VulkanContextConfig& config) {
     window_ = &window;
     config_ = config;
+    headless_ = false;
+    framebuffer_extent_ = {static_cast<uint32_t>(window.framebuffer_width()),
+                           static_cast<uint32_t>(window.framebuffer_height())};
+    device_extensions_ = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
     if (!create_instance()) return false;
     if (config_.enable_validation && !setup_debug_messenger()) return false;
@@ -39,17 +43,46 @@ bool VulkanContext::init(Window& window, const VulkanContextConfig& config) {
     if (!create_command_pool()) return false;
     if (!create_command_buffers()) return false;
     if (!create_sync_objects()) return false;
+    if (!profiler_.init(*this, config_.max_frames_in_flight)) return false;
+    frame_allocator_.init(config_.max_frames_in_flight, config_.frame_allocator_bytes);
 
     printf("Vulkan initialized successfully\n");
     return true;
 }
 
+bool VulkanContext::init_headless(uint32_t width, uint32_t height, const VulkanContextConfig& config) {
+    window_ = nullptr;
+    config_ = config;
+    headless_ = true;
+    headless_extent_ = {width, height};
+    device_extensions_.clear();
+
+    if (!create_instance()) return false;
+    if (config_.enable_validation && !setup_debug_messenger()) return false;
+    if (!pick_physical_device()) return false;
+    if (!create_logical_device()) return false;
+    if (!create_offscreen_images()) return false;
+    if (!create_image_views()) return false;
+    if (!create_render_pass()) return false;
+    if (!create_framebuffers()) return false;
+    if (!create_command_pool()) return false;
+    if (!create_command_buffers()) return false;
+    if (!create_sync_objects()) return false;
+    if (!profiler_.init(*this, config_.max_frames_in_flight)) return false;
+    frame_allocator_.init(config_.max_frames_in_flight, config_.frame_allocator_bytes);
+
+    printf("Vulkan initialized successfully (headless %ux%u)\n", width, height);
+    return true;
+}
+
 void VulkanContext::shutdown() {
     if (device_) {
         vkDeviceWaitIdle(device_);
     }
 
     cleanup_swapchain();
+    profiler_.destroy();
+    frame_allocator_.destroy();
 
     // Destroy semaphores (one per swapchain image)
     for (size_t i = 0; i < render_finished_semaphores_.size(); i++) {
@@ -75,6 +108,13 @@ void VulkanContext::shutdown() {
     }
 
     if (device_) {
+        // Everything should have been released by its owner by now
+        uint32_t leaked = resources_.live_allocations();
+        if (leaked > 0) {
+            fprintf(stderr, "Warning: %u device memory allocations (%.1f MB) still live at shutdown\n",
+                leaked, static_cast<double>(resources_.total_bytes()) / (1024.0 * 1024.0));
+        }
+
         vkDestroyDevice(device_, nullptr);
         device_ = VK_NULL_HANDLE;
     }
@@ -119,17 +159,36 @@ void VulkanContext::cleanup_swapchain() {
         vkDestroySwapchainKHR(device_, swapchain_, nullptr);
         swapchain_ = VK_NULL_HANDLE;
     }
-}
 
-void VulkanContext::recreate_swapchain() {
-    // Handle minimization
-    int width = 0, height = 0;
-    while (width == 0 || height == 0) {
-        width = window_->framebuffer_width();
-        height = window_->framebuffer_height();
-        if (width == 0 || height == 0) {
-            window_->poll_events();
+    // Headless images are ours; swapchain images belong to the swapchain
+    if (headless_) {
+        for (auto image : swapchain_images_) {
+            vkDestroyImage(device_, image, nullptr);
         }
+        for (auto& memory : offscreen_memory_) {
+            free_memory(memory);
+        }
+        swapchain_images_.clear();
+        offscreen_memory_.clear();
+    }
+}
+
+void VulkanContext::set_framebuffer_size(uint32_t width, uint32_t height) {
+    if (width != framebuffer_extent_.width || height != framebuffer_extent_.height) {
+        framebuffer_extent_ = {width, height};
+        swapchain_stale_ = true;
+    }
+}
+
+bool VulkanContext::recreate_swapchain() {
+    // Offscreen images have a fixed size
+    if (headless_) return true;
+
+    // Minimized: keep the old swapchain and let the caller skip the frame;
+    // it is rebuilt once the render side passes a real size
+    if (framebuffer_extent_.width == 0 || framebuffer_extent_.height == 0) {
+        swapchain_stale_ = true;
+        return false;
     }
 
     vkDeviceWaitIdle(device_);
@@ -143,6 +202,10 @@ void VulkanContext::recreate_swapchain() {
 
     // Resize images_in_flight for new swapchain image count
     images_in_flight_.resize(swapchain_images_.size(), VK_NULL_HANDLE);
+
+    swapchain_stale_ = false;
+    swapchain_generation_++;
+    return true;
 }
 
 void VulkanContext::wait_idle() {
@@ -151,21 +214,141 @@ void VulkanContext::wait_idle() {
     }
 }
 
-bool VulkanContext::begin_frame(uint32_t& image_index) {
+bool VulkanContext::read_image(uint32_t image_index, std::vector<uint8_t>& rgba) {
+    if (!headless_ || image_index >= swapchain_images_.size()) {
+        return false;
+    }
+
+    // The frame left the image in TRANSFER_SRC (see present_layout). The
+    // idle wait is for the host only; the barrier below orders the copy
+    // after the frame's color writes.
+    vkQueueWaitIdle(graphics_queue_);
+
+    uint32_t width = swapchain_extent_.width;
+    uint32_t height = swapchain_extent_.height;
+    VkDeviceSize size = static_cast<VkDeviceSize>(width) * height * 4;
+
+    VkBuffer staging_buffer;
+    VkDeviceMemory staging_memory;
+    create_buffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        staging_buffer, staging_memory, ResourceCategory::Staging);
+
+    VkCommandBuffer cmd = begin_single_time_commands();
+
+    // Make the color attachment writes visible to the transfer (no layout
+    // change; earlier submissions are in the barrier's first scope)
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = swapchain_images_[image_index];
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {width, height, 1};
+
+    vkCmdCopyImageToBuffer(cmd, swapchain_images_[image_index], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           staging_buffer, 1, &region);
+
+    end_single_time_commands(cmd);
+
+    rgba.resize(static_cast<size_t>(size));
+    void* data;
+    vkMapMemory(device_, staging_memory, 0, size, 0, &data);
+    memcpy(rgba.data(), data, static_cast<size_t>(size));
+    vkUnmapMemory(device_, staging_memory);
+
+    // BGRA -> RGBA
+    if (swapchain_format_ == VK_FORMAT_B8G8R8A8_SRGB) {
+        for (size_t i = 0; i < rgba.size(); i += 4) {
+            std::swap(rgba[i], rgba[i + 2]);
+        }
+    }
+
+    vkDestroyBuffer(device_, staging_buffer, nullptr);
+    free_memory(staging_memory);
+
+    return true;
+}
+
+void VulkanContext::wait_frame() {
+    poll_input_latency();
+
     // Wait for previous frame using this slot
     vkWaitForFences(device_, 1, &in_flight_fences_[current_frame_], VK_TRUE, UINT64_MAX);
 
-    // Acquire next image - use a semaphore indexed by the previous image for safety
-    // We'll update to use the acquired image's semaphore after we know which image it is
-    VkResult result = vkAcquireNextImageKHR(device_, swapchain_, UINT64_MAX,
-        image_available_semaphores_[current_frame_ % swapchain_images_.size()], VK_NULL_HANDLE, &image_index);
+    poll_input_latency();
+}
+
+void VulkanContext::mark_input(Timer::TimePoint sample_time) {
+    input_times_[current_frame_] = sample_time;
+    input_marked_[current_frame_] = true;
+}
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        recreate_swapchain();
-        return false;
-    } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-        fprintf(stderr, "Failed to acquire swapchain image\n");
-        return false;
+InputLatencyStats VulkanContext::take_input_latency() {
+    InputLatencyStats stats = input_latency_;
+    input_latency_ = {};
+    return stats;
+}
+
+// Every slot, not only the one about to be reused: with several frames in
+// flight that one finished a frame ago
+void VulkanContext::poll_input_latency() {
+    for (uint32_t slot = 0; slot < config_.max_frames_in_flight; slot++) {
+        if (!input_marked_[slot] || vkGetFenceStatus(device_, in_flight_fences_[slot]) != VK_SUCCESS) {
+            continue;
+        }
+        input_marked_[slot] = false;
+        double ms = Timer::Duration(Timer::Clock::now() - input_times_[slot]).count() * 1000.0;
+        input_latency_.sum_ms += ms;
+        input_latency_.max_ms = std::max(input_latency_.max_ms, ms);
+        input_latency_.count++;
+    }
+}
+
+bool VulkanContext::begin_frame(uint32_t& image_index) {
+    wait_frame();
+    frame_allocator_.begin_frame(current_frame_);
+
+    if (headless_) {
+        // One offscreen image per frame in flight, guarded by that frame's fence
+        image_index = current_frame_;
+    } else {
+        if (swapchain_stale_ && !recreate_swapchain()) {
+            return false;
+        }
+
+        // Acquire next image - use a semaphore indexed by the previous image for safety
+        // We'll update to use the acquired image's semaphore after we know which image it is
+        VkResult result = vkAcquireNextImageKHR(device_, swapchain_, UINT64_MAX,
+            image_available_semaphores_[current_frame_ % swapchain_images_.size()], VK_NULL_HANDLE, &image_index);
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            recreate_swapchain();
+            return false;
+        } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            fprintf(stderr, "Failed to acquire swapchain image\n");
+            return false;
+        }
     }
 
     // Store current image index
@@ -193,11 +376,17 @@ bool VulkanContext::begin_frame(uint32_t& image_index) {
         return false;
     }
 
-    // Begin render pass
+    // Previous results for this frame slot are complete after the fence wait
+    profiler_.begin_frame(command_buffers_[current_frame_], current_frame_);
+
+    return true;
+}
+
+void VulkanContext::begin_render_pass(VkCommandBuffer cmd) {
     VkRenderPassBeginInfo render_pass_info{};
     render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     render_pass_info.renderPass = render_pass_;
-    render_pass_info.framebuffer = framebuffers_[image_index];
+    render_pass_info.framebuffer = framebuffers_[current_image_index_];
     render_pass_info.renderArea.offset = {0, 0};
     render_pass_info.renderArea.extent = swapchain_extent_;
 
@@ -205,7 +394,7 @@ bool VulkanContext::begin_frame(uint32_t& image_index) {
     render_pass_info.clearValueCount = 1;
     render_pass_info.pClearValues = &clear_color;
 
-    vkCmdBeginRenderPass(command_buffers_[current_frame_], &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(cmd, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
 
     // Set viewport and scissor
     VkViewport viewport{};
@@ -215,155 +404,44 @@ bool VulkanContext::begin_frame(uint32_t& image_index) {
     viewport.height = static_cast<float>(swapchain_extent_.height);
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(command_buffers_[current_frame_], 0, 1, &viewport);
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
 
     VkRect2D scissor{};
     scissor.offset = {0, 0};
     scissor.extent = swapchain_extent_;
-    vkCmdSetScissor(command_buffers_[current_frame_], 0, 1, &scissor);
-
-    return true;
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
 }
 
-bool VulkanContext::begin_frame(uint32_t& image_index, bool start_render_pass) {
-    // Wait for previous frame using this slot
-    vkWaitForFences(device_, 1, &in_flight_fences_[current_frame_], VK_TRUE, UINT64_MAX);
-
-    // Acquire next image
-    VkResult result = vkAcquireNextImageKHR(device_, swapchain_, UINT64_MAX,
-        image_available_semaphores_[current_frame_ % swapchain_images_.size()], VK_NULL_HANDLE, &image_index);
-
-    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        recreate_swapchain();
-        return false;
-    } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-        fprintf(stderr, "Failed to acquire swapchain image\n");
-        return false;
-    }
-
-    // Store current image index
-    current_image_index_ = image_index;
-
-    // Wait if this image is still in use by a previous frame
-    if (images_in_flight_[image_index] != VK_NULL_HANDLE) {
-        vkWaitForFences(device_, 1, &images_in_flight_[image_index], VK_TRUE, UINT64_MAX);
-    }
-    images_in_flight_[image_index] = in_flight_fences_[current_frame_];
-
-    // Reset fence only if we're submitting work
-    vkResetFences(device_, 1, &in_flight_fences_[current_frame_]);
-
-    // Reset and begin command buffer
-    vkResetCommandBuffer(command_buffers_[current_frame_], 0);
-
-    VkCommandBufferBeginInfo begin_info{};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags = 0;
-
-    if (vkBeginCommandBuffer(command_buffers_[current_frame_], &begin_info) != VK_SUCCESS) {
-        fprintf(stderr, "Failed to begin command buffer\n");
-        return false;
-    }
-
-    if (start_render_pass) {
-        // Begin render pass
-        VkRenderPassBeginInfo render_pass_info{};
-        render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        render_pass_info.renderPass = render_pass_;
-        render_pass_info.framebuffer = framebuffers_[image_index];
-        render_pass_info.renderArea.offset = {0, 0};
-        render_pass_info.renderArea.extent = swapchain_extent_;
-
-        VkClearValue clear_color = {{{0.1f, 0.1f, 0.15f, 1.0f}}};
-        render_pass_info.clearValueCount = 1;
-        render_pass_info.pClearValues = &clear_color;
-
-        vkCmdBeginRenderPass(command_buffers_[current_frame_], &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
-
-        // Set viewport and scissor
-        VkViewport viewport{};
-        viewport.x = 0.0f;
-        viewport.y = 0.0f;
-        viewport.width = static_cast<float>(swapchain_extent_.width);
-        viewport.height = static_cast<float>(swapchain_extent_.height);
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
-        vkCmdSetViewport(command_buffers_[current_frame_], 0, 1, &viewport);
-
-        VkRect2D scissor{};
-        scissor.offset = {0, 0};
-        scissor.extent = swapchain_extent_;
-        vkCmdSetScissor(command_buffers_[current_frame_], 0, 1, &scissor);
-    }
-
-    return true;
+void VulkanContext::end_render_pass(VkCommandBuffer cmd) {
+    vkCmdEndRenderPass(cmd);
 }
 
-void VulkanContext::end_frame(uint32_t image_index, bool end_render_pass) {
-    if (end_render_pass) {
-        vkCmdEndRenderPass(command_buffers_[current_frame_]);
-    }
+void VulkanContext::end_frame(uint32_t image_index) {
+    profiler_.end_frame(command_buffers_[current_frame_]);
 
     if (vkEndCommandBuffer(command_buffers_[current_frame_]) != VK_SUCCESS) {
         fprintf(stderr, "Failed to record command buffer\n");
         return;
     }
 
-    // Submit command buffer
+    // Submit command buffer - use image-indexed semaphores
     VkSubmitInfo submit_info{};
     submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-    VkSemaphore wait_semaphores[] = {image_available_semaphores_[current_frame_ % swapchain_images_.size()]};
-    VkPipelineStageFlags wait_stages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submit_info.waitSemaphoreCount = 1;
-    submit_info.pWaitSemaphores = wait_semaphores;
-    submit_info.pWaitDstStageMask = wait_stages;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffers_[current_frame_];
-
-    VkSemaphore signal_semaphores[] = {render_finished_semaphores_[image_index]};
-    submit_info.signalSemaphoreCount = 1;
-    submit_info.pSignalSemaphores = signal_semaphores;
-
-    if (vkQueueSubmit(graphics_queue_, 1, &submit_info, in_flight_fences_[current_frame_]) != VK_SUCCESS) {
-        fprintf(stderr, "Failed to submit draw command buffer\n");
-        return;
-    }
-
-    // Present
-    VkPresentInfoKHR present_info{};
-    present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    present_info.waitSemaphoreCount = 1;
-    present_info.pWaitSemaphores = signal_semaphores;
-
-    VkSwapchainKHR swapchains[] = {swapchain_};
-    present_info.swapchainCount = 1;
-    present_info.pSwapchains = swapchains;
-    present_info.pImageIndices = &image_index;
-
-    VkResult result = vkQueuePresentKHR(present_queue_, &present_info);
-
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
-        recreate_swapchain();
-    } else if (result != VK_SUCCESS) {
-        fprintf(stderr, "Failed to present swapchain image\n");
-    }
+    if (headless_) {
+        // Nothing to acquire or present
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &command_buffers_[current_frame_];
 
-    current_frame_ = (current_frame_ + 1) % config_.max_frames_in_flight;
-}
-
-void VulkanContext::end_frame(uint32_t image_index) {
-    vkCmdEndRenderPass(command_buffers_[current_frame_]);
+        if (vkQueueSubmit(graphics_queue_, 1, &submit_info, in_flight_fences_[current_frame_]) != VK_SUCCESS) {
+            fprintf(stderr, "Failed to submit draw command buffer\n");
+        }
 
-    if (vkEndCommandBuffer(command_buffers_[current_frame_]) != VK_SUCCESS) {
-        fprintf(stderr, "Failed to record command buffer\n");
+        poll_input_latency();
+        current_frame_ = (current_frame_ + 1) % config_.max_frames_in_flight;
         return;
     }
 
-    // Submit command buffer - use image-indexed semaphores
-    VkSubmitInfo submit_info{};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
     VkSemaphore wait_semaphores[] = {image_available_semaphores_[current_frame_ % swapchain_images_.size()]};
     VkPipelineStageFlags wait_stages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
     submit_info.waitSemaphoreCount = 1;
@@ -400,6 +478,7 @@ void VulkanContext::end_frame(uint32_t image_index) {
         fprintf(stderr, "Failed to present swapchain image\n");
     }
 
+    poll_input_latency();
     current_frame_ = (current_frame_ + 1) % config_.max_frames_in_flight;
 }
 
@@ -420,9 +499,11 @@ bool VulkanContext::create_instance() {
     VkInstanceCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     create_info.pApplicationInfo = &app_info;
-    create_info.flags = VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR;
 
     auto extensions = get_required_extensions();
+    if (portability_enumeration_) {
+        create_info.flags = VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR;
+    }
     create_info.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
     create_info.ppEnabledExtensionNames = extensions.data();
 
@@ -534,17 +615,42 @@ bool VulkanContext::create_logical_device() {
         queue_create_infos.push_back(queue_create_info);
     }
 
+    VkPhysicalDeviceFeatures supported_features;
+    vkGetPhysicalDeviceFeatures(physical_device_, &supported_features);
+
     VkPhysicalDeviceFeatures device_features{};
     device_features.imageCubeArray = VK_TRUE;  // Required for shadow cubemap arrays
     device_features.samplerAnisotropy = VK_TRUE;  // Better texture quality
 
+    // Material library indexes its texture array with a per-draw index
+    device_features.shaderSampledImageArrayDynamicIndexing = supported_features.shaderSampledImageArrayDynamicIndexing;
+    sampled_image_indexing_ = supported_features.shaderSampledImageArrayDynamicIndexing == VK_TRUE;
+
+    // Block-compressed textures: BC on desktop, ASTC on Apple/mobile GPUs
+    device_features.textureCompressionBC = supported_features.textureCompressionBC;
+    device_features.textureCompressionASTC_LDR = supported_features.textureCompressionASTC_LDR;
+    texture_compression_bc_ = supported_features.textureCompressionBC == VK_TRUE;
+    texture_compression_astc_ = supported_features.textureCompressionASTC_LDR == VK_TRUE;
+
     VkDeviceCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
     create_info.pQueueCreateInfos = queue_create_infos.data();
     create_info.pEnabledFeatures = &device_features;
-    create_info.enabledExtensionCount = static_cast<uint32_t>(device_extensions_.size());
-    create_info.ppEnabledExtensionNames = device_extensions_.data();
+
+    // Portability subset must be enabled whenever the device exposes it (MoltenVK)
+    std::vector<const char*> extensions = device_extensions_;
+    if (has_device_extension(physical_device_, "VK_KHR_portability_subset")) {
+        extensions.push_back("VK_KHR_portability_subset");
+    }
+
+    // Optional: per-heap usage and budget for the memory report
+    memory_budget_ = has_device_extension(physical_device_, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (memory_budget_) {
+        extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+    create_info.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    create_info.ppEnabledExtensionNames = extensions.data();
 
     if (config_.enable_validation) {
         create_info.enabledLayerCount = static_cast<uint32_t>(validation_layers_.size());
@@ -561,6 +667,7 @@ bool VulkanContext::create_logical_device() {
     vkGetDeviceQueue(device_, queue_families_.graphics_family.value(), 0, &graphics_queue_);
     vkGetDeviceQueue(device_, queue_families_.present_family.value(), 0, &present_queue_);
 
+    resources_.init(physical_device_, memory_budget_);
     return true;
 }
 
@@ -617,7 +724,69 @@ bool VulkanContext::create_swapchain() {
     swapchain_format_ = surface_format.format;
     swapchain_extent_ = extent;
 
-    printf("Swapchain created: %dx%d, %d images\n", extent.width, extent.height, image_count);
+    const char* mode_name = present_mode == VK_PRESENT_MODE_IMMEDIATE_KHR ? "immediate"
+                          : present_mode == VK_PRESENT_MODE_MAILBOX_KHR ? "mailbox" : "FIFO";
+    printf("Swapchain created: %dx%d, %d images, %s present\n", extent.width, extent.height,
+        image_count, mode_name);
+
+    return true;
+}
+
+bool VulkanContext::create_offscreen_images() {
+    // Prefer the format the windowed path usually picks, so shaders and
+    // render passes see the same sRGB target
+    swapchain_format_ = VK_FORMAT_B8G8R8A8_SRGB;
+    VkFormatProperties format_props;
+    vkGetPhysicalDeviceFormatProperties(physical_device_, swapchain_format_, &format_props);
+    if (!(format_props.optimalTilingFeatures & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT)) {
+        swapchain_format_ = VK_FORMAT_R8G8B8A8_SRGB;
+    }
+    swapchain_extent_ = headless_extent_;
+
+    uint32_t image_count = config_.max_frames_in_flight;
+    swapchain_images_.resize(image_count);
+    offscreen_memory_.resize(image_count);
+
+    for (uint32_t i = 0; i < image_count; i++) {
+        VkImageCreateInfo image_info{};
+        image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        image_info.imageType = VK_IMAGE_TYPE_2D;
+        image_info.extent.width = swapchain_extent_.width;
+        image_info.extent.height = swapchain_extent_.height;
+        image_info.extent.depth = 1;
+        image_info.mipLevels = 1;
+        image_info.arrayLayers = 1;
+        image_info.format = swapchain_format_;
+        image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        image_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateImage(device_, &image_info, nullptr, &swapchain_images_[i]) != VK_SUCCESS) {
+            fprintf(stderr, "Failed to create offscreen image\n");
+            return false;
+        }
+
+        VkMemoryRequirements mem_requirements;
+        vkGetImageMemoryRequirements(device_, swapchain_images_[i], &mem_requirements);
+
+        VkMemoryAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = mem_requirements.size;
+        alloc_info.memoryTypeIndex = find_memory_type(mem_requirements.memoryTypeBits,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        if (allocate_memory(alloc_info, ResourceCategory::Swapchain, offscreen_memory_[i]) != VK_SUCCESS) {
+            fprintf(stderr, "Failed to allocate offscreen image memory\n");
+            return false;
+        }
+
+        vkBindImageMemory(device_, swapchain_images_[i], offscreen_memory_[i], 0);
+    }
+
+    printf("Offscreen targets created: %dx%d, %d images\n",
+        swapchain_extent_.width, swapchain_extent_.height, image_count);
 
     return true;
 }
@@ -659,7 +828,7 @@ bool VulkanContext::create_render_pass() {
     color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    color_attachment.finalLayout = present_layout();
 
     VkAttachmentReference color_attachment_ref{};
     color_attachment_ref.attachment = 0;
@@ -756,6 +925,8 @@ bool VulkanContext::create_sync_objects() {
     image_available_semaphores_.resize(image_count);
     render_finished_semaphores_.resize(image_count);
     in_flight_fences_.resize(config_.max_frames_in_flight);
+    input_times_.resize(config_.max_frames_in_flight);
+    input_marked_.assign(config_.max_frames_in_flight, false);
     images_in_flight_.resize(image_count, VK_NULL_HANDLE);
 
     VkSemaphoreCreateInfo semaphore_info{};
@@ -800,6 +971,22 @@ uint32_t VulkanContext::find_memory_type(uint32_t type_filter, VkMemoryPropertyF
     return 0;
 }
 
+bool VulkanContext::find_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties,
+                                     uint32_t& type_index) const {
+    VkPhysicalDeviceMemoryProperties mem_properties;
+    vkGetPhysicalDeviceMemoryProperties(physical_device_, &mem_properties);
+
+    for (uint32_t i = 0; i < mem_properties.memoryTypeCount; i++) {
+        if ((type_filter & (1 << i)) &&
+            (mem_properties.memoryTypes[i].propertyFlags & properties) == properties) {
+            type_index = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 VkCommandBuffer VulkanContext::begin_single_time_commands() {
     VkCommandBufferAllocateInfo alloc_info{};
     alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -832,9 +1019,27 @@ void VulkanContext::end_single_time_commands(VkCommandBuffer command_buffer) {
     vkFreeCommandBuffers(device_, command_pool_, 1, &command_buffer);
 }
 
+VkResult VulkanContext::allocate_memory(const VkMemoryAllocateInfo& alloc_info, ResourceCategory category,
+                                        VkDeviceMemory& memory) {
+    VkResult result = vkAllocateMemory(device_, &alloc_info, nullptr, &memory);
+    if (result == VK_SUCCESS) {
+        resources_.track(memory, alloc_info.allocationSize, alloc_info.memoryTypeIndex, category);
+    }
+    return result;
+}
+
+void VulkanContext::free_memory(VkDeviceMemory& memory) {
+    if (!memory) return;
+
+    resources_.untrack(memory);
+    vkFreeMemory(device_, memory, nullptr);
+    memory = VK_NULL_HANDLE;
+}
+
 void VulkanContext::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage,
                                   VkMemoryPropertyFlags properties,
-                                  VkBuffer& buffer, VkDeviceMemory& buffer_memory) {
+                                  VkBuffer& buffer, VkDeviceMemory& buffer_memory,
+                                  ResourceCategory category) {
     VkBufferCreateInfo buffer_info{};
     buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     buffer_info.size = size;
@@ -854,7 +1059,7 @@ void VulkanContext::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage,
     alloc_info.allocationSize = mem_requirements.size;
     alloc_info.memoryTypeIndex = find_memory_type(mem_requirements.memoryTypeBits, properties);
 
-    if (vkAllocateMemory(device_, &alloc_info, nullptr, &buffer_memory) != VK_SUCCESS) {
+    if (allocate_memory(alloc_info, category, buffer_memory) != VK_SUCCESS) {
         fprintf(stderr, "Failed to allocate buffer memory\n");
         return;
     }
@@ -886,6 +1091,13 @@ QueueFamilyIndices VulkanContext::find_queue_families(VkPhysicalDevice device) {
             indices.graphics_family = i;
         }
 
+        // Headless: nothing is presented, so the graphics queue stands in
+        if (!surface_) {
+            indices.present_family = indices.graphics_family;
+            if (indices.is_complete()) break;
+            continue;
+        }
+
         VkBool32 present_support = false;
         vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &present_support);
         if (present_support) {
@@ -925,6 +1137,10 @@ bool VulkanContext::is_device_suitable(VkPhysicalDevice device) {
 
     bool extensions_supported = check_device_extension_support(device);
 
+    if (headless_) {
+        return indices.is_complete() && extensions_supported;
+    }
+
     bool swapchain_adequate = false;
     if (extensions_supported) {
         SwapchainSupportDetails support = query_swapchain_support(device);
@@ -950,6 +1166,36 @@ bool VulkanContext::check_device_extension_support(VkPhysicalDevice device) {
     return required_extensions.empty();
 }
 
+bool VulkanContext::has_device_extension(VkPhysicalDevice device, const char* name) {
+    uint32_t extension_count;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, nullptr);
+
+    std::vector<VkExtensionProperties> available_extensions(extension_count);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, available_extensions.data());
+
+    for (const auto& extension : available_extensions) {
+        if (strcmp(extension.extensionName, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VulkanContext::has_instance_extension(const char* name) {
+    uint32_t extension_count;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extension_count, nullptr);
+
+    std::vector<VkExtensionProperties> available_extensions(extension_count);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extension_count, available_extensions.data());
+
+    for (const auto& extension : available_extensions) {
+        if (strcmp(extension.extensionName, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 VkSurfaceFormatKHR VulkanContext::choose_surface_format(const std::vector<VkSurfaceFormatKHR>& formats) {
     for (const auto& format : formats) {
         if (format.format == VK_FORMAT_B8G8R8A8_SRGB &&
@@ -961,17 +1207,16 @@ VkSurfaceFormatKHR VulkanContext::choose_surface_format(const std::vector<VkSurf
 }
 
 VkPresentModeKHR VulkanContext::choose_present_mode(const std::vector<VkPresentModeKHR>& modes) {
-    if (!config_.enable_vsync) {
-        for (const auto& mode : modes) {
-            if (mode == VK_PRESENT_MODE_MAILBOX_KHR) {
-                return mode;
-            }
-        }
-        for (const auto& mode : modes) {
-            if (mode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-                return mode;
-            }
-        }
+    auto supported = [&modes](VkPresentModeKHR wanted) {
+        return std::find(modes.begin(), modes.end(), wanted) != modes.end();
+    };
+
+    if (config_.present_mode == PresentMode::Immediate) {
+        if (supported(VK_PRESENT_MODE_IMMEDIATE_KHR)) return VK_PRESENT_MODE_IMMEDIATE_KHR;
+        if (supported(VK_PRESENT_MODE_MAILBOX_KHR)) return VK_PRESENT_MODE_MAILBOX_KHR;
+    } else if (config_.present_mode == PresentMode::Mailbox) {
+        if (supported(VK_PRESENT_MODE_MAILBOX_KHR)) return VK_PRESENT_MODE_MAILBOX_KHR;
+        if (supported(VK_PRESENT_MODE_IMMEDIATE_KHR)) return VK_PRESENT_MODE_IMMEDIATE_KHR;
     }
     return VK_PRESENT_MODE_FIFO_KHR; // Guaranteed to be available, vsync
 }
@@ -981,10 +1226,7 @@ VkExtent2D VulkanContext::choose_swap_extent(const VkSurfaceCapabilitiesKHR& cap
         return capabilities.currentExtent;
     }
 
-    VkExtent2D actual_extent = {
-        static_cast<uint32_t>(window_->framebuffer_width()),
-        static_cast<uint32_t>(window_->framebuffer_height())
-    };
+    VkExtent2D actual_extent = framebuffer_extent_;
 
     actual_extent.width = std::clamp(actual_extent.width,
         capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
@@ -1016,14 +1258,23 @@ bool VulkanContext::check_validation_layer_support() {
 }
 
 std::vector<const char*> VulkanContext::get_required_extensions() {
-    uint32_t glfw_extension_count = 0;
-    const char** glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
+    std::vector<const char*> extensions;
 
-    std::vector<const char*> extensions(glfw_extensions, glfw_extensions + glfw_extension_count);
+    // Surface extensions (headless needs none, and no GLFW)
+    if (!headless_) {
+        uint32_t glfw_extension_count = 0;
+        const char** glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
+        extensions.assign(glfw_extensions, glfw_extensions + glfw_extension_count);
+    }
 
-    // Required for MoltenVK
-    extensions.push_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
-    extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    // Required for MoltenVK; absent on most other drivers (e.g. lavapipe)
+    portability_enumeration_ = has_instance_extension(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
+    if (portability_enumeration_) {
+        extensions.push_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
+    }
+    if (has_instance_extension(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)) {
+        extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    }
 
     if (config_.enable_validation) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -2,11 +2,20 @@
  * Slam Engine - Vulkan Context
  *
  * Core Vulkan setup: instance, device, swapchain, command buffers
+ *
+ * Headless mode (init_headless) needs no window or surface: a ring of
+ * offscreen color images stands in for the swapchain, frames are submitted
+ * without presenting and can be read back for image dumps.
  */
 
 #pragma once
 
+#include "gpu_profiler.h"
+#include "resource_tracker.h"
+#include "utils/frame_allocator.h"
+#include "utils/timer.h"
 #include <vulkan/vulkan.h>
+#include <cstdint>
 #include <vector>
 #include <optional>
 #include <string>
@@ -32,10 +41,25 @@ struct SwapchainSupportDetails {
     std::vector<VkPresentModeKHR> present_modes;
 };
 
+// Swapchain present mode. Unsupported choices fall back toward FIFO.
+// Input-to-GPU-complete latency samples, see VulkanContext::mark_input
+struct InputLatencyStats {
+    double sum_ms = 0.0;
+    double max_ms = 0.0;
+    uint32_t count = 0;
+};
+
+enum class PresentMode {
+    Fifo,       // Vsync, frames queue up behind each other
+    Mailbox,    // Vsync, a newer frame replaces the queued one (then immediate)
+    Immediate,  // No vsync, may tear, lowest latency (then mailbox)
+};
+
 struct VulkanContextConfig {
     bool enable_validation = true;
-    bool enable_vsync = true;
-    uint32_t max_frames_in_flight = 2;
+    PresentMode present_mode = PresentMode::Fifo;
+    uint32_t max_frames_in_flight = 2;  // 1 trades throughput for latency
+    size_t frame_allocator_bytes = 256 * 1024;  // Per frame in flight; grows if a frame needs more
 };
 
 class VulkanContext {
@@ -50,21 +74,51 @@ public:
     // Initialize Vulkan
     bool init(Window& window, const VulkanContextConfig& config = {});
 
+    // Initialize without a window: renders into offscreen images
+    bool init_headless(uint32_t width, uint32_t height, const VulkanContextConfig& config = {});
+
     // Cleanup
     void shutdown();
 
-    // Swapchain management
-    void recreate_swapchain();
-
-    // Frame management
+    // Swapchain management. The render thread owns the swapchain size: it
+    // passes the framebuffer size it got from the main thread (0 while
+    // minimized) and never touches the window. A changed size recreates the
+    // swapchain in the next begin_frame. recreate_swapchain returns false and
+    // leaves the old swapchain alone while the size is 0x0.
+    void set_framebuffer_size(uint32_t width, uint32_t height);
+    bool recreate_swapchain();
+
+    // Frame management. begin_frame acquires an image and opens the frame's
+    // command buffer; end_frame submits and presents it. Render passes are
+    // recorded in between (see begin_render_pass or RenderGraph).
     bool begin_frame(uint32_t& image_index);
-    bool begin_frame(uint32_t& image_index, bool start_render_pass);  // Deferred rendering support
     void end_frame(uint32_t image_index);
-    void end_frame(uint32_t image_index, bool end_render_pass);  // Deferred rendering support
+
+    // Block until the next frame slot's previous submission has completed
+    // (begin_frame does this too). Low-latency loops call it before
+    // sampling input, so the input is as fresh as possible when recorded.
+    void wait_frame();
+
+    // Input-to-display latency. mark_input() tags the frame being recorded
+    // with the time its input was sampled. Every frame slot's fence is
+    // polled at the start and end of wait_frame and after each submit, and
+    // the elapsed time is recorded when the fence is first seen signaled.
+    // That is GPU completion, late by at most the gap between polls (the
+    // same in every mode); presentation follows within one refresh with FIFO.
+    void mark_input(Timer::TimePoint sample_time);
+    InputLatencyStats take_input_latency();  // Samples since the last call
+
+    // Swapchain render pass for the current image (clears, sets viewport/scissor)
+    void begin_render_pass(VkCommandBuffer cmd);
+    void end_render_pass(VkCommandBuffer cmd);
 
     // Wait for device idle (use before shutdown or swapchain recreation)
     void wait_idle();
 
+    // Headless only: copy a rendered image back as tightly packed RGBA8.
+    // Waits for the queue to drain, so keep it out of timed loops.
+    bool read_image(uint32_t image_index, std::vector<uint8_t>& rgba);
+
     // Getters
     VkInstance instance() const { return instance_; }
     VkPhysicalDevice physical_device() const { return physical_device_; }
@@ -81,9 +135,40 @@ public:
     VkCommandPool command_pool() const { return command_pool_; }
     VkCommandBuffer current_command_buffer() const { return command_buffers_[current_frame_]; }
     VkFramebuffer current_framebuffer() const { return framebuffers_[current_image_index_]; }
+    VkImage current_swapchain_image() const { return swapchain_images_[current_image_index_]; }
+    VkImageView current_swapchain_image_view() const { return swapchain_image_views_[current_image_index_]; }
     uint32_t current_frame() const { return current_frame_; }
+    uint32_t max_frames_in_flight() const { return config_.max_frames_in_flight; }
     uint32_t current_image_index() const { return current_image_index_; }
     uint32_t image_count() const { return static_cast<uint32_t>(swapchain_images_.size()); }
+    uint32_t swapchain_generation() const { return swapchain_generation_; }  // Bumped on every recreate
+    uint32_t graphics_queue_family() const { return queue_families_.graphics_family.value(); }
+    bool headless() const { return headless_; }
+
+    // Compressed texture families enabled on the device
+    bool supports_bc() const { return texture_compression_bc_; }
+    bool supports_astc() const { return texture_compression_astc_; }
+    // shaderSampledImageArrayDynamicIndexing enabled on the device
+    bool supports_sampled_image_indexing() const { return sampled_image_indexing_; }
+
+    // Layout the frame's color image ends in: PRESENT_SRC with a swapchain,
+    // TRANSFER_SRC headless (ready for read_image)
+    VkImageLayout present_layout() const {
+        return headless_ ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    }
+
+    // GPU timestamp scopes (frame scope is recorded by begin_frame/end_frame)
+    GpuProfiler& profiler() { return profiler_; }
+    const GpuProfiler& profiler() const { return profiler_; }
+
+    // Device memory accounting (every allocation made through the helpers below)
+    ResourceTracker& resources() { return resources_; }
+    const ResourceTracker& resources() const { return resources_; }
+
+    // Transient CPU memory for the frame being recorded; begin_frame() resets
+    // this frame slot's allocations. Recording thread only.
+    FrameAllocator& frame_allocator() { return frame_allocator_; }
+    const FrameAllocator& frame_allocator() const { return frame_allocator_; }
 
     // Shader helpers
     std::vector<char> load_shader(const std::string& filename);
@@ -91,15 +176,24 @@ public:
 
     // Memory helpers
     uint32_t find_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties) const;
+    bool find_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties,
+                          uint32_t& type_index) const;  // Non-fatal lookup for optional types
 
     // Command buffer helpers
     VkCommandBuffer begin_single_time_commands();
     void end_single_time_commands(VkCommandBuffer command_buffer);
 
+    // Device memory, registered with the resource tracker under category.
+    // free_memory() accepts VK_NULL_HANDLE and resets the handle.
+    VkResult allocate_memory(const VkMemoryAllocateInfo& alloc_info, ResourceCategory category,
+                             VkDeviceMemory& memory);
+    void free_memory(VkDeviceMemory& memory);
+
     // Buffer creation helper
     void create_buffer(VkDeviceSize size, VkBufferUsageFlags usage,
                        VkMemoryPropertyFlags properties,
-                       VkBuffer& buffer, VkDeviceMemory& buffer_memory);
+                       VkBuffer& buffer, VkDeviceMemory& buffer_memory,
+                       ResourceCategory category = ResourceCategory::Other);
 
     void copy_buffer(VkBuffer src, VkBuffer dst, VkDeviceSize size);
 
@@ -111,12 +205,14 @@ private:
     bool pick_physical_device();
     bool create_logical_device();
     bool create_swapchain();
+    bool create_offscreen_images();
     bool create_image_views();
     bool create_render_pass();
     bool create_framebuffers();
     bool create_command_pool();
     bool create_command_buffers();
     bool create_sync_objects();
+    void poll_input_latency();
 
     // Cleanup helpers
     void cleanup_swapchain();
@@ -126,6 +222,8 @@ private:
     SwapchainSupportDetails query_swapchain_support(VkPhysicalDevice device);
     bool is_device_suitable(VkPhysicalDevice device);
     bool check_device_extension_support(VkPhysicalDevice device);
+    bool has_device_extension(VkPhysicalDevice device, const char* name);
+    bool has_instance_extension(const char* name);
 
     // Swapchain helpers
     VkSurfaceFormatKHR choose_surface_format(const std::vector<VkSurfaceFormatKHR>& formats);
@@ -146,6 +244,15 @@ private:
     // Configuration
     VulkanContextConfig config_;
     Window* window_ = nullptr;
+    bool headless_ = false;
+    VkExtent2D headless_extent_{};
+    VkExtent2D framebuffer_extent_{};  // Last size set by the render side
+    bool swapchain_stale_ = false;     // Size changed since the last recreate
+    bool portability_enumeration_ = false;
+    bool texture_compression_bc_ = false;
+    bool texture_compression_astc_ = false;
+    bool sampled_image_indexing_ = false;
+    bool memory_budget_ = false;  // VK_EXT_memory_budget enabled
 
     // Core Vulkan objects
     VkInstance instance_ = VK_NULL_HANDLE;
@@ -165,6 +272,8 @@ private:
     VkExtent2D swapchain_extent_;
     std::vector<VkImage> swapchain_images_;
     std::vector<VkImageView> swapchain_image_views_;
+    std::vector<VkDeviceMemory> offscreen_memory_;  // Headless images only
+    uint32_t swapchain_generation_ = 0;
 
     // Render pass and framebuffers
     VkRenderPass render_pass_ = VK_NULL_HANDLE;
@@ -183,11 +292,18 @@ private:
     uint32_t current_frame_ = 0;
     uint32_t current_image_index_ = 0;
 
-    // Required device extensions
-    const std::vector<const char*> device_extensions_ = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-        "VK_KHR_portability_subset" // Required for MoltenVK
-    };
+    // Input sample time per frame slot (latency measurement)
+    std::vector<Timer::TimePoint> input_times_;
+    std::vector<bool> input_marked_;
+    InputLatencyStats input_latency_;
+
+    GpuProfiler profiler_;
+    ResourceTracker resources_;
+    FrameAllocator frame_allocator_;
+
+    // Required device extensions (swapchain unless headless). Portability
+    // subset is enabled when the device exposes it, as MoltenVK does.
+    std::vector<const char*> device_extensions_;
 
     // Validation layers
     const std::vector<const char*> validation_layers_ = {
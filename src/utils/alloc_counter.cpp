@@ -0,0 +1,89 @@
+/**
+ * Slam Engine - Allocation Counter Implementation
+ *
+ * Replaces the global operator new/delete with malloc/free wrappers that
+ * count. The array and nothrow forms are replaced too so every form is
+ * counted whichever the standard library forwards to.
+ */
+
+#include "alloc_counter.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace slam {
+
+static thread_local uint64_t thread_allocations = 0;
+static std::atomic<uint64_t> total_allocations{0};
+
+uint64_t thread_heap_allocations() {
+    return thread_allocations;
+}
+
+uint64_t heap_allocations() {
+    return total_allocations.load(std::memory_order_relaxed);
+}
+
+static void* counted_alloc(std::size_t size, std::size_t alignment) {
+    thread_allocations++;
+    total_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (size == 0) size = 1;
+    for (;;) {
+        void* memory = nullptr;
+        if (alignment <= alignof(std::max_align_t)) {
+            memory = std::malloc(size);
+        } else if (posix_memalign(&memory, alignment, size) != 0) {
+            memory = nullptr;
+        }
+        if (memory) return memory;
+
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) return nullptr;
+        handler();
+    }
+}
+
+static void* counted_alloc_or_throw(std::size_t size, std::size_t alignment) {
+    void* memory = counted_alloc(size, alignment);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+} // namespace slam
+
+void* operator new(std::size_t size) {
+    return slam::counted_alloc_or_throw(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size) {
+    return slam::counted_alloc_or_throw(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return slam::counted_alloc(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return slam::counted_alloc(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return slam::counted_alloc_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return slam::counted_alloc_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
@@ -0,0 +1,22 @@
+/**
+ * Slam Engine - Allocation Counter
+ *
+ * Counts heap allocations made through operator new (which the engine
+ * replaces in alloc_counter.cpp). Take the per-thread count before and
+ * after a piece of work to see how many allocations it made; a
+ * steady-state frame should make none.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace slam {
+
+// operator new calls made by the calling thread so far
+uint64_t thread_heap_allocations();
+
+// operator new calls made by every thread so far
+uint64_t heap_allocations();
+
+} // namespace slam
@@ -0,0 +1,424 @@
+/**
+ * Slam Engine - Batch Math
+ *
+ * Structure-of-arrays kernels that apply one matrix or one test to many
+ * points, spheres or boxes, BATCH_WIDTH at a time: 8 with AVX2, otherwise 4
+ * on SSE, NEON or the scalar fallback (the math.h backend selection).
+ *
+ * Every component lives in its own array, padded to a multiple of
+ * BATCH_WIDTH and aligned to BATCH_ALIGNMENT, so kernels process whole
+ * registers with no tail loop. Padding lanes hold garbage and are masked
+ * out of every result. The SoA types are views: per-frame data takes its
+ * storage from a FrameAllocator, persistent data from AlignedVector.
+ */
+
+#pragma once
+
+#include "utils/frame_allocator.h"
+#include "utils/math.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace slam {
+
+// ============================================================================
+// Lane operations - BATCH_WIDTH floats at a time
+// ============================================================================
+namespace batch {
+
+#if defined(SLAM_MATH_SSE) && defined(__AVX2__) && defined(__FMA__)
+constexpr size_t WIDTH = 8;
+
+using floatN = __m256;
+using maskN = __m256;
+
+inline floatN load(const float* p) { return _mm256_load_ps(p); }
+inline void store(float* p, floatN v) { _mm256_store_ps(p, v); }
+inline floatN splat(float s) { return _mm256_set1_ps(s); }
+inline floatN add(floatN a, floatN b) { return _mm256_add_ps(a, b); }
+inline floatN sub(floatN a, floatN b) { return _mm256_sub_ps(a, b); }
+inline floatN mul(floatN a, floatN b) { return _mm256_mul_ps(a, b); }
+inline floatN madd(floatN a, floatN b, floatN c) { return _mm256_fmadd_ps(a, b, c); }
+inline floatN min(floatN a, floatN b) { return _mm256_min_ps(a, b); }
+inline floatN max(floatN a, floatN b) { return _mm256_max_ps(a, b); }
+inline floatN abs(floatN a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+inline maskN less_equal(floatN a, floatN b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+inline maskN both(maskN a, maskN b) { return _mm256_and_ps(a, b); }
+inline uint32_t bits(maskN m) { return static_cast<uint32_t>(_mm256_movemask_ps(m)); }
+
+#else
+constexpr size_t WIDTH = 4;
+
+using floatN = simd::float4;
+using simd::load;
+using simd::store;
+using simd::splat;
+using simd::add;
+using simd::sub;
+using simd::mul;
+using simd::madd;
+
+#if defined(SLAM_MATH_SSE)
+using maskN = __m128;
+
+inline floatN min(floatN a, floatN b) { return _mm_min_ps(a, b); }
+inline floatN max(floatN a, floatN b) { return _mm_max_ps(a, b); }
+inline floatN abs(floatN a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline maskN less_equal(floatN a, floatN b) { return _mm_cmple_ps(a, b); }
+inline maskN both(maskN a, maskN b) { return _mm_and_ps(a, b); }
+inline uint32_t bits(maskN m) { return static_cast<uint32_t>(_mm_movemask_ps(m)); }
+
+#elif defined(SLAM_MATH_NEON)
+using maskN = uint32x4_t;
+
+inline floatN min(floatN a, floatN b) { return vminq_f32(a, b); }
+inline floatN max(floatN a, floatN b) { return vmaxq_f32(a, b); }
+inline floatN abs(floatN a) { return vabsq_f32(a); }
+inline maskN less_equal(floatN a, floatN b) { return vcleq_f32(a, b); }
+inline maskN both(maskN a, maskN b) { return vandq_u32(a, b); }
+inline uint32_t bits(maskN m) {
+    const uint32x4_t weights = {1, 2, 4, 8};
+    return vaddvq_u32(vandq_u32(m, weights));
+}
+
+#else
+using maskN = uint32_t;  // One bit per lane
+
+inline floatN min(floatN a, floatN b) {
+    return {{std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]),
+             std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3])}};
+}
+inline floatN max(floatN a, floatN b) {
+    return {{std::max(a.v[0], b.v[0]), std::max(a.v[1], b.v[1]),
+             std::max(a.v[2], b.v[2]), std::max(a.v[3], b.v[3])}};
+}
+inline floatN abs(floatN a) {
+    return {{std::abs(a.v[0]), std::abs(a.v[1]), std::abs(a.v[2]), std::abs(a.v[3])}};
+}
+inline maskN less_equal(floatN a, floatN b) {
+    return (a.v[0] <= b.v[0] ? 1u : 0u) | (a.v[1] <= b.v[1] ? 2u : 0u) |
+           (a.v[2] <= b.v[2] ? 4u : 0u) | (a.v[3] <= b.v[3] ? 8u : 0u);
+}
+inline maskN both(maskN a, maskN b) { return a & b; }
+inline uint32_t bits(maskN m) { return m; }
+#endif
+#endif
+
+// Lanes [0, count) of a block that may run past the end of the array
+inline uint32_t lanes_below(size_t count) {
+    return count >= WIDTH ? (1u << WIDTH) - 1 : (1u << count) - 1;
+}
+
+// Append first + (index of each set bit) to out, up to limit entries
+inline uint32_t emit_lanes(uint32_t lanes, uint32_t first, uint32_t* out, uint32_t written, uint32_t limit) {
+    while (lanes && written < limit) {
+        out[written++] = first + static_cast<uint32_t>(__builtin_ctz(lanes));
+        lanes &= lanes - 1;
+    }
+    return written;
+}
+
+} // namespace batch
+
+constexpr size_t BATCH_WIDTH = batch::WIDTH;
+constexpr size_t BATCH_ALIGNMENT = 32;
+
+// Array length covering count elements in whole blocks
+inline size_t batch_padded(size_t count) {
+    return (count + BATCH_WIDTH - 1) / BATCH_WIDTH * BATCH_WIDTH;
+}
+
+// ============================================================================
+// Aligned storage
+// ============================================================================
+
+inline void* aligned_malloc(size_t size, size_t alignment = BATCH_ALIGNMENT) {
+    return ::operator new(size, std::align_val_t(alignment));
+}
+
+inline void aligned_free(void* memory, size_t alignment = BATCH_ALIGNMENT) {
+    ::operator delete(memory, std::align_val_t(alignment));
+}
+
+// STL allocator for persistent batch arrays
+template <typename T, size_t Alignment = BATCH_ALIGNMENT>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t count) { return static_cast<T*>(aligned_malloc(count * sizeof(T), Alignment)); }
+    void deallocate(T* memory, size_t) { aligned_free(memory, Alignment); }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+// One component array for count elements from this frame's memory
+inline float* allocate_lanes(FrameAllocator& frame, size_t count) {
+    return static_cast<float*>(frame.allocate(batch_padded(count) * sizeof(float), BATCH_ALIGNMENT));
+}
+
+// ============================================================================
+// SoA views
+// ============================================================================
+
+struct PointsSoA {
+    float* x = nullptr;
+    float* y = nullptr;
+    float* z = nullptr;
+    size_t count = 0;
+
+    static PointsSoA allocate(FrameAllocator& frame, size_t count) {
+        PointsSoA points;
+        points.x = allocate_lanes(frame, count);
+        points.y = allocate_lanes(frame, count);
+        points.z = allocate_lanes(frame, count);
+        points.count = count;
+        return points;
+    }
+
+    void set(size_t i, const vec3& p) { x[i] = p.x; y[i] = p.y; z[i] = p.z; }
+    vec3 get(size_t i) const { return vec3(x[i], y[i], z[i]); }
+};
+
+struct SpheresSoA {
+    float* x = nullptr;
+    float* y = nullptr;
+    float* z = nullptr;
+    float* radius = nullptr;
+    size_t count = 0;
+
+    static SpheresSoA allocate(FrameAllocator& frame, size_t count) {
+        SpheresSoA spheres;
+        spheres.x = allocate_lanes(frame, count);
+        spheres.y = allocate_lanes(frame, count);
+        spheres.z = allocate_lanes(frame, count);
+        spheres.radius = allocate_lanes(frame, count);
+        spheres.count = count;
+        return spheres;
+    }
+
+    void set(size_t i, const vec3& center, float r) { x[i] = center.x; y[i] = center.y; z[i] = center.z; radius[i] = r; }
+    vec3 center(size_t i) const { return vec3(x[i], y[i], z[i]); }
+};
+
+struct AabbsSoA {
+    float* min_x = nullptr;
+    float* min_y = nullptr;
+    float* min_z = nullptr;
+    float* max_x = nullptr;
+    float* max_y = nullptr;
+    float* max_z = nullptr;
+    size_t count = 0;
+
+    static AabbsSoA allocate(FrameAllocator& frame, size_t count) {
+        AabbsSoA boxes;
+        boxes.min_x = allocate_lanes(frame, count);
+        boxes.min_y = allocate_lanes(frame, count);
+        boxes.min_z = allocate_lanes(frame, count);
+        boxes.max_x = allocate_lanes(frame, count);
+        boxes.max_y = allocate_lanes(frame, count);
+        boxes.max_z = allocate_lanes(frame, count);
+        boxes.count = count;
+        return boxes;
+    }
+
+    void set(size_t i, const vec3& lo, const vec3& hi) {
+        min_x[i] = lo.x; min_y[i] = lo.y; min_z[i] = lo.z;
+        max_x[i] = hi.x; max_y[i] = hi.y; max_z[i] = hi.z;
+    }
+    vec3 min(size_t i) const { return vec3(min_x[i], min_y[i], min_z[i]); }
+    vec3 max(size_t i) const { return vec3(max_x[i], max_y[i], max_z[i]); }
+};
+
+// Six inward-facing planes (xyz normal, w distance): a point p is inside
+// when dot(normal, p) + w >= 0 for every plane
+struct Frustum {
+    vec4 planes[6];
+
+    // Planes of a Vulkan clip space (z in [0, 1]) view-projection matrix
+    static Frustum from_matrix(const mat4& view_proj) {
+        vec4 row0(view_proj[0][0], view_proj[1][0], view_proj[2][0], view_proj[3][0]);
+        vec4 row1(view_proj[0][1], view_proj[1][1], view_proj[2][1], view_proj[3][1]);
+        vec4 row2(view_proj[0][2], view_proj[1][2], view_proj[2][2], view_proj[3][2]);
+        vec4 row3(view_proj[0][3], view_proj[1][3], view_proj[2][3], view_proj[3][3]);
+
+        Frustum frustum;
+        frustum.planes[0] = row3 + row0;  // Left
+        frustum.planes[1] = row3 - row0;  // Right
+        frustum.planes[2] = row3 + row1;  // Bottom
+        frustum.planes[3] = row3 - row1;  // Top
+        frustum.planes[4] = row2;         // Near
+        frustum.planes[5] = row3 - row2;  // Far
+        for (vec4& plane : frustum.planes) {
+            float length = plane.xyz().length();
+            if (length > EPSILON) plane = plane / length;
+        }
+        return frustum;
+    }
+};
+
+// ============================================================================
+// Transform kernels (out must have room for in.count elements; it may alias in)
+// ============================================================================
+
+// out = m * (p, 1); m is affine
+inline void transform_points(const mat4& m, const PointsSoA& in, PointsSoA& out) {
+    using namespace batch;
+    floatN m00 = splat(m[0][0]), m01 = splat(m[0][1]), m02 = splat(m[0][2]);
+    floatN m10 = splat(m[1][0]), m11 = splat(m[1][1]), m12 = splat(m[1][2]);
+    floatN m20 = splat(m[2][0]), m21 = splat(m[2][1]), m22 = splat(m[2][2]);
+    floatN m30 = splat(m[3][0]), m31 = splat(m[3][1]), m32 = splat(m[3][2]);
+
+    for (size_t i = 0; i < in.count; i += WIDTH) {
+        floatN x = load(in.x + i), y = load(in.y + i), z = load(in.z + i);
+        store(out.x + i, madd(m00, x, madd(m10, y, madd(m20, z, m30))));
+        store(out.y + i, madd(m01, x, madd(m11, y, madd(m21, z, m31))));
+        store(out.z + i, madd(m02, x, madd(m12, y, madd(m22, z, m32))));
+    }
+    out.count = in.count;
+}
+
+// Centers by m, radii by m's largest axis scale (exact for rigid and
+// uniformly scaled m, conservative otherwise)
+inline void transform_spheres(const mat4& m, const SpheresSoA& in, SpheresSoA& out) {
+    PointsSoA centers{in.x, in.y, in.z, in.count};
+    PointsSoA out_centers{out.x, out.y, out.z, in.count};
+    transform_points(m, centers, out_centers);
+
+    float scale_sq = std::max(m[0].xyz().length_squared(),
+                              std::max(m[1].xyz().length_squared(), m[2].xyz().length_squared()));
+    batch::floatN scale = batch::splat(std::sqrt(scale_sq));
+    for (size_t i = 0; i < in.count; i += BATCH_WIDTH) {
+        batch::store(out.radius + i, batch::mul(batch::load(in.radius + i), scale));
+    }
+    out.count = in.count;
+}
+
+// Boxes enclosing the transformed boxes (center and half extents, Arvo)
+inline void transform_aabbs(const mat4& m, const AabbsSoA& in, AabbsSoA& out) {
+    using namespace batch;
+    floatN m00 = splat(m[0][0]), m01 = splat(m[0][1]), m02 = splat(m[0][2]);
+    floatN m10 = splat(m[1][0]), m11 = splat(m[1][1]), m12 = splat(m[1][2]);
+    floatN m20 = splat(m[2][0]), m21 = splat(m[2][1]), m22 = splat(m[2][2]);
+    floatN m30 = splat(m[3][0]), m31 = splat(m[3][1]), m32 = splat(m[3][2]);
+    floatN a00 = abs(m00), a01 = abs(m01), a02 = abs(m02);
+    floatN a10 = abs(m10), a11 = abs(m11), a12 = abs(m12);
+    floatN a20 = abs(m20), a21 = abs(m21), a22 = abs(m22);
+    floatN half = splat(0.5f);
+
+    for (size_t i = 0; i < in.count; i += WIDTH) {
+        floatN lo_x = load(in.min_x + i), lo_y = load(in.min_y + i), lo_z = load(in.min_z + i);
+        floatN hi_x = load(in.max_x + i), hi_y = load(in.max_y + i), hi_z = load(in.max_z + i);
+        floatN cx = mul(add(lo_x, hi_x), half), cy = mul(add(lo_y, hi_y), half), cz = mul(add(lo_z, hi_z), half);
+        floatN ex = mul(sub(hi_x, lo_x), half), ey = mul(sub(hi_y, lo_y), half), ez = mul(sub(hi_z, lo_z), half);
+
+        floatN tx = madd(m00, cx, madd(m10, cy, madd(m20, cz, m30)));
+        floatN ty = madd(m01, cx, madd(m11, cy, madd(m21, cz, m31)));
+        floatN tz = madd(m02, cx, madd(m12, cy, madd(m22, cz, m32)));
+        floatN rx = madd(a00, ex, madd(a10, ey, mul(a20, ez)));
+        floatN ry = madd(a01, ex, madd(a11, ey, mul(a21, ez)));
+        floatN rz = madd(a02, ex, madd(a12, ey, mul(a22, ez)));
+
+        store(out.min_x + i, sub(tx, rx));
+        store(out.min_y + i, sub(ty, ry));
+        store(out.min_z + i, sub(tz, rz));
+        store(out.max_x + i, add(tx, rx));
+        store(out.max_y + i, add(ty, ry));
+        store(out.max_z + i, add(tz, rz));
+    }
+    out.count = in.count;
+}
+
+// ============================================================================
+// Test kernels: write matching indices in ascending order, return how many
+// ============================================================================
+
+// Spheres touching the box [lo, hi], at most limit of them (light binning)
+inline uint32_t spheres_touching_aabb(const SpheresSoA& spheres, const vec3& lo, const vec3& hi,
+                                      uint32_t* out, uint32_t limit) {
+    using namespace batch;
+    floatN lo_x = splat(lo.x), lo_y = splat(lo.y), lo_z = splat(lo.z);
+    floatN hi_x = splat(hi.x), hi_y = splat(hi.y), hi_z = splat(hi.z);
+    floatN zero = splat(0.0f);
+
+    uint32_t written = 0;
+    for (size_t i = 0; i < spheres.count && written < limit; i += WIDTH) {
+        floatN x = load(spheres.x + i), y = load(spheres.y + i), z = load(spheres.z + i);
+        floatN r = load(spheres.radius + i);
+
+        // Distance from the center to the box, per axis (zero inside)
+        floatN dx = add(max(sub(lo_x, x), zero), max(sub(x, hi_x), zero));
+        floatN dy = add(max(sub(lo_y, y), zero), max(sub(y, hi_y), zero));
+        floatN dz = add(max(sub(lo_z, z), zero), max(sub(z, hi_z), zero));
+        floatN dist_sq = madd(dx, dx, madd(dy, dy, mul(dz, dz)));
+
+        uint32_t lanes = bits(less_equal(dist_sq, mul(r, r))) & lanes_below(spheres.count - i);
+        written = emit_lanes(lanes, static_cast<uint32_t>(i), out, written, limit);
+    }
+    return written;
+}
+
+// Spheres at least partly inside the frustum
+inline uint32_t cull_spheres(const Frustum& frustum, const SpheresSoA& spheres, uint32_t* visible) {
+    using namespace batch;
+    uint32_t written = 0;
+    for (size_t i = 0; i < spheres.count; i += WIDTH) {
+        floatN x = load(spheres.x + i), y = load(spheres.y + i), z = load(spheres.z + i);
+        floatN neg_r = sub(splat(0.0f), load(spheres.radius + i));
+
+        uint32_t lanes = lanes_below(spheres.count - i);
+        for (const vec4& plane : frustum.planes) {
+            floatN distance = madd(splat(plane.x), x, madd(splat(plane.y), y, madd(splat(plane.z), z, splat(plane.w))));
+            lanes &= bits(less_equal(neg_r, distance));
+        }
+        written = emit_lanes(lanes, static_cast<uint32_t>(i), visible, written, UINT32_MAX);
+    }
+    return written;
+}
+
+// Boxes at least partly inside the frustum (tests each plane against the
+// box corner furthest along its normal; may keep boxes near frustum corners)
+inline uint32_t cull_aabbs(const Frustum& frustum, const AabbsSoA& boxes, uint32_t* visible) {
+    using namespace batch;
+
+    // The furthest corner's arrays depend only on the plane's normal signs
+    const float* corner[6][3];
+    for (int p = 0; p < 6; p++) {
+        const vec4& plane = frustum.planes[p];
+        corner[p][0] = plane.x >= 0.0f ? boxes.max_x : boxes.min_x;
+        corner[p][1] = plane.y >= 0.0f ? boxes.max_y : boxes.min_y;
+        corner[p][2] = plane.z >= 0.0f ? boxes.max_z : boxes.min_z;
+    }
+
+    floatN zero = splat(0.0f);
+    uint32_t written = 0;
+    for (size_t i = 0; i < boxes.count; i += WIDTH) {
+        uint32_t lanes = lanes_below(boxes.count - i);
+        for (int p = 0; p < 6 && lanes; p++) {
+            const vec4& plane = frustum.planes[p];
+            floatN distance = madd(splat(plane.x), load(corner[p][0] + i),
+                              madd(splat(plane.y), load(corner[p][1] + i),
+                              madd(splat(plane.z), load(corner[p][2] + i), splat(plane.w))));
+            lanes &= bits(less_equal(zero, distance));
+        }
+        written = emit_lanes(lanes, static_cast<uint32_t>(i), visible, written, UINT32_MAX);
+    }
+    return written;
+}
+
+} // namespace slam
@@ -0,0 +1,145 @@
+/**
+ * Slam Engine - Benchmark Log
+ *
+ * Per-frame timing table for headless benchmark runs. Columns are created
+ * on first use (cpu_ms plus one per GPU profiler scope), written as CSV and
+ * summarized with averages and percentiles.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace slam {
+
+class BenchLog {
+public:
+    // Start a run of frame_count frames
+    void reset(uint32_t frame_count) {
+        frame_count_ = frame_count;
+        names_.clear();
+        columns_.clear();
+    }
+
+    // Record a value (milliseconds, or a per-frame count) for a frame;
+    // out-of-range frames are ignored
+    void record(const char* column, uint64_t frame, double value) {
+        if (frame >= frame_count_) return;
+        columns_[column_index(column)][frame] = value;
+    }
+
+    bool write_csv(const std::string& path) const {
+        FILE* file = fopen(path.c_str(), "w");
+        if (!file) {
+            fprintf(stderr, "Failed to open benchmark output: %s\n", path.c_str());
+            return false;
+        }
+
+        fprintf(file, "frame");
+        for (const std::string& name : names_) {
+            fprintf(file, ",%s", name.c_str());
+        }
+        fprintf(file, "\n");
+
+        for (uint32_t frame = 0; frame < frame_count_; frame++) {
+            fprintf(file, "%u", frame);
+            for (const std::vector<double>& column : columns_) {
+                if (std::isnan(column[frame])) {
+                    fprintf(file, ",");
+                } else {
+                    fprintf(file, ",%.4f", column[frame]);
+                }
+            }
+            fprintf(file, "\n");
+        }
+
+        fclose(file);
+        return true;
+    }
+
+    // Average and percentiles per column, ignoring the first skip_frames
+    // (pipeline warm-up)
+    void print_summary(uint32_t skip_frames) const {
+        printf("Benchmark: %u frames (first %u skipped)\n", frame_count_, skip_frames);
+        printf("  %-28s %8s %8s %8s %8s\n", "column", "avg", "p50", "p95", "p99");
+
+        std::vector<double> values;
+        for (size_t c = 0; c < columns_.size(); c++) {
+            values.clear();
+            for (uint32_t frame = skip_frames; frame < frame_count_; frame++) {
+                if (!std::isnan(columns_[c][frame])) {
+                    values.push_back(columns_[c][frame]);
+                }
+            }
+            if (values.empty()) continue;
+
+            std::sort(values.begin(), values.end());
+            double sum = 0.0;
+            for (double v : values) sum += v;
+
+            auto percentile = [&](double p) {
+                return values[static_cast<size_t>(p * (values.size() - 1) + 0.5)];
+            };
+
+            printf("  %-28s %8.3f %8.3f %8.3f %8.3f\n", names_[c].c_str(),
+                sum / values.size(), percentile(0.50), percentile(0.95), percentile(0.99));
+        }
+    }
+
+private:
+    size_t column_index(const char* name) {
+        for (size_t i = 0; i < names_.size(); i++) {
+            if (names_[i] == name) return i;
+        }
+        names_.push_back(name);
+        columns_.emplace_back(frame_count_, std::nan(""));
+        return names_.size() - 1;
+    }
+
+    uint32_t frame_count_ = 0;
+    std::vector<std::string> names_;
+    std::vector<std::vector<double>> columns_;
+};
+
+// Write tightly packed RGBA8 pixels as an uncompressed 32-bit TGA
+inline bool write_tga(const std::string& path, uint32_t width, uint32_t height,
+                      const std::vector<uint8_t>& rgba) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        fprintf(stderr, "Failed to open image output: %s\n", path.c_str());
+        return false;
+    }
+
+    uint8_t header[18] = {};
+    header[2] = 2;  // Uncompressed true color
+    header[12] = static_cast<uint8_t>(width & 0xFF);
+    header[13] = static_cast<uint8_t>((width >> 8) & 0xFF);
+    header[14] = static_cast<uint8_t>(height & 0xFF);
+    header[15] = static_cast<uint8_t>((height >> 8) & 0xFF);
+    header[16] = 32;
+    header[17] = 0x28;  // Top-left origin, 8 alpha bits
+    fwrite(header, 1, sizeof(header), file);
+
+    // TGA stores BGRA
+    std::vector<uint8_t> row(static_cast<size_t>(width) * 4);
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* src = &rgba[static_cast<size_t>(y) * width * 4];
+        for (uint32_t x = 0; x < width; x++) {
+            row[x * 4 + 0] = src[x * 4 + 2];
+            row[x * 4 + 1] = src[x * 4 + 1];
+            row[x * 4 + 2] = src[x * 4 + 0];
+            row[x * 4 + 3] = src[x * 4 + 3];
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+
+    fclose(file);
+    return true;
+}
+
+} // namespace slam
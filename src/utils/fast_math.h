@@ -0,0 +1,116 @@
+/**
+ * Slam Engine - Fast Math
+ *
+ * Opt-in approximations of sqrt, sin/cos and pow for hot loops where a
+ * few ulps do not matter (animation, falloff, direction vectors). Nothing
+ * here replaces the exact functions in math.h; call fast:: explicitly.
+ *
+ * Every function is branch-free (selects, not jumps) so loops over them
+ * vectorize. The bounds below hold over the stated domains; tools/math_bench
+ * checks each against the std version and fails if one is exceeded:
+ *
+ *   rsqrt, sqrt    x > 0 (normal)              relative  5e-6
+ *   sin, cos       |x| <= 1024*PI              absolute  2.5e-7
+ *   exp2           -126 <= x <= 127            relative  2.5e-7
+ *   log2           x > 0 (normal)              absolute  2.5e-7 * max(1, |log2(x)|)
+ *   pow            x > 0, |y*log2(x)| <= 32    relative  5e-6
+ *
+ * Outside those domains results are unspecified (no NaN/inf handling).
+ */
+
+#pragma once
+
+#include "math.h"
+#include <cstdint>
+#include <cstring>
+
+namespace slam {
+namespace fast {
+
+inline uint32_t float_bits(float x) { uint32_t bits; memcpy(&bits, &x, sizeof(bits)); return bits; }
+inline float bits_float(uint32_t bits) { float x; memcpy(&x, &bits, sizeof(x)); return x; }
+
+// ============================================================================
+// Reciprocal square root
+// ============================================================================
+
+// Bit-trick estimate plus two Newton steps. Plain float ops, unlike the
+// scalar rsqrtss intrinsic, so loops vectorize and every backend agrees.
+inline float rsqrt(float x) {
+    float y = bits_float(0x5f375a86u - (float_bits(x) >> 1));
+    y = y * (1.5f - 0.5f * x * y * y);
+    return y * (1.5f - 0.5f * x * y * y);
+}
+
+inline float sqrt(float x) { return x * rsqrt(x); }
+
+// Unit vector without a divide; v must be non-zero
+inline vec3 normalize(const vec3& v) { return v * rsqrt(dot(v, v)); }
+inline vec4 normalize(const vec4& v) { return v * rsqrt(dot(v, v)); }
+
+// ============================================================================
+// Sine and cosine
+// ============================================================================
+
+// Minimax odd polynomial for sin on [-PI/2, PI/2], r already reduced
+inline float sin_reduced(float r) {
+    float r2 = r * r;
+    float p = -1.666665710e-01f + r2 * (8.333017266e-03f + r2 * (-1.980661331e-04f + r2 * 2.600050551e-06f));
+    return r + r * r2 * p;
+}
+
+// x - n*PI with PI in two parts, so the product with the high part is exact
+inline float subtract_pi_multiple(float x, float n) {
+    return (x - n * 3.140625f) - n * 9.67653589793e-4f;
+}
+
+// Negate when k is odd
+inline float flip_if_odd(float value, int32_t k) {
+    return bits_float(float_bits(value) ^ (static_cast<uint32_t>(k) << 31));
+}
+
+// Round to nearest (half away from zero) without a libm call
+inline int32_t round_int(float x) { return static_cast<int32_t>(x + (x >= 0.0f ? 0.5f : -0.5f)); }
+
+// sin(x) = (-1)^k sin(x - k*PI)
+inline float sin(float x) {
+    int32_t k = round_int(x * (1.0f / PI));
+    return flip_if_odd(sin_reduced(subtract_pi_multiple(x, static_cast<float>(k))), k);
+}
+
+// cos(x) = (-1)^(k+1) sin(x - (k + 1/2)*PI); reduced separately rather than
+// as sin(x + PI/2), which would round x first
+inline float cos(float x) {
+    int32_t k = round_int(x * (1.0f / PI) - 0.5f);
+    return flip_if_odd(sin_reduced(subtract_pi_multiple(x, static_cast<float>(k) + 0.5f)), k + 1);
+}
+
+// ============================================================================
+// Exponent and logarithm
+// ============================================================================
+
+inline float exp2(float x) {
+    int32_t i = static_cast<int32_t>(x);
+    i -= (x < static_cast<float>(i)) ? 1 : 0;  // floor
+    float f = x - static_cast<float>(i);
+    float p = 9.999999252e-01f + f * (6.931530715e-01f + f * (2.401536243e-01f +
+              f * (5.582630759e-02f + f * (8.989343715e-03f + f * 1.877578052e-03f))));
+    return p * bits_float(static_cast<uint32_t>(i + 127) << 23);
+}
+
+inline float log2(float x) {
+    // Offset the bits so the mantissa lands in [sqrt(1/2), sqrt(2)), centred
+    // on 1, and the exponent absorbs the difference (integer ops only)
+    int32_t bits = static_cast<int32_t>(float_bits(x)) - 0x3f3504f3;
+    int32_t e = bits >> 23;
+    float t = bits_float(static_cast<uint32_t>(bits & 0x007fffff) + 0x3f3504f3u) - 1.0f;
+    float q = 1.442694962e+00f + t * (-7.213527890e-01f + t * (4.809232477e-01f + t * (-3.602395889e-01f +
+              t * (2.870984873e-01f + t * (-2.488773399e-01f + t * (2.340444545e-01f + t * -1.458128020e-01f))))));
+    return static_cast<float>(e) + t * q;
+}
+
+// x > 0; the log2 error is scaled by y, so accuracy falls with |y*log2(x)|
+inline float pow(float x, float y) { return exp2(y * log2(x)); }
+
+} // namespace fast
+} // namespace slam
@@ -0,0 +1,319 @@
+/**
+ * Slam Engine - Fixed-Point Math
+ *
+ * Deterministic Q16.16 scalar, vector, quaternion and matrix types for
+ * simulation state that must match bit for bit across machines (client
+ * prediction, lag compensation, replays). Float results in math.h depend
+ * on FMA contraction, SIMD backend and compiler flags, so an x86 server and
+ * an ARM client drift apart; everything here is integer arithmetic with a
+ * fixed evaluation order, so it cannot.
+ *
+ * Range is +-32767 with a resolution of 1/65536. Products and quotients
+ * round to nearest; overflow wraps (two's complement), it does not trap.
+ * Lengths are the exception: they saturate at the largest fixed value, and
+ * normalize() still works for vectors longer than the range. Negative
+ * values rely on arithmetic right shift, which every supported compiler
+ * does (and C++20 requires). Convert from float only when loading data and
+ * to float only for rendering. tools/math_bench hashes a long simulation
+ * against a golden value, so a change that alters any result fails there
+ * on every platform.
+ */
+
+#pragma once
+
+#include "math.h"
+#include <cstdint>
+#include <cmath>
+
+namespace slam {
+
+// ============================================================================
+// fixed - Q16.16 scalar
+// ============================================================================
+struct fixed {
+    static constexpr int FRACTION_BITS = 16;
+    static constexpr int32_t ONE = 1 << FRACTION_BITS;
+
+    int32_t raw;
+
+    constexpr fixed() : raw(0) {}
+    // Explicit so unqualified abs(), floor() etc. never pick up an int or float
+    constexpr explicit fixed(int value) : raw(value * ONE) {}
+
+    static constexpr fixed from_raw(int32_t raw) { fixed f; f.raw = raw; return f; }
+    // p / q, rounded toward zero (exact constants such as 1/2 or 3/4)
+    static constexpr fixed ratio(int32_t p, int32_t q) {
+        return from_raw(static_cast<int32_t>(static_cast<int64_t>(p) * ONE / q));
+    }
+    // Load time only (scaling by 2^16 is exact, so this is deterministic too)
+    static fixed from_float(float value) { return from_raw(static_cast<int32_t>(std::lround(value * ONE))); }
+    float to_float() const { return static_cast<float>(raw) * (1.0f / ONE); }
+
+    // Unsigned arithmetic so overflow wraps instead of being undefined
+    fixed operator+(fixed b) const {
+        return from_raw(static_cast<int32_t>(static_cast<uint32_t>(raw) + static_cast<uint32_t>(b.raw)));
+    }
+    fixed operator-(fixed b) const {
+        return from_raw(static_cast<int32_t>(static_cast<uint32_t>(raw) - static_cast<uint32_t>(b.raw)));
+    }
+    fixed operator-() const { return from_raw(static_cast<int32_t>(0u - static_cast<uint32_t>(raw))); }
+
+    fixed operator*(fixed b) const {
+        int64_t product = static_cast<int64_t>(raw) * b.raw;
+        return from_raw(static_cast<int32_t>((product + (ONE / 2)) >> FRACTION_BITS));
+    }
+    // Division by zero saturates toward the sign of the dividend
+    fixed operator/(fixed b) const {
+        if (b.raw == 0) return from_raw(raw >= 0 ? INT32_MAX : INT32_MIN);
+        int64_t numerator = static_cast<int64_t>(raw) * ONE;
+        int64_t half = (b.raw > 0 ? b.raw : -static_cast<int64_t>(b.raw)) / 2;
+        return from_raw(static_cast<int32_t>((numerator + (numerator >= 0 ? half : -half)) / b.raw));
+    }
+
+    fixed& operator+=(fixed b) { return *this = *this + b; }
+    fixed& operator-=(fixed b) { return *this = *this - b; }
+    fixed& operator*=(fixed b) { return *this = *this * b; }
+    fixed& operator/=(fixed b) { return *this = *this / b; }
+
+    bool operator==(fixed b) const { return raw == b.raw; }
+    bool operator!=(fixed b) const { return raw != b.raw; }
+    bool operator<(fixed b) const { return raw < b.raw; }
+    bool operator<=(fixed b) const { return raw <= b.raw; }
+    bool operator>(fixed b) const { return raw > b.raw; }
+    bool operator>=(fixed b) const { return raw >= b.raw; }
+};
+
+// Rounded to the nearest 1/65536
+constexpr fixed FIXED_PI = fixed::from_raw(205887);
+constexpr fixed FIXED_TWO_PI = fixed::from_raw(411775);
+constexpr fixed FIXED_HALF_PI = fixed::from_raw(102944);
+
+inline fixed abs(fixed a) { return a.raw < 0 ? -a : a; }
+inline fixed min(fixed a, fixed b) { return a < b ? a : b; }
+inline fixed max(fixed a, fixed b) { return a > b ? a : b; }
+inline fixed clamp(fixed v, fixed lo, fixed hi) { return min(max(v, lo), hi); }
+inline fixed floor(fixed a) { return fixed::from_raw(a.raw & ~(fixed::ONE - 1)); }
+inline fixed lerp(fixed a, fixed b, fixed t) { return a + (b - a) * t; }
+
+// floor(sqrt(n)), bit by bit
+inline uint32_t isqrt64(uint64_t n) {
+    uint64_t result = 0;
+    uint64_t bit = uint64_t(1) << 62;
+    while (bit > n) bit >>= 2;
+    while (bit != 0) {
+        if (n >= result + bit) {
+            n -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return static_cast<uint32_t>(result);
+}
+
+// Length from a sum of squared raw values. A vector can be up to sqrt(3)
+// (sqrt(4) for a quaternion) times the fixed range long; past the range
+// the result saturates instead of wrapping negative.
+inline fixed length_from_squares(uint64_t sum) {
+    uint32_t root = isqrt64(sum);
+    return fixed::from_raw(root > static_cast<uint32_t>(INT32_MAX) ? INT32_MAX : static_cast<int32_t>(root));
+}
+
+// Negative input returns 0
+inline fixed sqrt(fixed a) {
+    if (a.raw <= 0) return fixed();
+    return fixed::from_raw(static_cast<int32_t>(isqrt64(static_cast<uint64_t>(a.raw) << fixed::FRACTION_BITS)));
+}
+
+// Minimax polynomial in Q2.30 after folding into [-PI/2, PI/2]; within
+// 2/65536 of the true value. Keep angles wrapped: FIXED_TWO_PI is rounded,
+// so the period drifts slightly for very large arguments.
+inline fixed sin(fixed angle) {
+    int32_t a = angle.raw % FIXED_TWO_PI.raw;
+    if (a > FIXED_PI.raw) a -= FIXED_TWO_PI.raw;
+    else if (a < -FIXED_PI.raw) a += FIXED_TWO_PI.raw;
+    if (a > FIXED_HALF_PI.raw) a = FIXED_PI.raw - a;
+    else if (a < -FIXED_HALF_PI.raw) a = -FIXED_PI.raw - a;
+
+    int64_t x = static_cast<int64_t>(a) * (1 << 14);  // Q30
+    int64_t x2 = (x * x) >> 30;
+    int64_t p = 2792;
+    p = -212672 + ((p * x2) >> 30);
+    p = 8947509 + ((p * x2) >> 30);
+    p = -178956868 + ((p * x2) >> 30);
+    int64_t s = x + ((((x * x2) >> 30) * p) >> 30);
+    return fixed::from_raw(static_cast<int32_t>((s + (1 << 13)) >> 14));
+}
+
+inline fixed cos(fixed angle) { return sin(angle + FIXED_HALF_PI); }
+
+// ============================================================================
+// fvec3
+// ============================================================================
+struct fvec3 {
+    fixed x, y, z;
+
+    fvec3() {}
+    fvec3(fixed x, fixed y, fixed z) : x(x), y(y), z(z) {}
+
+    static fvec3 from_vec3(const vec3& v) {
+        return fvec3(fixed::from_float(v.x), fixed::from_float(v.y), fixed::from_float(v.z));
+    }
+    vec3 to_vec3() const { return vec3(x.to_float(), y.to_float(), z.to_float()); }
+
+    fvec3 operator+(const fvec3& v) const { return fvec3(x + v.x, y + v.y, z + v.z); }
+    fvec3 operator-(const fvec3& v) const { return fvec3(x - v.x, y - v.y, z - v.z); }
+    fvec3 operator*(fixed s) const { return fvec3(x * s, y * s, z * s); }
+    fvec3 operator/(fixed s) const { return fvec3(x / s, y / s, z / s); }
+    fvec3 operator*(const fvec3& v) const { return fvec3(x * v.x, y * v.y, z * v.z); }
+    fvec3 operator-() const { return fvec3(-x, -y, -z); }
+
+    fvec3& operator+=(const fvec3& v) { return *this = *this + v; }
+    fvec3& operator-=(const fvec3& v) { return *this = *this - v; }
+    fvec3& operator*=(fixed s) { return *this = *this * s; }
+
+    bool operator==(const fvec3& v) const { return x == v.x && y == v.y && z == v.z; }
+    bool operator!=(const fvec3& v) const { return !(*this == v); }
+
+    // Squares summed in 64 bits; saturates for lengths past 32767
+    fixed length() const {
+        uint64_t sum = static_cast<uint64_t>(static_cast<int64_t>(x.raw) * x.raw) +
+                       static_cast<uint64_t>(static_cast<int64_t>(y.raw) * y.raw) +
+                       static_cast<uint64_t>(static_cast<int64_t>(z.raw) * z.raw);
+        return length_from_squares(sum);
+    }
+};
+
+inline fvec3 operator*(fixed s, const fvec3& v) { return v * s; }
+
+// One rounding for the whole sum
+inline fixed dot(const fvec3& a, const fvec3& b) {
+    int64_t sum = static_cast<int64_t>(a.x.raw) * b.x.raw + static_cast<int64_t>(a.y.raw) * b.y.raw +
+                  static_cast<int64_t>(a.z.raw) * b.z.raw;
+    return fixed::from_raw(static_cast<int32_t>((sum + (fixed::ONE / 2)) >> fixed::FRACTION_BITS));
+}
+
+inline fvec3 cross(const fvec3& a, const fvec3& b) {
+    return fvec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+inline fvec3 normalize(const fvec3& v) {
+    fixed len = v.length();
+    if (len.raw == INT32_MAX) {
+        // Too long to measure: a quarter of it always fits (sqrt(3) / 4 < 1)
+        return normalize(fvec3(fixed::from_raw(v.x.raw >> 2), fixed::from_raw(v.y.raw >> 2),
+                               fixed::from_raw(v.z.raw >> 2)));
+    }
+    return len.raw > 0 ? v / len : fvec3();
+}
+
+// ============================================================================
+// fquat - Unit quaternion rotation
+// ============================================================================
+struct fquat {
+    fixed x, y, z, w;
+
+    fquat() : w(1) {}  // Identity
+    fquat(fixed x, fixed y, fixed z, fixed w) : x(x), y(y), z(z), w(w) {}
+
+    // axis must be unit length
+    static fquat from_axis_angle(const fvec3& axis, fixed angle) {
+        fixed half_angle = angle * fixed::ratio(1, 2);
+        fixed s = sin(half_angle);
+        return fquat(axis.x * s, axis.y * s, axis.z * s, cos(half_angle));
+    }
+    static fquat from_quat(const quat& q) {
+        return fquat(fixed::from_float(q.x), fixed::from_float(q.y), fixed::from_float(q.z), fixed::from_float(q.w));
+    }
+    quat to_quat() const { return quat(x.to_float(), y.to_float(), z.to_float(), w.to_float()); }
+
+    fquat operator*(const fquat& q) const {
+        return fquat(
+            w * q.x + x * q.w + y * q.z - z * q.y,
+            w * q.y - x * q.z + y * q.w + z * q.x,
+            w * q.z + x * q.y - y * q.x + z * q.w,
+            w * q.w - x * q.x - y * q.y - z * q.z
+        );
+    }
+
+    fvec3 operator*(const fvec3& v) const {
+        fvec3 u(x, y, z);
+        fvec3 t = cross(u, v) * fixed(2);
+        return v + t * w + cross(u, t);
+    }
+
+    bool operator==(const fquat& q) const { return x == q.x && y == q.y && z == q.z && w == q.w; }
+
+    fquat conjugate() const { return fquat(-x, -y, -z, w); }
+
+    // Advance by angular velocity (radians/second, world space) over dt.
+    // Renormalizes, so rounding never accumulates into scale.
+    fquat integrate(const fvec3& angular_velocity, fixed dt) const;
+};
+
+inline fquat normalize(const fquat& q) {
+    uint64_t sum = static_cast<uint64_t>(static_cast<int64_t>(q.x.raw) * q.x.raw) +
+                   static_cast<uint64_t>(static_cast<int64_t>(q.y.raw) * q.y.raw) +
+                   static_cast<uint64_t>(static_cast<int64_t>(q.z.raw) * q.z.raw) +
+                   static_cast<uint64_t>(static_cast<int64_t>(q.w.raw) * q.w.raw);
+    fixed len = length_from_squares(sum);
+    if (len.raw == 0) return fquat();
+    return fquat(q.x / len, q.y / len, q.z / len, q.w / len);
+}
+
+inline fquat fquat::integrate(const fvec3& angular_velocity, fixed dt) const {
+    fixed half_dt = dt * fixed::ratio(1, 2);
+    fquat spin = fquat(angular_velocity.x, angular_velocity.y, angular_velocity.z, fixed()) * *this;
+    return normalize(fquat(x + spin.x * half_dt, y + spin.y * half_dt, z + spin.z * half_dt, w + spin.w * half_dt));
+}
+
+// ============================================================================
+// fmat3 - Rotation and scale, column-major like mat4
+// ============================================================================
+struct fmat3 {
+    fvec3 cols[3];
+
+    fmat3() {
+        cols[0] = fvec3(fixed(1), fixed(), fixed());
+        cols[1] = fvec3(fixed(), fixed(1), fixed());
+        cols[2] = fvec3(fixed(), fixed(), fixed(1));
+    }
+    fmat3(const fvec3& c0, const fvec3& c1, const fvec3& c2) {
+        cols[0] = c0;
+        cols[1] = c1;
+        cols[2] = c2;
+    }
+
+    static fmat3 from_quat(const fquat& q) {
+        fixed two(2);
+        fixed xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+        fixed xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+        fixed wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+        return fmat3(
+            fvec3(fixed(1) - two * (yy + zz), two * (xy + wz), two * (xz - wy)),
+            fvec3(two * (xy - wz), fixed(1) - two * (xx + zz), two * (yz + wx)),
+            fvec3(two * (xz + wy), two * (yz - wx), fixed(1) - two * (xx + yy))
+        );
+    }
+
+    fvec3& operator[](int i) { return cols[i]; }
+    const fvec3& operator[](int i) const { return cols[i]; }
+
+    fvec3 operator*(const fvec3& v) const { return cols[0] * v.x + cols[1] * v.y + cols[2] * v.z; }
+    fmat3 operator*(const fmat3& m) const { return fmat3(*this * m.cols[0], *this * m.cols[1], *this * m.cols[2]); }
+
+    fmat3 transpose() const {
+        return fmat3(fvec3(cols[0].x, cols[1].x, cols[2].x),
+                     fvec3(cols[0].y, cols[1].y, cols[2].y),
+                     fvec3(cols[0].z, cols[1].z, cols[2].z));
+    }
+
+    // Affine float matrix for rendering
+    mat4 to_mat4(const fvec3& translation = fvec3()) const {
+        return mat4(vec4(cols[0].to_vec3(), 0.0f), vec4(cols[1].to_vec3(), 0.0f),
+                    vec4(cols[2].to_vec3(), 0.0f), vec4(translation.to_vec3(), 1.0f));
+    }
+};
+
+} // namespace slam
@@ -0,0 +1,181 @@
+/**
+ * Slam Engine - Frame Allocator
+ *
+ * Linear (bump) allocator for data that lives for one frame. Each frame
+ * slot owns a block; begin_frame(slot) releases everything allocated the
+ * last time that slot was used, so data from the other frames in flight
+ * stays valid. Nothing is freed individually.
+ *
+ * A slot that runs out of space falls back to the heap for the rest of the
+ * frame and grows to its peak on the next reset, so after a frame or two of
+ * warm-up a steady workload never touches malloc. FrameVector<T> and the
+ * other STL containers can allocate from it through FrameStlAllocator.
+ *
+ * Not thread-safe: one thread (the one recording frames) owns it.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace slam {
+
+class FrameAllocator {
+public:
+    FrameAllocator() = default;
+    ~FrameAllocator() { destroy(); }
+
+    // Non-copyable
+    FrameAllocator(const FrameAllocator&) = delete;
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+    // slot_count: frames whose allocations may be alive at once
+    void init(uint32_t slot_count, size_t bytes_per_slot) {
+        destroy();
+        slots_.resize(slot_count);
+        for (Slot& slot : slots_) {
+            slot.reserve(bytes_per_slot);
+        }
+        current_ = slots_.empty() ? nullptr : &slots_[0];
+    }
+
+    void destroy() {
+        for (Slot& slot : slots_) {
+            slot.release_overflow();
+        }
+        slots_.clear();
+        current_ = nullptr;
+    }
+
+    // Make slot current and release its previous frame's allocations
+    void begin_frame(uint32_t slot) {
+        if (slot >= slots_.size()) return;
+        current_ = &slots_[slot];
+        current_->reset();
+    }
+
+    // Uninitialized memory valid until the current slot is begun again.
+    // alignment must be a power of two. Call init() first.
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        return current_->allocate(size, alignment);
+    }
+
+    template <typename T>
+    T* allocate_array(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Bytes handed out from the current slot this frame (including overflow)
+    size_t used() const { return current_ ? current_->used : 0; }
+    // Largest frame seen by any slot
+    size_t peak() const {
+        size_t peak = 0;
+        for (const Slot& slot : slots_) {
+            peak = std::max(peak, slot.peak);
+        }
+        return peak;
+    }
+    size_t capacity() const { return current_ ? current_->capacity : 0; }
+    // Allocations that missed the block and went to the heap
+    uint64_t overflow_count() const {
+        uint64_t count = 0;
+        for (const Slot& slot : slots_) {
+            count += slot.overflow_count;
+        }
+        return count;
+    }
+
+private:
+    struct Slot {
+        std::unique_ptr<std::max_align_t[]> block;
+        size_t capacity = 0;
+        size_t offset = 0;
+        size_t used = 0;
+        size_t peak = 0;
+        std::vector<void*> overflow;
+        uint64_t overflow_count = 0;
+
+        void reserve(size_t bytes) {
+            size_t words = (bytes + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+            block.reset(new std::max_align_t[words]);
+            capacity = words * sizeof(std::max_align_t);
+            offset = 0;
+        }
+
+        void reset() {
+            if (!overflow.empty()) {
+                // Grow so the same frame fits next time
+                release_overflow();
+                reserve(std::max(capacity * 2, peak));
+            }
+            offset = 0;
+            used = 0;
+        }
+
+        void release_overflow() {
+            for (void* memory : overflow) {
+                ::operator delete(memory);
+            }
+            overflow.clear();
+        }
+
+        void* allocate(size_t size, size_t alignment) {
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.get());
+            uintptr_t aligned = (base + offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+            size_t end = static_cast<size_t>(aligned - base) + size;
+
+            used += size;
+            peak = std::max(peak, used);
+            if (end <= capacity) {
+                offset = end;
+                return reinterpret_cast<void*>(aligned);
+            }
+
+            // Out of space: heap until the next reset grows the block
+            void* memory = ::operator new(size + alignment);
+            overflow.push_back(memory);
+            overflow_count++;
+            uintptr_t address = reinterpret_cast<uintptr_t>(memory);
+            return reinterpret_cast<void*>((address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+        }
+    };
+
+    std::vector<Slot> slots_;
+    Slot* current_ = nullptr;
+};
+
+// STL allocator over a FrameAllocator: deallocate is a no-op, memory goes
+// back when the frame slot is reset. Containers must not outlive the frame.
+template <typename T>
+class FrameStlAllocator {
+public:
+    using value_type = T;
+
+    explicit FrameStlAllocator(FrameAllocator& frame) : frame_(&frame) {}
+
+    template <typename U>
+    FrameStlAllocator(const FrameStlAllocator<U>& other) : frame_(other.frame()) {}
+
+    T* allocate(size_t count) { return frame_->allocate_array<T>(count); }
+    void deallocate(T*, size_t) {}
+
+    FrameAllocator* frame() const { return frame_; }
+
+    template <typename U>
+    bool operator==(const FrameStlAllocator<U>& other) const { return frame_ == other.frame(); }
+    template <typename U>
+    bool operator!=(const FrameStlAllocator<U>& other) const { return frame_ != other.frame(); }
+
+private:
+    FrameAllocator* frame_;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameStlAllocator<T>>;
+
+} // namespace slam
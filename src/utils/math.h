@@ -1,8 +1,14 @@
 /**
  * Slam Engine - Math Utilities
  *
- * Custom math types: vec2, vec3, vec4, mat4, quat
+ * Custom math types: vec2, vec3, vec4, mat4, mat3x4, quat, Transform
  * Header-only implementation for simplicity
+ *
+ * vec4 and mat4 are 16-byte aligned and their arithmetic, matrix products
+ * and inverse run on 4-wide SIMD: SSE on x86 (FMA and 8-wide products when
+ * built with -mavx2 -mfma), NEON on ARM. Define SLAM_MATH_SCALAR to build
+ * the portable scalar version of the same code instead. With AVX2,
+ * mat4 * vec4 is left as plain expressions for the compiler to widen.
  */
 
 #pragma once
@@ -10,6 +16,16 @@
 #include <cmath>
 #include <algorithm>
 
+#if !defined(SLAM_MATH_SCALAR)
+#if defined(__SSE2__) || defined(_M_X64)
+#define SLAM_MATH_SSE 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#define SLAM_MATH_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
 namespace slam {
 
 // Constants
@@ -20,12 +36,119 @@ constexpr float DEG_TO_RAD = PI / 180.0f;
 constexpr float RAD_TO_DEG = 180.0f / PI;
 constexpr float EPSILON = 1e-6f;
 
+// ============================================================================
+// SIMD backend - 4-wide float operations used by vec4 and mat4
+// ============================================================================
+namespace simd {
+
+#if defined(SLAM_MATH_SSE)
+#if defined(__AVX2__) && defined(__FMA__)
+constexpr const char* BACKEND = "avx2";
+#else
+constexpr const char* BACKEND = "sse";
+#endif
+
+using float4 = __m128;
+
+inline float4 load(const float* p) { return _mm_load_ps(p); }
+inline void store(float* p, float4 v) { _mm_store_ps(p, v); }
+inline float4 set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+inline float4 splat(float s) { return _mm_set1_ps(s); }
+inline float4 add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+inline float4 sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+inline float4 mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+inline float4 div(float4 a, float4 b) { return _mm_div_ps(a, b); }
+inline float4 neg(float4 a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+
+// a * b + c
+inline float4 madd(float4 a, float4 b, float4 c) {
+#if defined(__FMA__)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+// (a[i0], a[i1], b[i2], b[i3])
+template <int i0, int i1, int i2, int i3>
+inline float4 shuffle(float4 a, float4 b) {
+    return _mm_shuffle_ps(a, b, _MM_SHUFFLE(i3, i2, i1, i0));
+}
+
+// Lane i in every lane
+template <int i>
+inline float4 lane(float4 v) { return shuffle<i, i, i, i>(v, v); }
+
+#elif defined(SLAM_MATH_NEON)
+constexpr const char* BACKEND = "neon";
+
+using float4 = float32x4_t;
+
+inline float4 load(const float* p) { return vld1q_f32(p); }
+inline void store(float* p, float4 v) { vst1q_f32(p, v); }
+inline float4 set(float x, float y, float z, float w) {
+    alignas(16) float values[4] = {x, y, z, w};
+    return vld1q_f32(values);
+}
+inline float4 splat(float s) { return vdupq_n_f32(s); }
+inline float4 add(float4 a, float4 b) { return vaddq_f32(a, b); }
+inline float4 sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+inline float4 mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+inline float4 div(float4 a, float4 b) { return vdivq_f32(a, b); }
+inline float4 neg(float4 a) { return vnegq_f32(a); }
+inline float4 madd(float4 a, float4 b, float4 c) { return vfmaq_f32(c, a, b); }
+
+template <int i0, int i1, int i2, int i3>
+inline float4 shuffle(float4 a, float4 b) {
+    return __builtin_shufflevector(a, b, i0, i1, i2 + 4, i3 + 4);
+}
+
+template <int i>
+inline float4 lane(float4 v) { return vdupq_laneq_f32(v, i); }
+
+#else
+constexpr const char* BACKEND = "scalar";
+
+struct float4 {
+    float v[4];
+};
+
+inline float4 load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void store(float* p, float4 a) { p[0] = a.v[0]; p[1] = a.v[1]; p[2] = a.v[2]; p[3] = a.v[3]; }
+inline float4 set(float x, float y, float z, float w) { return {{x, y, z, w}}; }
+inline float4 splat(float s) { return {{s, s, s, s}}; }
+inline float4 add(float4 a, float4 b) {
+    return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+}
+inline float4 sub(float4 a, float4 b) {
+    return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+}
+inline float4 mul(float4 a, float4 b) {
+    return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+}
+inline float4 div(float4 a, float4 b) {
+    return {{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]}};
+}
+inline float4 neg(float4 a) { return {{-a.v[0], -a.v[1], -a.v[2], -a.v[3]}}; }
+inline float4 madd(float4 a, float4 b, float4 c) { return add(mul(a, b), c); }
+
+template <int i0, int i1, int i2, int i3>
+inline float4 shuffle(float4 a, float4 b) { return {{a.v[i0], a.v[i1], b.v[i2], b.v[i3]}}; }
+
+template <int i>
+inline float4 lane(float4 v) { return splat(v.v[i]); }
+#endif
+
+} // namespace simd
+
 // Forward declarations
 struct vec2;
 struct vec3;
 struct vec4;
 struct mat4;
+struct mat3x4;
 struct quat;
+struct Transform;
 
 // ============================================================================
 // vec2
@@ -111,7 +234,7 @@ inline vec3 reflect(const vec3& v, const vec3& n) { return v - 2.0f * dot(v, n)
 // ============================================================================
 // vec4
 // ============================================================================
-struct vec4 {
+struct alignas(16) vec4 {
     float x, y, z, w;
 
     vec4() : x(0), y(0), z(0), w(0) {}
@@ -120,20 +243,25 @@ struct vec4 {
     vec4(const vec3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
     vec4(const vec2& v, float z, float w) : x(v.x), y(v.y), z(z), w(w) {}
 
+    explicit vec4(simd::float4 v) { simd::store(&x, v); }
+
+    static vec4 from_simd(simd::float4 v) { return vec4(v); }
+    simd::float4 to_simd() const { return simd::load(&x); }
+
     float& operator[](int i) { return (&x)[i]; }
     const float& operator[](int i) const { return (&x)[i]; }
 
-    vec4 operator+(const vec4& v) const { return vec4(x + v.x, y + v.y, z + v.z, w + v.w); }
-    vec4 operator-(const vec4& v) const { return vec4(x - v.x, y - v.y, z - v.z, w - v.w); }
-    vec4 operator*(const vec4& v) const { return vec4(x * v.x, y * v.y, z * v.z, w * v.w); }
-    vec4 operator*(float s) const { return vec4(x * s, y * s, z * s, w * s); }
-    vec4 operator/(float s) const { return vec4(x / s, y / s, z / s, w / s); }
+    vec4 operator+(const vec4& v) const { return from_simd(simd::add(to_simd(), v.to_simd())); }
+    vec4 operator-(const vec4& v) const { return from_simd(simd::sub(to_simd(), v.to_simd())); }
+    vec4 operator*(const vec4& v) const { return from_simd(simd::mul(to_simd(), v.to_simd())); }
+    vec4 operator*(float s) const { return from_simd(simd::mul(to_simd(), simd::splat(s))); }
+    vec4 operator/(float s) const { return from_simd(simd::div(to_simd(), simd::splat(s))); }
 
-    vec4& operator+=(const vec4& v) { x += v.x; y += v.y; z += v.z; w += v.w; return *this; }
-    vec4& operator-=(const vec4& v) { x -= v.x; y -= v.y; z -= v.z; w -= v.w; return *this; }
-    vec4& operator*=(float s) { x *= s; y *= s; z *= s; w *= s; return *this; }
+    vec4& operator+=(const vec4& v) { return *this = *this + v; }
+    vec4& operator-=(const vec4& v) { return *this = *this - v; }
+    vec4& operator*=(float s) { return *this = *this * s; }
 
-    vec4 operator-() const { return vec4(-x, -y, -z, -w); }
+    vec4 operator-() const { return from_simd(simd::neg(to_simd())); }
 
     float length() const { return std::sqrt(x * x + y * y + z * z + w * w); }
     float length_squared() const { return x * x + y * y + z * z + w * w; }
@@ -186,77 +314,126 @@ struct mat4 {
 
     mat4 operator*(const mat4& m) const {
         mat4 result;
+#if defined(SLAM_MATH_SSE) && defined(__AVX2__) && defined(__FMA__)
+        // Two result columns per 8-wide register: each half holds one column
+        // of m, permuted to broadcast its element k against column k of this
+        for (int col = 0; col < 4; col += 2) {
+            __m256 pair = _mm256_loadu_ps(&m.cols[col].x);
+            __m256 sum = _mm256_mul_ps(_mm256_broadcast_ps(reinterpret_cast<const __m128*>(&cols[0])),
+                                       _mm256_permute_ps(pair, 0x00));
+            sum = _mm256_fmadd_ps(_mm256_broadcast_ps(reinterpret_cast<const __m128*>(&cols[1])),
+                                  _mm256_permute_ps(pair, 0x55), sum);
+            sum = _mm256_fmadd_ps(_mm256_broadcast_ps(reinterpret_cast<const __m128*>(&cols[2])),
+                                  _mm256_permute_ps(pair, 0xAA), sum);
+            sum = _mm256_fmadd_ps(_mm256_broadcast_ps(reinterpret_cast<const __m128*>(&cols[3])),
+                                  _mm256_permute_ps(pair, 0xFF), sum);
+            _mm256_storeu_ps(&result.cols[col].x, sum);
+        }
+#else
         for (int col = 0; col < 4; ++col) {
-            for (int row = 0; row < 4; ++row) {
-                result.at(row, col) =
-                    at(row, 0) * m.at(0, col) +
-                    at(row, 1) * m.at(1, col) +
-                    at(row, 2) * m.at(2, col) +
-                    at(row, 3) * m.at(3, col);
-            }
+            result.cols[col] = vec4::from_simd(transform(m.cols[col].to_simd()));
         }
+#endif
         return result;
     }
 
     vec4 operator*(const vec4& v) const {
-        return vec4(
-            cols[0].x * v.x + cols[1].x * v.y + cols[2].x * v.z + cols[3].x * v.w,
-            cols[0].y * v.x + cols[1].y * v.y + cols[2].y * v.z + cols[3].y * v.w,
-            cols[0].z * v.x + cols[1].z * v.y + cols[2].z * v.z + cols[3].z * v.w,
-            cols[0].w * v.x + cols[1].w * v.y + cols[2].w * v.z + cols[3].w * v.w
-        );
+#if defined(SLAM_MATH_SSE) && defined(__AVX2__)
+        // Plain expressions: in a loop over many vectors the compiler
+        // transposes them into 8- or 16-wide products, which beats one
+        // 4-wide product per vector
+        return vec4(cols[0].x * v.x + cols[1].x * v.y + cols[2].x * v.z + cols[3].x * v.w,
+                    cols[0].y * v.x + cols[1].y * v.y + cols[2].y * v.z + cols[3].y * v.w,
+                    cols[0].z * v.x + cols[1].z * v.y + cols[2].z * v.z + cols[3].z * v.w,
+                    cols[0].w * v.x + cols[1].w * v.y + cols[2].w * v.z + cols[3].w * v.w);
+#else
+        return vec4::from_simd(transform(v.to_simd()));
+#endif
+    }
+
+    // Column multiply-add: c0 * v.x + c1 * v.y + c2 * v.z + c3 * v.w
+    simd::float4 transform(simd::float4 v) const {
+        simd::float4 sum = simd::mul(cols[0].to_simd(), simd::lane<0>(v));
+        sum = simd::madd(cols[1].to_simd(), simd::lane<1>(v), sum);
+        sum = simd::madd(cols[2].to_simd(), simd::lane<2>(v), sum);
+        return simd::madd(cols[3].to_simd(), simd::lane<3>(v), sum);
     }
 
     static mat4 identity() { return mat4(1.0f); }
 
+    // Identity if singular
     mat4 inverse() const {
-        // Compute matrix inverse using cofactors
-        const float* m = data();
-        float inv[16];
-
-        inv[0] = m[5]  * m[10] * m[15] - m[5]  * m[11] * m[14] - m[9]  * m[6]  * m[15] +
-                 m[9]  * m[7]  * m[14] + m[13] * m[6]  * m[11] - m[13] * m[7]  * m[10];
-        inv[4] = -m[4] * m[10] * m[15] + m[4]  * m[11] * m[14] + m[8]  * m[6]  * m[15] -
-                 m[8]  * m[7]  * m[14] - m[12] * m[6]  * m[11] + m[12] * m[7]  * m[10];
-        inv[8] = m[4]  * m[9]  * m[15] - m[4]  * m[11] * m[13] - m[8]  * m[5]  * m[15] +
-                 m[8]  * m[7]  * m[13] + m[12] * m[5]  * m[11] - m[12] * m[7]  * m[9];
-        inv[12] = -m[4] * m[9] * m[14] + m[4]  * m[10] * m[13] + m[8]  * m[5]  * m[14] -
-                  m[8]  * m[6] * m[13] - m[12] * m[5]  * m[10] + m[12] * m[6]  * m[9];
-        inv[1] = -m[1] * m[10] * m[15] + m[1]  * m[11] * m[14] + m[9]  * m[2]  * m[15] -
-                 m[9]  * m[3]  * m[14] - m[13] * m[2]  * m[11] + m[13] * m[3]  * m[10];
-        inv[5] = m[0]  * m[10] * m[15] - m[0]  * m[11] * m[14] - m[8]  * m[2]  * m[15] +
-                 m[8]  * m[3]  * m[14] + m[12] * m[2]  * m[11] - m[12] * m[3]  * m[10];
-        inv[9] = -m[0] * m[9]  * m[15] + m[0]  * m[11] * m[13] + m[8]  * m[1]  * m[15] -
-                 m[8]  * m[3]  * m[13] - m[12] * m[1]  * m[11] + m[12] * m[3]  * m[9];
-        inv[13] = m[0] * m[9]  * m[14] - m[0]  * m[10] * m[13] - m[8]  * m[1]  * m[14] +
-                  m[8] * m[2]  * m[13] + m[12] * m[1]  * m[10] - m[12] * m[2]  * m[9];
-        inv[2] = m[1]  * m[6]  * m[15] - m[1]  * m[7]  * m[14] - m[5]  * m[2]  * m[15] +
-                 m[5]  * m[3]  * m[14] + m[13] * m[2]  * m[7]  - m[13] * m[3]  * m[6];
-        inv[6] = -m[0] * m[6]  * m[15] + m[0]  * m[7]  * m[14] + m[4]  * m[2]  * m[15] -
-                 m[4]  * m[3]  * m[14] - m[12] * m[2]  * m[7]  + m[12] * m[3]  * m[6];
-        inv[10] = m[0] * m[5]  * m[15] - m[0]  * m[7]  * m[13] - m[4]  * m[1]  * m[15] +
-                  m[4] * m[3]  * m[13] + m[12] * m[1]  * m[7]  - m[12] * m[3]  * m[5];
-        inv[14] = -m[0] * m[5] * m[14] + m[0]  * m[6]  * m[13] + m[4]  * m[1]  * m[14] -
-                  m[4]  * m[2] * m[13] - m[12] * m[1]  * m[6]  + m[12] * m[2]  * m[5];
-        inv[3] = -m[1] * m[6]  * m[11] + m[1]  * m[7]  * m[10] + m[5]  * m[2]  * m[11] -
-                 m[5]  * m[3]  * m[10] - m[9]  * m[2]  * m[7]  + m[9]  * m[3]  * m[6];
-        inv[7] = m[0]  * m[6]  * m[11] - m[0]  * m[7]  * m[10] - m[4]  * m[2]  * m[11] +
-                 m[4]  * m[3]  * m[10] + m[8]  * m[2]  * m[7]  - m[8]  * m[3]  * m[6];
-        inv[11] = -m[0] * m[5] * m[11] + m[0]  * m[7]  * m[9]  + m[4]  * m[1]  * m[11] -
-                  m[4]  * m[3] * m[9]  - m[8]  * m[1]  * m[7]  + m[8]  * m[3]  * m[5];
-        inv[15] = m[0] * m[5]  * m[10] - m[0]  * m[6]  * m[9]  - m[4]  * m[1]  * m[10] +
-                  m[4] * m[2]  * m[9]  + m[8]  * m[1]  * m[6]  - m[8]  * m[2]  * m[5];
-
-        float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
-        if (det == 0) return mat4(1.0f); // Return identity if singular
-
-        float inv_det = 1.0f / det;
         mat4 result;
-        float* r = result.data();
-        for (int i = 0; i < 16; i++) {
-            r[i] = inv[i] * inv_det;
-        }
-        return result;
+        float det = cofactor_inverse(result);
+        return det == 0.0f ? mat4(1.0f) : result;
+    }
+
+    // Inverse through 2x2 cofactors, four at a time. Returns the determinant;
+    // out is only valid when it is non-zero.
+    float cofactor_inverse(mat4& out) const {
+        using namespace simd;
+        float4 c0 = cols[0].to_simd();
+        float4 c1 = cols[1].to_simd();
+        float4 c2 = cols[2].to_simd();
+        float4 c3 = cols[3].to_simd();
+
+        // 2x2 determinants of rows (a, b) across column pairs (2,3), (1,3), (1,2)
+        float4 fac0 = cofactors<2, 3>(c1, c2, c3);
+        float4 fac1 = cofactors<1, 3>(c1, c2, c3);
+        float4 fac2 = cofactors<1, 2>(c1, c2, c3);
+        float4 fac3 = cofactors<0, 3>(c1, c2, c3);
+        float4 fac4 = cofactors<0, 2>(c1, c2, c3);
+        float4 fac5 = cofactors<0, 1>(c1, c2, c3);
+
+        // Row r of columns 1, 0, 0, 0
+        float4 v0 = spread<0>(c0, c1);
+        float4 v1 = spread<1>(c0, c1);
+        float4 v2 = spread<2>(c0, c1);
+        float4 v3 = spread<3>(c0, c1);
+
+        float4 sign_a = set(+1.0f, -1.0f, +1.0f, -1.0f);
+        float4 sign_b = set(-1.0f, +1.0f, -1.0f, +1.0f);
+        float4 inv0 = mul(madd(v3, fac2, sub(mul(v1, fac0), mul(v2, fac1))), sign_a);
+        float4 inv1 = mul(madd(v3, fac4, sub(mul(v0, fac0), mul(v2, fac3))), sign_b);
+        float4 inv2 = mul(madd(v3, fac5, sub(mul(v0, fac1), mul(v1, fac3))), sign_a);
+        float4 inv3 = mul(madd(v2, fac5, sub(mul(v0, fac2), mul(v1, fac4))), sign_b);
+
+        // Determinant: first column against the first row of the adjugate
+        float4 row0 = shuffle<0, 2, 0, 2>(shuffle<0, 0, 0, 0>(inv0, inv1),
+                                          shuffle<0, 0, 0, 0>(inv2, inv3));
+        alignas(16) float products[4];
+        store(products, mul(c0, row0));
+        float det = (products[0] + products[1]) + (products[2] + products[3]);
+        if (det == 0.0f) return 0.0f;
+
+        float4 inv_det = splat(1.0f / det);
+        out.cols[0] = vec4::from_simd(mul(inv0, inv_det));
+        out.cols[1] = vec4::from_simd(mul(inv1, inv_det));
+        out.cols[2] = vec4::from_simd(mul(inv2, inv_det));
+        out.cols[3] = vec4::from_simd(mul(inv3, inv_det));
+        return det;
+    }
+
+private:
+    // (c2[a]*c3[b] - c3[a]*c2[b]) twice, then the same for columns (1,3), (1,2)
+    template <int a, int b>
+    static simd::float4 cofactors(simd::float4 c1, simd::float4 c2, simd::float4 c3) {
+        using namespace simd;
+        float4 col_a = shuffle<a, a, a, a>(c2, c1);                  // c2a c2a c1a c1a
+        float4 col_b = shuffle<b, b, b, b>(c2, c1);                  // c2b c2b c1b c1b
+        float4 other_b = shuffle<b, b, b, b>(c3, c2);                // c3b c3b c2b c2b
+        other_b = shuffle<0, 0, 0, 2>(other_b, other_b);             // c3b c3b c3b c2b
+        float4 other_a = shuffle<a, a, a, a>(c3, c2);
+        other_a = shuffle<0, 0, 0, 2>(other_a, other_a);             // c3a c3a c3a c2a
+        return sub(mul(col_a, other_b), mul(other_a, col_b));
+    }
+
+    // (c1[r], c0[r], c0[r], c0[r])
+    template <int r>
+    static simd::float4 spread(simd::float4 c0, simd::float4 c1) {
+        using namespace simd;
+        float4 pair = shuffle<r, r, r, r>(c1, c0);  // c1r c1r c0r c0r
+        return shuffle<0, 2, 2, 2>(pair, pair);
     }
 };
 
@@ -374,62 +551,14 @@ inline mat4 look_at(const vec3& eye, const vec3& center, const vec3& up) {
     return result;
 }
 
-// Inverse of a 4x4 matrix (using cofactors)
+// Inverse of a 4x4 matrix (using cofactors); identity if near-singular
 inline mat4 inverse(const mat4& m) {
-    float coef00 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
-    float coef02 = m[1][2] * m[3][3] - m[3][2] * m[1][3];
-    float coef03 = m[1][2] * m[2][3] - m[2][2] * m[1][3];
-    float coef04 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
-    float coef06 = m[1][1] * m[3][3] - m[3][1] * m[1][3];
-    float coef07 = m[1][1] * m[2][3] - m[2][1] * m[1][3];
-    float coef08 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
-    float coef10 = m[1][1] * m[3][2] - m[3][1] * m[1][2];
-    float coef11 = m[1][1] * m[2][2] - m[2][1] * m[1][2];
-    float coef12 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
-    float coef14 = m[1][0] * m[3][3] - m[3][0] * m[1][3];
-    float coef15 = m[1][0] * m[2][3] - m[2][0] * m[1][3];
-    float coef16 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
-    float coef18 = m[1][0] * m[3][2] - m[3][0] * m[1][2];
-    float coef19 = m[1][0] * m[2][2] - m[2][0] * m[1][2];
-    float coef20 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
-    float coef22 = m[1][0] * m[3][1] - m[3][0] * m[1][1];
-    float coef23 = m[1][0] * m[2][1] - m[2][0] * m[1][1];
-
-    vec4 fac0(coef00, coef00, coef02, coef03);
-    vec4 fac1(coef04, coef04, coef06, coef07);
-    vec4 fac2(coef08, coef08, coef10, coef11);
-    vec4 fac3(coef12, coef12, coef14, coef15);
-    vec4 fac4(coef16, coef16, coef18, coef19);
-    vec4 fac5(coef20, coef20, coef22, coef23);
-
-    vec4 v0(m[1][0], m[0][0], m[0][0], m[0][0]);
-    vec4 v1(m[1][1], m[0][1], m[0][1], m[0][1]);
-    vec4 v2(m[1][2], m[0][2], m[0][2], m[0][2]);
-    vec4 v3(m[1][3], m[0][3], m[0][3], m[0][3]);
-
-    vec4 inv0 = v1 * fac0 - v2 * fac1 + v3 * fac2;
-    vec4 inv1 = v0 * fac0 - v2 * fac3 + v3 * fac4;
-    vec4 inv2 = v0 * fac1 - v1 * fac3 + v3 * fac5;
-    vec4 inv3 = v0 * fac2 - v1 * fac4 + v2 * fac5;
-
-    vec4 sign_a(+1, -1, +1, -1);
-    vec4 sign_b(-1, +1, -1, +1);
-
-    mat4 inv(inv0 * sign_a, inv1 * sign_b, inv2 * sign_a, inv3 * sign_b);
-
-    vec4 row0(inv[0][0], inv[1][0], inv[2][0], inv[3][0]);
-    float det = dot(m[0], row0);
-
+    mat4 result;
+    float det = m.cofactor_inverse(result);
     if (std::abs(det) < EPSILON) {
         return mat4(); // Return identity if singular
     }
-
-    return mat4(
-        inv[0] / det,
-        inv[1] / det,
-        inv[2] / det,
-        inv[3] / det
-    );
+    return result;
 }
 
 // ============================================================================
@@ -561,6 +690,76 @@ inline quat slerp(const quat& a, const quat& b, float t) {
     );
 }
 
+// ============================================================================
+// mat3x4 - Affine matrix as its top three rows (per-instance GPU layout)
+// ============================================================================
+struct mat3x4 {
+    vec4 rows[3];  // rows[i] = (m[0][i], m[1][i], m[2][i], translation[i])
+
+    mat3x4() {
+        rows[0] = vec4(1, 0, 0, 0);
+        rows[1] = vec4(0, 1, 0, 0);
+        rows[2] = vec4(0, 0, 1, 0);
+    }
+
+    // Drops the bottom row, which is (0, 0, 0, 1) for affine m
+    explicit mat3x4(const mat4& m) {
+        for (int i = 0; i < 3; i++) {
+            rows[i] = vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+        }
+    }
+
+    mat4 to_mat4() const {
+        return mat4(vec4(rows[0].x, rows[1].x, rows[2].x, 0.0f),
+                    vec4(rows[0].y, rows[1].y, rows[2].y, 0.0f),
+                    vec4(rows[0].z, rows[1].z, rows[2].z, 0.0f),
+                    vec4(rows[0].w, rows[1].w, rows[2].w, 1.0f));
+    }
+};
+
+// ============================================================================
+// Transform - Translation, rotation and scale
+// ============================================================================
+// Scales, then rotates, then translates. Composition and inverse are exact
+// for uniform scale; non-uniform scale under a rotated parent would need
+// shear, which a TRS cannot hold. Convert to a matrix only for upload.
+struct Transform {
+    vec3 translation;
+    quat rotation;  // Unit length
+    vec3 scale;
+
+    Transform() : translation(0), rotation(), scale(1) {}
+    Transform(const vec3& translation, const quat& rotation = quat(), const vec3& scale = vec3(1))
+        : translation(translation), rotation(rotation), scale(scale) {}
+    Transform(const vec3& translation, const quat& rotation, float uniform_scale)
+        : translation(translation), rotation(rotation), scale(uniform_scale) {}
+
+    vec3 transform_point(const vec3& p) const { return translation + rotation * (p * scale); }
+    vec3 transform_vector(const vec3& v) const { return rotation * (v * scale); }
+
+    // Child's local space into this transform's parent space
+    Transform operator*(const Transform& child) const {
+        return Transform(transform_point(child.translation), rotation * child.rotation, scale * child.scale);
+    }
+
+    Transform inverse() const {
+        vec3 inv_scale(1.0f / scale.x, 1.0f / scale.y, 1.0f / scale.z);
+        quat inv_rotation = rotation.conjugate();
+        return Transform((inv_rotation * -translation) * inv_scale, inv_rotation, inv_scale);
+    }
+
+    mat4 to_mat4() const {
+        mat4 result = rotation.to_mat4();
+        result[0] *= scale.x;
+        result[1] *= scale.y;
+        result[2] *= scale.z;
+        result[3] = vec4(translation, 1.0f);
+        return result;
+    }
+
+    mat3x4 to_mat3x4() const { return mat3x4(to_mat4()); }
+};
+
 // ============================================================================
 // Utility functions
 // ============================================================================
@@ -0,0 +1,64 @@
+/**
+ * Slam Engine - Triple Buffer
+ *
+ * Lock-free single-producer, single-consumer handoff of the latest value.
+ * The producer fills write_buffer() and publishes it; the consumer picks up
+ * the newest publication, skipping any it missed. With three slots the
+ * producer always has one to write while the consumer holds another, so
+ * neither side ever waits on the other.
+ *
+ * Slots are reused: after publish() the producer gets back an older slot
+ * with stale contents, so it must overwrite every field it relies on.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace slam {
+
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    // Non-copyable
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Producer: slot to fill for the next publish()
+    T& write_buffer() { return slots_[write_]; }
+
+    // Producer: make write_buffer() the latest value and take a free slot
+    void publish() {
+        uint8_t previous = middle_.exchange(static_cast<uint8_t>(write_ | FRESH_BIT),
+                                            std::memory_order_acq_rel);
+        write_ = previous & INDEX_MASK;
+    }
+
+    // Consumer: take the latest publication if there has been one since the
+    // last call. Returns false (read_buffer() unchanged) otherwise.
+    bool acquire() {
+        if (!(middle_.load(std::memory_order_relaxed) & FRESH_BIT)) {
+            return false;
+        }
+        uint8_t previous = middle_.exchange(read_, std::memory_order_acq_rel);
+        read_ = previous & INDEX_MASK;
+        return true;
+    }
+
+    // Consumer: most recently acquired value
+    const T& read_buffer() const { return slots_[read_]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH_BIT = 0x4;  // Middle slot not yet acquired
+
+    T slots_[3];
+    uint8_t write_ = 0;               // Producer only
+    uint8_t read_ = 1;                // Consumer only
+    std::atomic<uint8_t> middle_{2};  // Slot index | FRESH_BIT
+};
+
+} // namespace slam
@@ -0,0 +1,354 @@
+/**
+ * Slam Engine - Block Compression Implementation
+ */
+
+#include "block_compress.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace slam {
+
+// VkFormat values (the baker does not depend on the Vulkan headers)
+constexpr uint32_t VK_FORMAT_BC1_RGB_SRGB_BLOCK = 132;
+constexpr uint32_t VK_FORMAT_BC4_UNORM_BLOCK = 139;
+constexpr uint32_t VK_FORMAT_BC5_UNORM_BLOCK = 141;
+
+// Khronos Data Format color models
+constexpr uint8_t KHR_DF_MODEL_BC1A = 128;
+constexpr uint8_t KHR_DF_MODEL_BC4 = 131;
+constexpr uint8_t KHR_DF_MODEL_BC5 = 132;
+
+// ============================================================================
+// Block encoders
+// ============================================================================
+
+static uint16_t to_565(int r, int g, int b) {
+    return static_cast<uint16_t>(((r * 31 + 127) / 255) << 11 |
+                                 ((g * 63 + 127) / 255) << 5 |
+                                 ((b * 31 + 127) / 255));
+}
+
+static void from_565(uint16_t c, int& r, int& g, int& b) {
+    r = ((c >> 11) & 31) * 255 / 31;
+    g = ((c >> 5) & 63) * 255 / 63;
+    b = (c & 31) * 255 / 31;
+}
+
+void encode_bc1(const Pixel* pixels, uint8_t* block) {
+    int lo[3] = {255, 255, 255};
+    int hi[3] = {0, 0, 0};
+    for (int i = 0; i < 16; i++) {
+        const int c[3] = {pixels[i].r, pixels[i].g, pixels[i].b};
+        for (int k = 0; k < 3; k++) {
+            lo[k] = std::min(lo[k], c[k]);
+            hi[k] = std::max(hi[k], c[k]);
+        }
+    }
+
+    // Inset the box by 1/16 so the interpolated colors land on the data
+    for (int k = 0; k < 3; k++) {
+        int inset = (hi[k] - lo[k]) / 16;
+        lo[k] += inset;
+        hi[k] -= inset;
+    }
+
+    uint16_t color0 = to_565(hi[0], hi[1], hi[2]);
+    uint16_t color1 = to_565(lo[0], lo[1], lo[2]);
+
+    // color0 > color1 selects the 4-color mode
+    if (color0 < color1) std::swap(color0, color1);
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        int palette[4][3];
+        from_565(color0, palette[0][0], palette[0][1], palette[0][2]);
+        from_565(color1, palette[1][0], palette[1][1], palette[1][2]);
+        for (int k = 0; k < 3; k++) {
+            palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+            palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+        }
+
+        for (int i = 0; i < 16; i++) {
+            const int c[3] = {pixels[i].r, pixels[i].g, pixels[i].b};
+            int best = 0;
+            int best_error = INT32_MAX;
+            for (int p = 0; p < 4; p++) {
+                int dr = c[0] - palette[p][0];
+                int dg = c[1] - palette[p][1];
+                int db = c[2] - palette[p][2];
+                int error = dr * dr + dg * dg + db * db;
+                if (error < best_error) {
+                    best_error = error;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (i * 2);
+        }
+    }
+
+    memcpy(block + 0, &color0, 2);
+    memcpy(block + 2, &color1, 2);
+    memcpy(block + 4, &indices, 4);
+}
+
+void encode_bc4(const uint8_t* values, uint8_t* block) {
+    int lo = 255;
+    int hi = 0;
+    for (int i = 0; i < 16; i++) {
+        lo = std::min(lo, static_cast<int>(values[i]));
+        hi = std::max(hi, static_cast<int>(values[i]));
+    }
+
+    // red0 > red1 selects the 8-value mode
+    block[0] = static_cast<uint8_t>(hi);
+    block[1] = static_cast<uint8_t>(lo);
+
+    uint64_t indices = 0;
+    if (hi != lo) {
+        int palette[8];
+        palette[0] = hi;
+        palette[1] = lo;
+        for (int p = 1; p < 7; p++) {
+            palette[p + 1] = ((7 - p) * hi + p * lo) / 7;
+        }
+
+        for (int i = 0; i < 16; i++) {
+            int best = 0;
+            int best_error = INT32_MAX;
+            for (int p = 0; p < 8; p++) {
+                int error = std::abs(values[i] - palette[p]);
+                if (error < best_error) {
+                    best_error = error;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint64_t>(best) << (i * 3);
+        }
+    }
+
+    for (int b = 0; b < 6; b++) {
+        block[2 + b] = static_cast<uint8_t>(indices >> (b * 8));
+    }
+}
+
+// ============================================================================
+// Mip chain
+// ============================================================================
+
+static float srgb_to_linear(float c) {
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static float linear_to_srgb(float c) {
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+// Half-size box filter, filtered according to what the map stores
+static Image downsample(const Image& src, BlockFormat format) {
+    int width = std::max(src.width() / 2, 1);
+    int height = std::max(src.height() / 2, 1);
+    Image dst(width, height);
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            float sum[4] = {0, 0, 0, 0};
+            for (int dy = 0; dy < 2; dy++) {
+                for (int dx = 0; dx < 2; dx++) {
+                    const Pixel& p = src.at(std::min(x * 2 + dx, src.width() - 1),
+                                            std::min(y * 2 + dy, src.height() - 1));
+                    float c[4] = {p.r / 255.0f, p.g / 255.0f, p.b / 255.0f, p.a / 255.0f};
+                    if (format == BlockFormat::BC1_SRGB) {
+                        for (int k = 0; k < 3; k++) c[k] = srgb_to_linear(c[k]);
+                    } else if (format == BlockFormat::BC5) {
+                        for (int k = 0; k < 3; k++) c[k] = c[k] * 2.0f - 1.0f;
+                    }
+                    for (int k = 0; k < 4; k++) sum[k] += c[k] * 0.25f;
+                }
+            }
+
+            if (format == BlockFormat::BC1_SRGB) {
+                for (int k = 0; k < 3; k++) sum[k] = linear_to_srgb(sum[k]);
+            } else if (format == BlockFormat::BC5) {
+                float len = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+                if (len < 1e-6f) {
+                    sum[0] = sum[1] = 0.0f;
+                    sum[2] = 1.0f;
+                    len = 1.0f;
+                }
+                for (int k = 0; k < 3; k++) sum[k] = (sum[k] / len) * 0.5f + 0.5f;
+            }
+
+            dst.at(x, y) = Pixel::from_float(sum[0], sum[1], sum[2], sum[3]);
+        }
+    }
+
+    return dst;
+}
+
+// Compress one level into 4x4 blocks (edge texels repeat for small levels)
+static void compress_level(const Image& image, BlockFormat format, std::vector<uint8_t>& out) {
+    int blocks_x = (image.width() + 3) / 4;
+    int blocks_y = (image.height() + 3) / 4;
+    size_t block_size = format == BlockFormat::BC5 ? 16 : 8;
+    out.resize(static_cast<size_t>(blocks_x) * blocks_y * block_size);
+
+    Pixel pixels[16];
+    uint8_t red[16];
+    uint8_t green[16];
+
+    for (int by = 0; by < blocks_y; by++) {
+        for (int bx = 0; bx < blocks_x; bx++) {
+            for (int i = 0; i < 16; i++) {
+                int x = std::min(bx * 4 + (i % 4), image.width() - 1);
+                int y = std::min(by * 4 + (i / 4), image.height() - 1);
+                pixels[i] = image.at(x, y);
+                red[i] = pixels[i].r;
+                green[i] = pixels[i].g;
+            }
+
+            uint8_t* block = &out[(static_cast<size_t>(by) * blocks_x + bx) * block_size];
+            switch (format) {
+                case BlockFormat::BC1_SRGB:
+                    encode_bc1(pixels, block);
+                    break;
+                case BlockFormat::BC4:
+                    encode_bc4(red, block);
+                    break;
+                case BlockFormat::BC5:
+                    encode_bc4(red, block);
+                    encode_bc4(green, block + 8);
+                    break;
+            }
+        }
+    }
+}
+
+// ============================================================================
+// KTX2 container
+// ============================================================================
+
+static void put_u32(std::vector<uint8_t>& out, size_t offset, uint32_t value) {
+    memcpy(&out[offset], &value, sizeof(value));
+}
+
+static void put_u64(std::vector<uint8_t>& out, size_t offset, uint64_t value) {
+    memcpy(&out[offset], &value, sizeof(value));
+}
+
+// Basic data format descriptor for a 4x4 block-compressed format
+static std::vector<uint8_t> make_dfd(BlockFormat format) {
+    uint32_t sample_count = format == BlockFormat::BC5 ? 2 : 1;
+    uint32_t block_size = 24 + 16 * sample_count;
+
+    std::vector<uint8_t> dfd(4 + block_size, 0);
+    put_u32(dfd, 0, static_cast<uint32_t>(dfd.size()));     // dfdTotalSize
+    put_u32(dfd, 4, 0);                                      // Khronos vendor, basic descriptor
+    put_u32(dfd, 8, 2 | (block_size << 16));                 // Version 2, block size
+
+    switch (format) {
+        case BlockFormat::BC1_SRGB: dfd[12] = KHR_DF_MODEL_BC1A; break;
+        case BlockFormat::BC4: dfd[12] = KHR_DF_MODEL_BC4; break;
+        case BlockFormat::BC5: dfd[12] = KHR_DF_MODEL_BC5; break;
+    }
+    dfd[13] = 1;                                             // BT.709 primaries
+    dfd[14] = format == BlockFormat::BC1_SRGB ? 2 : 1;       // sRGB or linear transfer
+    dfd[15] = 0;                                             // Straight alpha
+    dfd[16] = 3;                                             // 4x4 texel blocks (dimension - 1)
+    dfd[17] = 3;
+    dfd[20] = format == BlockFormat::BC5 ? 16 : 8;           // Bytes per block
+
+    for (uint32_t s = 0; s < sample_count; s++) {
+        size_t sample = 28 + s * 16;
+        dfd[sample + 0] = static_cast<uint8_t>((s * 64) & 0xFF);  // Bit offset
+        dfd[sample + 1] = static_cast<uint8_t>((s * 64) >> 8);
+        dfd[sample + 2] = 63;                                     // Bit length - 1
+        dfd[sample + 3] = static_cast<uint8_t>(s);                // Channel (BC5: red, green)
+        put_u32(dfd, sample + 8, 0);                              // Sample lower
+        put_u32(dfd, sample + 12, 0xFFFFFFFF);                    // Sample upper
+    }
+
+    return dfd;
+}
+
+bool save_ktx2(const std::string& path, const Image& image, BlockFormat format) {
+    // Compress the whole chain first; the file stores levels smallest first
+    std::vector<std::vector<uint8_t>> levels;
+    levels.emplace_back();
+    compress_level(image, format, levels.back());
+
+    Image current = image;
+    while (current.width() > 1 || current.height() > 1) {
+        current = downsample(current, format);
+        levels.emplace_back();
+        compress_level(current, format, levels.back());
+    }
+
+    uint32_t level_count = static_cast<uint32_t>(levels.size());
+    std::vector<uint8_t> dfd = make_dfd(format);
+
+    const size_t HEADER_SIZE = 80;
+    size_t dfd_offset = HEADER_SIZE + level_count * 24;
+    size_t data_offset = dfd_offset + dfd.size();
+
+    // Level data aligned to the block size (8 or 16 bytes)
+    size_t alignment = format == BlockFormat::BC5 ? 16 : 8;
+    std::vector<uint64_t> offsets(level_count);
+    size_t cursor = data_offset;
+    for (uint32_t i = level_count; i-- > 0;) {
+        cursor = (cursor + alignment - 1) / alignment * alignment;
+        offsets[i] = cursor;
+        cursor += levels[i].size();
+    }
+
+    std::vector<uint8_t> file(cursor, 0);
+
+    static const uint8_t KTX2_IDENTIFIER[12] = {
+        0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'
+    };
+    memcpy(file.data(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+
+    uint32_t vk_format = 0;
+    switch (format) {
+        case BlockFormat::BC1_SRGB: vk_format = VK_FORMAT_BC1_RGB_SRGB_BLOCK; break;
+        case BlockFormat::BC4: vk_format = VK_FORMAT_BC4_UNORM_BLOCK; break;
+        case BlockFormat::BC5: vk_format = VK_FORMAT_BC5_UNORM_BLOCK; break;
+    }
+
+    put_u32(file, 12, vk_format);
+    put_u32(file, 16, 1);                                    // typeSize
+    put_u32(file, 20, static_cast<uint32_t>(image.width()));
+    put_u32(file, 24, static_cast<uint32_t>(image.height()));
+    put_u32(file, 28, 0);                                    // pixelDepth
+    put_u32(file, 32, 0);                                    // layerCount
+    put_u32(file, 36, 1);                                    // faceCount
+    put_u32(file, 40, level_count);
+    put_u32(file, 44, 0);                                    // No supercompression
+    put_u32(file, 48, static_cast<uint32_t>(dfd_offset));
+    put_u32(file, 52, static_cast<uint32_t>(dfd.size()));
+    put_u32(file, 56, 0);                                    // No key/value data
+    put_u32(file, 60, 0);
+    put_u64(file, 64, 0);                                    // No supercompression data
+    put_u64(file, 72, 0);
+
+    for (uint32_t i = 0; i < level_count; i++) {
+        size_t entry = HEADER_SIZE + i * 24;
+        put_u64(file, entry + 0, offsets[i]);
+        put_u64(file, entry + 8, levels[i].size());
+        put_u64(file, entry + 16, levels[i].size());
+        memcpy(&file[offsets[i]], levels[i].data(), levels[i].size());
+    }
+    memcpy(&file[dfd_offset], dfd.data(), dfd.size());
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        fprintf(stderr, "Failed to write %s\n", path.c_str());
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(file.data()), file.size());
+    return true;
+}
+
+} // namespace slam
@@ -0,0 +1,36 @@
+/**
+ * Slam Engine - Block Compression
+ *
+ * BC1/BC4/BC5 encoders and a KTX2 writer for baked materials. Each file
+ * holds the full mip chain (box filtered: in linear light for sRGB color,
+ * renormalized for normal maps), since compressed images cannot be
+ * mip-mapped with blits at load time.
+ *
+ * The encoders use bounding-box endpoints with a small inset and pick the
+ * nearest palette entry per texel: fast, and within a few percent of an
+ * exhaustive search for the smooth procedural maps the baker produces.
+ */
+
+#pragma once
+
+#include "material_generator.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace slam {
+
+enum class BlockFormat {
+    BC1_SRGB,   // Color (albedo), 4 bpp
+    BC4,        // Single channel (roughness, metallic, AO), 4 bpp
+    BC5,        // Two channel tangent-space normal XY, 8 bpp; Z is reconstructed
+};
+
+// Encode the image and its mip chain into a KTX2 file
+bool save_ktx2(const std::string& path, const Image& image, BlockFormat format);
+
+// Individual block encoders (pixels: 16 texels, row major)
+void encode_bc1(const Pixel* pixels, uint8_t* block);
+void encode_bc4(const uint8_t* values, uint8_t* block);
+
+} // namespace slam
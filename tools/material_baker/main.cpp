@@ -12,6 +12,7 @@
  *   --seed <n>         Random seed (default: 12345)
  *   --type <name>      Generate specific type (stone_floor, stone_wall, metal, wood, decorative_trim)
  *   --all              Generate all material types (default)
+ *   --compress         Also write block-compressed KTX2 files (BC1/BC4/BC5, with mips)
  *   --help             Show this help message
  */
 
@@ -32,6 +33,7 @@ void print_usage(const char* program_name) {
     printf("  --type <name>      Generate specific type:\n");
     printf("                       stone_floor, stone_wall, metal, wood, decorative_trim\n");
     printf("  --all              Generate all material types (default)\n");
+    printf("  --compress         Also write block-compressed KTX2 files (BC1/BC4/BC5, with mips)\n");
     printf("  --help             Show this help message\n");
 }
 
@@ -50,6 +52,7 @@ int main(int argc, char* argv[]) {
     int resolution = 2048;
     uint32_t seed = 12345;
     bool generate_all = true;
+    bool compress = false;
     slam::MaterialType specific_type = slam::MaterialType::StoneFloor;
 
     // Parse arguments
@@ -70,6 +73,9 @@ int main(int argc, char* argv[]) {
         else if (strcmp(argv[i], "--all") == 0) {
             generate_all = true;
         }
+        else if (strcmp(argv[i], "--compress") == 0) {
+            compress = true;
+        }
         else if (strcmp(argv[i], "--help") == 0) {
             print_usage(argv[0]);
             return 0;
@@ -91,6 +97,7 @@ int main(int argc, char* argv[]) {
     printf("  Output:     %s\n", output_dir.c_str());
     printf("  Resolution: %dx%d\n", resolution, resolution);
     printf("  Seed:       %u\n", seed);
+    printf("  Compress:   %s\n", compress ? "BC1/BC4/BC5 KTX2" : "off");
     printf("\n");
 
     // Create generator
@@ -99,18 +106,14 @@ int main(int argc, char* argv[]) {
     auto start_time = std::chrono::high_resolution_clock::now();
 
     if (generate_all) {
-        generator.generate_all(resolution, output_dir);
+        generator.generate_all(resolution, output_dir, compress);
     } else {
         printf("Generating %s...\n", slam::material_type_name(specific_type));
 
         slam::MaterialTextures tex = generator.generate(specific_type, resolution);
 
         std::string name = slam::material_type_name(specific_type);
-        tex.albedo.save_tga(output_dir + "/" + name + "_albedo.tga");
-        tex.normal.save_tga(output_dir + "/" + name + "_normal.tga");
-        tex.roughness.save_tga(output_dir + "/" + name + "_roughness.tga");
-        tex.metallic.save_tga(output_dir + "/" + name + "_metallic.tga");
-        tex.ao.save_tga(output_dir + "/" + name + "_ao.tga");
+        slam::save_material(tex, output_dir, name, compress);
 
         printf("  Saved %s textures\n", name.c_str());
     }
@@ -3,6 +3,7 @@
  */
 
 #include "material_generator.h"
+#include "block_compress.h"
 #include <fstream>
 #include <cstdio>
 #include <cmath>
@@ -94,7 +95,7 @@ MaterialTextures MaterialGenerator::generate(MaterialType type, int resolution)
     return tex;
 }
 
-void MaterialGenerator::generate_all(int resolution, const std::string& output_dir) {
+void MaterialGenerator::generate_all(int resolution, const std::string& output_dir, bool compress) {
     // Create output directory
     mkdir(output_dir.c_str(), 0755);
 
@@ -112,11 +113,7 @@ void MaterialGenerator::generate_all(int resolution, const std::string& output_d
         MaterialTextures tex = generate(type, resolution);
 
         std::string name = material_type_name(type);
-        tex.albedo.save_tga(output_dir + "/" + name + "_albedo.tga");
-        tex.normal.save_tga(output_dir + "/" + name + "_normal.tga");
-        tex.roughness.save_tga(output_dir + "/" + name + "_roughness.tga");
-        tex.metallic.save_tga(output_dir + "/" + name + "_metallic.tga");
-        tex.ao.save_tga(output_dir + "/" + name + "_ao.tga");
+        save_material(tex, output_dir, name, compress);
 
         printf("  Saved %s textures\n", name.c_str());
     }
@@ -596,4 +593,26 @@ const char* material_type_name(MaterialType type) {
     }
 }
 
+bool save_material(const MaterialTextures& tex, const std::string& output_dir,
+                   const std::string& name, bool compress) {
+    std::string base = output_dir + "/" + name;
+
+    bool ok = tex.albedo.save_tga(base + "_albedo.tga");
+    ok &= tex.normal.save_tga(base + "_normal.tga");
+    ok &= tex.roughness.save_tga(base + "_roughness.tga");
+    ok &= tex.metallic.save_tga(base + "_metallic.tga");
+    ok &= tex.ao.save_tga(base + "_ao.tga");
+
+    if (compress) {
+        // Grayscale maps store the value in every channel; BC4 keeps red
+        ok &= save_ktx2(base + "_albedo.bc.ktx2", tex.albedo, BlockFormat::BC1_SRGB);
+        ok &= save_ktx2(base + "_normal.bc.ktx2", tex.normal, BlockFormat::BC5);
+        ok &= save_ktx2(base + "_roughness.bc.ktx2", tex.roughness, BlockFormat::BC4);
+        ok &= save_ktx2(base + "_metallic.bc.ktx2", tex.metallic, BlockFormat::BC4);
+        ok &= save_ktx2(base + "_ao.bc.ktx2", tex.ao, BlockFormat::BC4);
+    }
+
+    return ok;
+}
+
 } // namespace slam
@@ -127,8 +127,8 @@ public:
     // Generate specific material type
     MaterialTextures generate(MaterialType type, int resolution);
 
-    // Generate all material types
-    void generate_all(int resolution, const std::string& output_dir);
+    // Generate all material types (compress: also write .bc.ktx2 files)
+    void generate_all(int resolution, const std::string& output_dir, bool compress = false);
 
 private:
     // Individual material generators
@@ -153,4 +153,9 @@ private:
 // Convert material type to string
 const char* material_type_name(MaterialType type);
 
+// Save all maps as <output_dir>/<name>_<map>.tga, plus block-compressed
+// <name>_<map>.bc.ktx2 files with mip chains when compress is set
+bool save_material(const MaterialTextures& tex, const std::string& output_dir,
+                   const std::string& name, bool compress);
+
 } // namespace slam
@@ -0,0 +1,639 @@
+/**
+ * Slam Engine - Math Bench Tool
+ *
+ * Times the utils/math.h operations the renderer runs every frame against
+ * plain scalar reference versions (the pre-SIMD code), and the
+ * utils/batch_math.h SoA kernels against per-element loops over the same
+ * data, Transform (TRS) composition against the mat4 chain it replaces,
+ * and the utils/fast_math.h approximations against std (checking each
+ * stays within its documented error bound), and checks that they agree.
+ * Finally it runs a long utils/fixed_math.h simulation and compares its
+ * hash with a golden value, which must match on every platform and build.
+ * The backend is chosen at compile
+ * time: build with -DSLAM_MATH_SCALAR=ON or -DSLAM_MATH_AVX2=ON to compare
+ * others.
+ *
+ * Usage:
+ *   math_bench [options]
+ *
+ * Options:
+ *   --count <n>        Elements per batch (default: 4096)
+ *   --iterations <n>   Batches per measurement (default: 200)
+ *   --help             Show this help message
+ */
+
+#include "utils/batch_math.h"
+#include "utils/fast_math.h"
+#include "utils/fixed_math.h"
+#include "utils/math.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+using namespace slam;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+// ============================================================================
+// Scalar reference implementations
+// ============================================================================
+
+static mat4 ref_multiply(const mat4& a, const mat4& b) {
+    mat4 result;
+    for (int col = 0; col < 4; ++col) {
+        for (int row = 0; row < 4; ++row) {
+            result.at(row, col) =
+                a.at(row, 0) * b.at(0, col) +
+                a.at(row, 1) * b.at(1, col) +
+                a.at(row, 2) * b.at(2, col) +
+                a.at(row, 3) * b.at(3, col);
+        }
+    }
+    return result;
+}
+
+static vec4 ref_transform(const mat4& m, const vec4& v) {
+    vec4 result;
+    result.x = m[0].x * v.x + m[1].x * v.y + m[2].x * v.z + m[3].x * v.w;
+    result.y = m[0].y * v.x + m[1].y * v.y + m[2].y * v.z + m[3].y * v.w;
+    result.z = m[0].z * v.x + m[1].z * v.y + m[2].z * v.z + m[3].z * v.w;
+    result.w = m[0].w * v.x + m[1].w * v.y + m[2].w * v.z + m[3].w * v.w;
+    return result;
+}
+
+static mat4 ref_inverse(const mat4& matrix) {
+    const float* m = matrix.data();
+    float inv[16];
+
+    inv[0] = m[5]  * m[10] * m[15] - m[5]  * m[11] * m[14] - m[9]  * m[6]  * m[15] +
+             m[9]  * m[7]  * m[14] + m[13] * m[6]  * m[11] - m[13] * m[7]  * m[10];
+    inv[4] = -m[4] * m[10] * m[15] + m[4]  * m[11] * m[14] + m[8]  * m[6]  * m[15] -
+             m[8]  * m[7]  * m[14] - m[12] * m[6]  * m[11] + m[12] * m[7]  * m[10];
+    inv[8] = m[4]  * m[9]  * m[15] - m[4]  * m[11] * m[13] - m[8]  * m[5]  * m[15] +
+             m[8]  * m[7]  * m[13] + m[12] * m[5]  * m[11] - m[12] * m[7]  * m[9];
+    inv[12] = -m[4] * m[9] * m[14] + m[4]  * m[10] * m[13] + m[8]  * m[5]  * m[14] -
+              m[8]  * m[6] * m[13] - m[12] * m[5]  * m[10] + m[12] * m[6]  * m[9];
+    inv[1] = -m[1] * m[10] * m[15] + m[1]  * m[11] * m[14] + m[9]  * m[2]  * m[15] -
+             m[9]  * m[3]  * m[14] - m[13] * m[2]  * m[11] + m[13] * m[3]  * m[10];
+    inv[5] = m[0]  * m[10] * m[15] - m[0]  * m[11] * m[14] - m[8]  * m[2]  * m[15] +
+             m[8]  * m[3]  * m[14] + m[12] * m[2]  * m[11] - m[12] * m[3]  * m[10];
+    inv[9] = -m[0] * m[9]  * m[15] + m[0]  * m[11] * m[13] + m[8]  * m[1]  * m[15] -
+             m[8]  * m[3]  * m[13] - m[12] * m[1]  * m[11] + m[12] * m[3]  * m[9];
+    inv[13] = m[0] * m[9]  * m[14] - m[0]  * m[10] * m[13] - m[8]  * m[1]  * m[14] +
+              m[8] * m[2]  * m[13] + m[12] * m[1]  * m[10] - m[12] * m[2]  * m[9];
+    inv[2] = m[1]  * m[6]  * m[15] - m[1]  * m[7]  * m[14] - m[5]  * m[2]  * m[15] +
+             m[5]  * m[3]  * m[14] + m[13] * m[2]  * m[7]  - m[13] * m[3]  * m[6];
+    inv[6] = -m[0] * m[6]  * m[15] + m[0]  * m[7]  * m[14] + m[4]  * m[2]  * m[15] -
+             m[4]  * m[3]  * m[14] - m[12] * m[2]  * m[7]  + m[12] * m[3]  * m[6];
+    inv[10] = m[0] * m[5]  * m[15] - m[0]  * m[7]  * m[13] - m[4]  * m[1]  * m[15] +
+              m[4] * m[3]  * m[13] + m[12] * m[1]  * m[7]  - m[12] * m[3]  * m[5];
+    inv[14] = -m[0] * m[5] * m[14] + m[0]  * m[6]  * m[13] + m[4]  * m[1]  * m[14] -
+              m[4]  * m[2] * m[13] - m[12] * m[1]  * m[6]  + m[12] * m[2]  * m[5];
+    inv[3] = -m[1] * m[6]  * m[11] + m[1]  * m[7]  * m[10] + m[5]  * m[2]  * m[11] -
+             m[5]  * m[3]  * m[10] - m[9]  * m[2]  * m[7]  + m[9]  * m[3]  * m[6];
+    inv[7] = m[0]  * m[6]  * m[11] - m[0]  * m[7]  * m[10] - m[4]  * m[2]  * m[11] +
+             m[4]  * m[3]  * m[10] + m[8]  * m[2]  * m[7]  - m[8]  * m[3]  * m[6];
+    inv[11] = -m[0] * m[5] * m[11] + m[0]  * m[7]  * m[9]  + m[4]  * m[1]  * m[11] -
+              m[4]  * m[3] * m[9]  - m[8]  * m[1]  * m[7]  + m[8]  * m[3]  * m[5];
+    inv[15] = m[0] * m[5]  * m[10] - m[0]  * m[6]  * m[9]  - m[4]  * m[1]  * m[10] +
+              m[4] * m[2]  * m[9]  + m[8]  * m[1]  * m[6]  - m[8]  * m[2]  * m[5];
+
+    float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (det == 0) return mat4(1.0f);
+
+    float inv_det = 1.0f / det;
+    mat4 result;
+    float* r = result.data();
+    for (int i = 0; i < 16; i++) {
+        r[i] = inv[i] * inv_det;
+    }
+    return result;
+}
+
+// ============================================================================
+// Kernels (one batch each; kept out of line so each batch is real work)
+// ============================================================================
+
+BENCH_NOINLINE static void ref_multiply_batch(const mat4* a, const mat4* b, mat4* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = ref_multiply(a[i], b[i]);
+}
+
+BENCH_NOINLINE static void multiply_batch(const mat4* a, const mat4* b, mat4* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = a[i] * b[i];
+}
+
+BENCH_NOINLINE static void ref_transform_batch(const mat4& m, const vec4* in, vec4* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = ref_transform(m, in[i]);
+}
+
+BENCH_NOINLINE static void transform_batch(const mat4& m, const vec4* in, vec4* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = m * in[i];
+}
+
+BENCH_NOINLINE static void ref_inverse_batch(const mat4* in, mat4* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = ref_inverse(in[i]);
+}
+
+BENCH_NOINLINE static void inverse_batch(const mat4* in, mat4* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = in[i].inverse();
+}
+
+// Per-element versions of the batch kernels, on array-of-structs data
+
+struct Sphere {
+    vec4 center_radius;  // xyz = center, w = radius
+};
+
+struct Box {
+    vec3 min;
+    vec3 max;
+};
+
+BENCH_NOINLINE static void ref_transform_spheres(const mat4& m, const Sphere* in, Sphere* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        vec4 center = m * vec4(in[i].center_radius.xyz(), 1.0f);
+        out[i].center_radius = vec4(center.xyz(), in[i].center_radius.w);
+    }
+}
+
+BENCH_NOINLINE static uint32_t ref_spheres_touching_aabb(const Sphere* spheres, size_t count, const Box& box,
+                                                         uint32_t* out, uint32_t limit) {
+    uint32_t written = 0;
+    for (size_t i = 0; i < count && written < limit; i++) {
+        vec3 c = spheres[i].center_radius.xyz();
+        float r = spheres[i].center_radius.w;
+        float dist_sq = 0.0f;
+        for (int axis = 0; axis < 3; axis++) {
+            if (c[axis] < box.min[axis]) dist_sq += (box.min[axis] - c[axis]) * (box.min[axis] - c[axis]);
+            else if (c[axis] > box.max[axis]) dist_sq += (c[axis] - box.max[axis]) * (c[axis] - box.max[axis]);
+        }
+        if (dist_sq <= r * r) out[written++] = static_cast<uint32_t>(i);
+    }
+    return written;
+}
+
+BENCH_NOINLINE static void ref_transform_aabbs(const mat4& m, const Box* in, Box* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        vec3 lo(1e30f), hi(-1e30f);
+        for (int corner = 0; corner < 8; corner++) {
+            vec3 p((corner & 1) ? in[i].max.x : in[i].min.x,
+                   (corner & 2) ? in[i].max.y : in[i].min.y,
+                   (corner & 4) ? in[i].max.z : in[i].min.z);
+            vec4 t = m * vec4(p, 1.0f);
+            lo = vec3(std::min(lo.x, t.x), std::min(lo.y, t.y), std::min(lo.z, t.z));
+            hi = vec3(std::max(hi.x, t.x), std::max(hi.y, t.y), std::max(hi.z, t.z));
+        }
+        out[i].min = lo;
+        out[i].max = hi;
+    }
+}
+
+BENCH_NOINLINE static uint32_t ref_cull_aabbs(const Frustum& frustum, const Box* boxes, size_t count,
+                                              uint32_t* visible) {
+    uint32_t written = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool inside = true;
+        for (const vec4& plane : frustum.planes) {
+            vec3 corner(plane.x >= 0.0f ? boxes[i].max.x : boxes[i].min.x,
+                        plane.y >= 0.0f ? boxes[i].max.y : boxes[i].min.y,
+                        plane.z >= 0.0f ? boxes[i].max.z : boxes[i].min.z);
+            if (dot(plane.xyz(), corner) + plane.w < 0.0f) {
+                inside = false;
+                break;
+            }
+        }
+        if (inside) visible[written++] = static_cast<uint32_t>(i);
+    }
+    return written;
+}
+
+BENCH_NOINLINE static void ref_compose_batch(const Transform* parent, const Transform* child, mat4* out,
+                                             size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = parent[i].to_mat4() * child[i].to_mat4();
+}
+
+BENCH_NOINLINE static void compose_batch(const Transform* parent, const Transform* child, mat4* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = (parent[i] * child[i]).to_mat4();
+}
+
+// One function over an array (std or fast:: version, inlined per lambda)
+template <typename Fn>
+BENCH_NOINLINE static void map_batch(Fn fn, const float* in, float* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = fn(in[i]);
+}
+
+template <typename Fn>
+BENCH_NOINLINE static void map2_batch(Fn fn, const float* a, const float* b, float* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = fn(a[i], b[i]);
+}
+
+BENCH_NOINLINE static void transform_spheres_batch(const mat4& m, const SpheresSoA& in, SpheresSoA& out) {
+    transform_spheres(m, in, out);
+}
+
+BENCH_NOINLINE static void transform_aabbs_batch(const mat4& m, const AabbsSoA& in, AabbsSoA& out) {
+    transform_aabbs(m, in, out);
+}
+
+// ============================================================================
+// Deterministic simulation
+// ============================================================================
+
+// Hash of run_fixed_simulation(FIXED_BODIES, FIXED_TICKS). Any change to
+// fixed_math.h results, or a platform that computes them differently, breaks it.
+constexpr uint64_t FIXED_GOLDEN_HASH = 0xe97a317eb0e7f17cull;
+constexpr uint32_t FIXED_BODIES = 256;
+constexpr uint32_t FIXED_TICKS = 3600;  // One minute at 60 Hz
+
+struct FixedBody {
+    fvec3 position;
+    fvec3 velocity;
+    fquat orientation;
+    fvec3 angular_velocity;
+};
+
+// FNV-1a over whole raw values rather than bytes
+static uint64_t hash_raw(uint64_t hash, fixed value) {
+    return (hash ^ static_cast<uint32_t>(value.raw)) * 0x100000001b3ull;
+}
+
+// Reflect off a wall at +-limit, losing some speed
+static void bounce(fixed& position, fixed& velocity, fixed limit, fixed restitution) {
+    if (abs(position) > limit) {
+        position = position > fixed() ? limit : -limit;
+        velocity = -velocity * restitution;
+    }
+}
+
+// Bodies falling and spinning in a walled box with a gusting wind, hashed
+// every tick: positions, velocities and orientations all feed the result
+BENCH_NOINLINE static uint64_t run_fixed_simulation(uint32_t body_count, uint32_t ticks) {
+    uint32_t seed = 12345;
+    auto next = [&](int32_t lo, int32_t hi) {
+        seed = seed * 1664525u + 1013904223u;
+        return fixed::from_raw(lo * fixed::ONE + static_cast<int32_t>((seed >> 8) % static_cast<uint32_t>((hi - lo) * fixed::ONE)));
+    };
+
+    std::vector<FixedBody> bodies(body_count);
+    for (FixedBody& body : bodies) {
+        body.position = fvec3(next(-20, 20), next(0, 10), next(-20, 20));
+        body.velocity = fvec3(next(-5, 5), next(-2, 8), next(-5, 5));
+        body.angular_velocity = fvec3(next(-3, 3), next(-3, 3), next(-3, 3));
+    }
+
+    const fixed dt = fixed::ratio(1, 60);
+    const fvec3 gravity(fixed(), fixed(-10), fixed());
+    const fixed wall(20);
+    const fixed restitution = fixed::ratio(4, 5);
+    const fixed angular_damping = fixed::ratio(999, 1000);
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+    fixed time;
+    for (uint32_t tick = 0; tick < ticks; tick++) {
+        time = time + dt;
+        if (time > FIXED_TWO_PI) time = time - FIXED_TWO_PI;
+        fvec3 wind(sin(time) * fixed(2), fixed(), cos(time * fixed(3)));
+
+        for (FixedBody& body : bodies) {
+            body.velocity += (gravity + wind) * dt;
+            body.position += body.velocity * dt;
+            if (body.position.y < fixed()) {
+                body.position.y = -body.position.y;
+                body.velocity.y = -body.velocity.y * restitution;
+            }
+            bounce(body.position.x, body.velocity.x, wall, restitution);
+            bounce(body.position.z, body.velocity.z, wall, restitution);
+            body.orientation = body.orientation.integrate(body.angular_velocity, dt);
+            body.angular_velocity *= angular_damping;
+
+            fvec3 up = body.orientation * fvec3(fixed(), fixed(1), fixed());
+            for (fixed value : {body.position.x, body.position.y, body.position.z,
+                                body.velocity.x, body.velocity.y, body.velocity.z, up.x, up.y, up.z,
+                                body.orientation.x, body.orientation.y, body.orientation.z, body.orientation.w}) {
+                hash = hash_raw(hash, value);
+            }
+        }
+    }
+    return hash;
+}
+
+// ============================================================================
+// Harness
+// ============================================================================
+
+struct Random {
+    uint32_t state = 12345;
+    float next(float lo, float hi) {
+        state = state * 1664525u + 1013904223u;
+        return lo + (hi - lo) * static_cast<float>(state >> 8) / 16777216.0f;
+    }
+};
+
+// Nanoseconds per element
+template <typename Fn>
+static double measure(uint32_t iterations, size_t count, Fn&& batch) {
+    batch();  // Warm caches
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        batch();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return ns / (static_cast<double>(iterations) * static_cast<double>(count));
+}
+
+// Largest difference relative to the reference's magnitude
+static float max_relative_error(const float* values, const float* reference, size_t count) {
+    float error = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        float scale = std::max(1.0f, std::abs(reference[i]));
+        error = std::max(error, std::abs(values[i] - reference[i]) / scale);
+    }
+    return error;
+}
+
+static bool report(const char* name, double ref_ns, double ns, float error, float tolerance) {
+    bool ok = error <= tolerance;
+    printf("  %-16s %8.2f ns %8.2f ns %7.2fx   err %.1e %s\n", name, ref_ns, ns, ref_ns / ns,
+        error, ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+// Largest error of fast against the double-precision truth; relative
+// divides by max(floor, |truth|) (floor 0 for pure relative, huge for absolute)
+template <typename Truth>
+static float max_error(const float* in, const float* fast, size_t count, Truth truth, double floor) {
+    double error = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        double expected = truth(static_cast<double>(in[i]));
+        error = std::max(error, std::abs(fast[i] - expected) / std::max(floor, std::abs(expected)));
+    }
+    return static_cast<float>(error);
+}
+
+static Transform random_transform(Random& random) {
+    vec3 axis = normalize(vec3(random.next(-1, 1), 1.0f, random.next(-1, 1)));
+    return Transform(vec3(random.next(-50, 50), random.next(-5, 5), random.next(-50, 50)),
+                     quat::from_axis_angle(axis, random.next(0, TWO_PI)), random.next(0.5f, 2.0f));
+}
+
+static mat4 random_affine(Random& random) {
+    mat4 m = translate(vec3(random.next(-50, 50), random.next(-5, 5), random.next(-50, 50)));
+    m = rotate(m, random.next(0, TWO_PI), vec3(random.next(-1, 1), 1.0f, random.next(-1, 1)));
+    return scale(m, vec3(random.next(0.5f, 2.0f)));
+}
+
+static void print_usage(const char* program_name) {
+    printf("Slam Engine - Math Bench\n");
+    printf("utils/math.h micro-benchmarks against scalar references\n\n");
+    printf("Usage: %s [options]\n\n", program_name);
+    printf("Options:\n");
+    printf("  --count <n>        Elements per batch (default: 4096)\n");
+    printf("  --iterations <n>   Batches per measurement (default: 200)\n");
+    printf("  --help             Show this help message\n");
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = 4096;
+    uint32_t iterations = 200;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = static_cast<size_t>(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = static_cast<uint32_t>(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        }
+        else {
+            printf("Unknown option: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (count == 0 || iterations == 0) {
+        printf("Count and iterations must be positive\n");
+        return 1;
+    }
+
+    printf("Math Bench\n");
+    printf("  Backend:    %s\n", simd::BACKEND);
+    printf("  Count:      %zu\n", count);
+    printf("  Iterations: %u\n", iterations);
+    printf("\n");
+
+    // A view-projection like the renderer's, plus per-prop model matrices
+    Random random;
+    mat4 view_proj = perspective(radians(70.0f), 16.0f / 9.0f, 0.1f, 100.0f) *
+                     look_at(vec3(3, 2, 5), vec3(0), vec3(0, 1, 0));
+    std::vector<mat4> a(count), b(count), out(count), ref_out(count);
+    std::vector<vec4> points(count), points_out(count), ref_points_out(count);
+    for (size_t i = 0; i < count; i++) {
+        a[i] = view_proj;
+        b[i] = random_affine(random);
+        points[i] = vec4(random.next(-50, 50), random.next(-5, 5), random.next(-50, 50), 1.0f);
+    }
+
+    printf("  %-16s %11s %11s %8s\n", "operation", "scalar", "simd", "speedup");
+    bool ok = true;
+
+    double ref_ns = measure(iterations, count, [&] { ref_multiply_batch(a.data(), b.data(), ref_out.data(), count); });
+    double ns = measure(iterations, count, [&] { multiply_batch(a.data(), b.data(), out.data(), count); });
+    ok &= report("mat4 * mat4", ref_ns, ns,
+        max_relative_error(out[0].data(), ref_out[0].data(), count * 16), 1e-5f);
+
+    ref_ns = measure(iterations, count, [&] { ref_transform_batch(view_proj, points.data(), ref_points_out.data(), count); });
+    ns = measure(iterations, count, [&] { transform_batch(view_proj, points.data(), points_out.data(), count); });
+    ok &= report("mat4 * vec4", ref_ns, ns,
+        max_relative_error(&points_out[0].x, &ref_points_out[0].x, count * 4), 1e-5f);
+
+    ref_ns = measure(iterations, count, [&] { ref_inverse_batch(b.data(), ref_out.data(), count); });
+    ns = measure(iterations, count, [&] { inverse_batch(b.data(), out.data(), count); });
+    ok &= report("inverse", ref_ns, ns,
+        max_relative_error(out[0].data(), ref_out[0].data(), count * 16), 1e-4f);
+
+    // ---- Transforms: parent * child as TRS, against multiplying their matrices ----
+    std::vector<Transform> parents(count), children(count);
+    for (size_t i = 0; i < count; i++) {
+        parents[i] = random_transform(random);
+        children[i] = random_transform(random);
+    }
+    ref_ns = measure(iterations, count, [&] { ref_compose_batch(parents.data(), children.data(), ref_out.data(), count); });
+    ns = measure(iterations, count, [&] { compose_batch(parents.data(), children.data(), out.data(), count); });
+    ok &= report("trs compose", ref_ns, ns,
+        max_relative_error(out[0].data(), ref_out[0].data(), count * 16), 1e-4f);
+
+    // A TRS and its inverse cancel (translation error scaled to the ±50 range),
+    // and the 3x4 instance layout round-trips
+    float error = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        mat4 round_trip = (parents[i] * parents[i].inverse()).to_mat4();
+        mat4 packed = mat3x4(parents[i].to_mat4()).to_mat4();
+        mat4 expected = parents[i].to_mat4();
+        for (int j = 0; j < 16; j++) {
+            error = std::max(error, std::abs(round_trip.data()[j] - mat4::identity().data()[j]) / 50.0f);
+            error = std::max(error, std::abs(packed.data()[j] - expected.data()[j]));
+        }
+    }
+    printf("  %-16s %35s   err %.1e %s\n", "trs inverse", "", error, error <= 1e-5f ? "ok" : "MISMATCH");
+    ok &= error <= 1e-5f;
+
+    // ---- Fast math: std against fast:: over each documented domain ----
+    printf("\n  %-16s %11s %11s %8s\n", "fast math", "std", "fast", "speedup");
+    std::vector<float> positive(count), angles(count), exponents(count), bases(count), powers(count);
+    std::vector<float> std_out(count), fast_out(count);
+    for (size_t i = 0; i < count; i++) {
+        positive[i] = std::exp2(random.next(-120, 120));
+        angles[i] = random.next(-1024 * PI, 1024 * PI);
+        exponents[i] = random.next(-126, 127);
+        bases[i] = std::exp2(random.next(-8, 8));
+        powers[i] = random.next(-4, 4);
+    }
+    // Absolute bounds: a floor no truth reaches, so the error is not scaled
+    constexpr double ABSOLUTE = 1e30;
+
+    ref_ns = measure(iterations, count, [&] {
+        map_batch([](float x) { return 1.0f / std::sqrt(x); }, positive.data(), std_out.data(), count); });
+    ns = measure(iterations, count, [&] { map_batch([](float x) { return fast::rsqrt(x); }, positive.data(), fast_out.data(), count); });
+    ok &= report("rsqrt", ref_ns, ns, max_error(positive.data(), fast_out.data(), count,
+        [](double x) { return 1.0 / std::sqrt(x); }, 0.0), 5e-6f);
+
+    ref_ns = measure(iterations, count, [&] {
+        map_batch([](float x) { return std::sin(x); }, angles.data(), std_out.data(), count); });
+    ns = measure(iterations, count, [&] { map_batch([](float x) { return fast::sin(x); }, angles.data(), fast_out.data(), count); });
+    ok &= report("sin", ref_ns, ns, max_error(angles.data(), fast_out.data(), count,
+        [](double x) { return std::sin(x); }, ABSOLUTE) * ABSOLUTE, 2.5e-7f);
+
+    ref_ns = measure(iterations, count, [&] {
+        map_batch([](float x) { return std::cos(x); }, angles.data(), std_out.data(), count); });
+    ns = measure(iterations, count, [&] { map_batch([](float x) { return fast::cos(x); }, angles.data(), fast_out.data(), count); });
+    ok &= report("cos", ref_ns, ns, max_error(angles.data(), fast_out.data(), count,
+        [](double x) { return std::cos(x); }, ABSOLUTE) * ABSOLUTE, 2.5e-7f);
+
+    ref_ns = measure(iterations, count, [&] {
+        map_batch([](float x) { return std::exp2(x); }, exponents.data(), std_out.data(), count); });
+    ns = measure(iterations, count, [&] { map_batch([](float x) { return fast::exp2(x); }, exponents.data(), fast_out.data(), count); });
+    ok &= report("exp2", ref_ns, ns, max_error(exponents.data(), fast_out.data(), count,
+        [](double x) { return std::exp2(x); }, 0.0), 2.5e-7f);
+
+    // Scaled by max(1, |log2 x|)
+    ref_ns = measure(iterations, count, [&] {
+        map_batch([](float x) { return std::log2(x); }, positive.data(), std_out.data(), count); });
+    ns = measure(iterations, count, [&] { map_batch([](float x) { return fast::log2(x); }, positive.data(), fast_out.data(), count); });
+    ok &= report("log2", ref_ns, ns, max_error(positive.data(), fast_out.data(), count,
+        [](double x) { return std::log2(x); }, 1.0), 2.5e-7f);
+
+    ref_ns = measure(iterations, count, [&] {
+        map2_batch([](float x, float y) { return std::pow(x, y); }, bases.data(), powers.data(), std_out.data(), count); });
+    ns = measure(iterations, count, [&] { map2_batch([](float x, float y) { return fast::pow(x, y); }, bases.data(), powers.data(), fast_out.data(), count); });
+    error = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        double expected = std::pow(static_cast<double>(bases[i]), static_cast<double>(powers[i]));
+        error = std::max(error, static_cast<float>(std::abs(fast_out[i] - expected) / expected));
+    }
+    ok &= report("pow", ref_ns, ns, error, 5e-6f);
+
+    // ---- Batch kernels: light binning and culling shapes ----
+    printf("\n  %-16s %11s %11s %8s   (batch width %zu)\n", "batch", "per-item", "soa", "speedup", BATCH_WIDTH);
+
+    FrameAllocator frame;
+    frame.init(1, count * sizeof(float) * 24 + 4096);
+    frame.begin_frame(0);
+
+    std::vector<Sphere> spheres(count), ref_spheres_out(count);
+    std::vector<Box> boxes(count), ref_boxes_out(count);
+    SpheresSoA spheres_soa = SpheresSoA::allocate(frame, count);
+    SpheresSoA spheres_out = SpheresSoA::allocate(frame, count);
+    AabbsSoA boxes_soa = AabbsSoA::allocate(frame, count);
+    AabbsSoA boxes_out = AabbsSoA::allocate(frame, count);
+    for (size_t i = 0; i < count; i++) {
+        vec3 center(random.next(-50, 50), random.next(0, 5), random.next(-50, 50));
+        float radius = random.next(1, 8);
+        spheres[i].center_radius = vec4(center, radius);
+        spheres_soa.set(i, center, radius);
+
+        vec3 half(random.next(0.2f, 2.0f), random.next(0.2f, 2.0f), random.next(0.2f, 2.0f));
+        boxes[i] = {center - half, center + half};
+        boxes_soa.set(i, center - half, center + half);
+    }
+    mat4 view = look_at(vec3(3, 2, 5), vec3(0), vec3(0, 1, 0));
+
+    // Centers into view space
+    ref_ns = measure(iterations, count, [&] { ref_transform_spheres(view, spheres.data(), ref_spheres_out.data(), count); });
+    ns = measure(iterations, count, [&] { transform_spheres_batch(view, spheres_soa, spheres_out); });
+    error = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        vec3 expected = ref_spheres_out[i].center_radius.xyz();
+        error = std::max(error, (spheres_out.center(i) - expected).length() / std::max(1.0f, expected.length()));
+        error = std::max(error, std::abs(spheres_out.radius[i] - ref_spheres_out[i].center_radius.w));
+    }
+    ok &= report("spheres -> view", ref_ns, ns, error, 1e-5f);
+
+    // One cluster against every light, as the light binning does
+    Box cluster{vec3(-4, 0, -30), vec3(4, 3, -20)};
+    std::vector<uint32_t> indices(count), ref_indices(count);
+    uint32_t found = 0, ref_found = 0;
+    ref_ns = measure(iterations, count, [&] {
+        ref_found = ref_spheres_touching_aabb(ref_spheres_out.data(), count, cluster, ref_indices.data(), UINT32_MAX);
+    });
+    ns = measure(iterations, count, [&] {
+        found = spheres_touching_aabb(spheres_out, cluster.min, cluster.max, indices.data(), UINT32_MAX);
+    });
+    bool same = found == ref_found && std::equal(indices.begin(), indices.begin() + found, ref_indices.begin());
+    ok &= report("sphere vs aabb", ref_ns, ns, same ? 0.0f : 1.0f, 0.0f);
+
+    // World boxes into view space
+    ref_ns = measure(iterations, count, [&] { ref_transform_aabbs(view, boxes.data(), ref_boxes_out.data(), count); });
+    ns = measure(iterations, count, [&] { transform_aabbs_batch(view, boxes_soa, boxes_out); });
+    error = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        error = std::max(error, (boxes_out.min(i) - ref_boxes_out[i].min).length() / std::max(1.0f, ref_boxes_out[i].min.length()));
+        error = std::max(error, (boxes_out.max(i) - ref_boxes_out[i].max).length() / std::max(1.0f, ref_boxes_out[i].max.length()));
+    }
+    ok &= report("aabb -> view", ref_ns, ns, error, 1e-5f);
+
+    // Frustum culling of world boxes
+    Frustum frustum = Frustum::from_matrix(view_proj);
+    ref_ns = measure(iterations, count, [&] { ref_found = ref_cull_aabbs(frustum, boxes.data(), count, ref_indices.data()); });
+    ns = measure(iterations, count, [&] { found = cull_aabbs(frustum, boxes_soa, indices.data()); });
+    same = found == ref_found && std::equal(indices.begin(), indices.begin() + found, ref_indices.begin());
+    ok &= report("frustum cull", ref_ns, ns, same ? 0.0f : 1.0f, 0.0f);
+    printf("  (%u of %zu boxes visible)\n", found, count);
+
+    // ---- Fixed point: the same simulation hashes the same everywhere ----
+    auto start = std::chrono::steady_clock::now();
+    uint64_t hash = run_fixed_simulation(FIXED_BODIES, FIXED_TICKS);
+    double sim_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    bool deterministic = hash == FIXED_GOLDEN_HASH;
+    printf("\n  Fixed-point simulation: %u bodies x %u ticks, %.1f ns per body-tick\n",
+        FIXED_BODIES, FIXED_TICKS, sim_ns / (static_cast<double>(FIXED_BODIES) * FIXED_TICKS));
+    printf("  hash %016llx (golden %016llx) %s\n", static_cast<unsigned long long>(hash),
+        static_cast<unsigned long long>(FIXED_GOLDEN_HASH), deterministic ? "ok" : "MISMATCH");
+    ok &= deterministic;
+
+    // Lengths past the fixed range saturate; normalize still finds the direction
+    fvec3 long_vector(fixed(30000), fixed(30000), fixed());
+    fvec3 direction = normalize(long_vector);
+    float direction_err = std::max(std::abs(direction.x.to_float() - 0.70710678f),
+                                   std::abs(direction.y.to_float() - 0.70710678f));
+    bool saturates = long_vector.length().raw == INT32_MAX && direction.z == fixed() && direction_err < 1e-4f;
+    printf("  long vector length %s, normalize err %.1e %s\n", saturates ? "saturated" : "wrapped",
+        direction_err, saturates ? "ok" : "FAIL");
+    ok &= saturates;
+
+    printf("\n%s\n", ok ? "All results match the scalar reference" : "Results differ from the scalar reference");
+    return ok ? 0 : 1;
+}